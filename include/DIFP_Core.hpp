@@ -23,6 +23,43 @@
 // AVX-512 vyžaduje zarovnání na 64 bytů pro optimální výkon (zmm registry)
 constexpr size_t AVX_WIDTH_BYTES = 64;
 
+// Geometrie cache pro rozložení polí: řádek cache a perioda, po které se opakují
+// sady L1D (64 sad × 64 B) i adresy porovnávané při 4K aliasingu load/store.
+constexpr size_t CACHE_LINE_BYTES = 64;
+constexpr size_t ALIASING_PERIOD_BYTES = 4096;
+
+// Pole k mřížky ve slotu s začíná na k * 512 B + s * 64 B (mod 4 KiB):
+// 6 polí × 8 slotů = 48 různých řádků v periodě, žádné dva proudy se nekryjí.
+constexpr size_t FIELD_STAGGER_BYTES = ALIASING_PERIOD_BYTES / 8;
+constexpr size_t STAGGER_SLOTS = FIELD_STAGGER_BYTES / CACHE_LINE_BYTES;
+
+/**
+ * @brief Rozložení polí v monolitickém bloku DIFPGrid.
+ * @details Mřížka s mocninou dvou buněk má pole přesně padded_size od sebe, takže
+ *          potential[i], mass[i], vx[i], ... padnou do stejné sady cache a load jednoho
+ *          pole čeká na store do jiného (4K aliasing). Totéž platí mezi mřížkami: velké
+ *          alokace začínají na stejném offsetu stránky. Staggered proto zarovná začátek
+ *          na 4 KiB a vloží mezi pole mezery podle polí a slotu mřížky (viz výše).
+ */
+enum class FieldLayout {
+    Packed,    // Pole těsně za sebou (původní rozložení)
+    Staggered, // Posunutá pole; mřížky menší než perioda zůstávají Packed
+};
+
+// Bitová maska polí DIFPGrid (výběr polí pro operátory, indexy, ...)
+enum FieldMask : uint32_t {
+    FIELD_POTENTIAL = 1u << 0,
+    FIELD_MASS      = 1u << 1,
+    FIELD_VX        = 1u << 2,
+    FIELD_VY        = 1u << 3,
+    FIELD_FRICTION  = 1u << 4,
+    FIELD_PRESSURE  = 1u << 5,
+};
+
+inline size_t field_count(uint32_t mask) {
+    return static_cast<size_t>(__builtin_popcount(mask));
+}
+
 /**
  * @class DIFPGrid
  * @brief Šablonová třída spravující fyzikální pole v jednom souvislém bloku paměti.
@@ -38,12 +75,81 @@ private:
     // Bitově pakované stavové pole (1 bit na buňku pro stavy jako "is_solid", "active", atd.)
     std::vector<uint64_t> state_bits;
 
+public:
+    /**
+     * @struct Layout
+     * @brief Umístění polí v raw_memory (v prvcích od zarovnaného začátku).
+     */
+    struct Layout {
+        size_t offsets[6]; // potential, mass, vx, vy, friction, pressure
+        size_t alignment;  // Zarovnání začátku v bajtech
+        size_t span;       // Od zarovnaného začátku po konec posledního pole
+        size_t elements;   // Velikost raw_memory včetně rezervy pro zarovnání
+    };
+
+    static size_t padded_for(size_t active) {
+        // Počet prvků, které se vejdou do jednoho SIMD registru
+        // (např. 64 / 8 = 8 double prvků pro AVX-512)
+        constexpr size_t SIMD_ELEMENTS = AVX_WIDTH_BYTES / sizeof(Real);
+
+        // Zarovnání velikosti nahoru na nejbližší násobek SIMD šířky.
+        // Bitová magie: (n + m - 1) & ~(m - 1)
+        return (active + SIMD_ELEMENTS - 1) & ~(SIMD_ELEMENTS - 1);
+    }
+
+    static Layout layout_for(size_t padded, FieldLayout mode, unsigned slot) {
+        Layout layout{};
+        const bool stagger = mode == FieldLayout::Staggered && padded * sizeof(Real) >= ALIASING_PERIOD_BYTES;
+        layout.alignment = stagger ? ALIASING_PERIOD_BYTES : AVX_WIDTH_BYTES;
+
+        size_t offset = 0; // V bajtech; padded * sizeof(Real) je násobek řádku cache
+        for (size_t f = 0; f < 6; ++f) {
+            if (stagger) {
+                const size_t target = f * FIELD_STAGGER_BYTES + (slot % STAGGER_SLOTS) * CACHE_LINE_BYTES;
+                offset += (target + ALIASING_PERIOD_BYTES - offset % ALIASING_PERIOD_BYTES) % ALIASING_PERIOD_BYTES;
+            }
+            layout.offsets[f] = offset / sizeof(Real);
+            offset += padded * sizeof(Real);
+        }
+        // Rezerva pro posun na zarovnanou hranici (std::align)
+        layout.span = offset / sizeof(Real);
+        layout.elements = (offset + layout.alignment) / sizeof(Real);
+        return layout;
+    }
+
+private:
+    FieldLayout layout_mode = FieldLayout::Staggered;
+    unsigned layout_slot = 0;
+    Layout layout{};
+
+    // Cizí blok (např. mapovaný soubor): pole leží v něm místo v raw_memory,
+    // external_owner ho drží naživu. Kopie takové mřížky už vlastní svou paměť.
+    Real* external = nullptr;
+    std::shared_ptr<void> external_owner;
+
+    struct AdoptTag {};
+
+    DIFPGrid(AdoptTag, size_t w, size_t h, FieldLayout mode, unsigned slot, Real* block, std::shared_ptr<void> owner)
+        : state_bits((w * h + 63) / 64, 0), layout_mode(mode), layout_slot(slot), external(block),
+          external_owner(std::move(owner)), width(w), height(h), active_size(w * h) {
+        padded_size = padded_for(active_size);
+        layout = layout_for(padded_size, layout_mode, layout_slot);
+        if (reinterpret_cast<uintptr_t>(block) % layout.alignment != 0) {
+            throw std::invalid_argument("DIFPGrid: external block is not aligned for its layout.");
+        }
+        rebind_pointers();
+    }
+
     /**
      * @brief Přepočítá interní ukazatele na základě aktuální adresy raw_memory.
      * @details Musí být volána po každé operaci, která mění adresu dat vektoru
      *          (konstrukce, kopírování, přesun, realokace).
      */
     void rebind_pointers() {
+        if (external) {
+            set_field_pointers(external);
+            return;
+        }
         if (raw_memory.empty()) {
             potential = mass = vx = vy = friction = pressure = nullptr;
             return;
@@ -53,26 +159,45 @@ private:
         void* ptr = raw_memory.data();
         size_t space = raw_memory.size() * sizeof(Real);
         
-        // Zarovnání prvního ukazatele na nejbližší 64-bytovou hranici.
+        // Zarovnání prvního ukazatele na hranici layout.alignment (64 B, u Staggered 4 KiB).
         // std::align posune 'ptr' vpřed na zarovnanou adresu a zmenší 'space'.
-        // To je důvod, proč alokujeme extra rezervu (reserve_elements).
-        void* aligned_void = std::align(AVX_WIDTH_BYTES, sizeof(Real), ptr, space);
+        // To je důvod, proč alokujeme extra rezervu (viz layout_for).
+        void* aligned_void = std::align(layout.alignment, sizeof(Real), ptr, space);
         
         // Bezpečnostní kontrola (teoreticky by neměla nastat díky rezervě)
         if (!aligned_void) {
-            throw std::runtime_error("Critical Failure: Unable to align DIFPGrid memory to 64 bytes.");
+            throw std::runtime_error("Critical Failure: Unable to align DIFPGrid memory.");
         }
 
-        Real* aligned_start = static_cast<Real*>(aligned_void);
+        set_field_pointers(static_cast<Real*>(aligned_void));
+    }
 
+    void set_field_pointers(Real* aligned_start) {
         // "Krájení salámu": Nastavení ukazatelů na offsety v monolitickém bloku.
-        // Používáme padded_size, aby každé pole začínalo na zarovnané hranici.
-        potential = aligned_start;
-        mass      = potential + padded_size;
-        vx        = mass      + padded_size;
-        vy        = vx        + padded_size;
-        friction  = vy        + padded_size;
-        pressure  = friction  + padded_size;
+        // Offsety jsou násobky řádku cache, takže každé pole začíná na zarovnané hranici.
+        potential = aligned_start + layout.offsets[0];
+        mass      = aligned_start + layout.offsets[1];
+        vx        = aligned_start + layout.offsets[2];
+        vy        = aligned_start + layout.offsets[3];
+        friction  = aligned_start + layout.offsets[4];
+        pressure  = aligned_start + layout.offsets[5];
+    }
+
+    /**
+     * @brief Zkopíruje obsah všech polí z jiné mřížky stejné velikosti.
+     * @details Kopíruje se po polích, ne celý raw_memory: posun zarovnání (std::align)
+     *          se mezi dvěma alokacemi liší, kopie surového vektoru by proto pole posunula
+     *          o rozdíl offsetů. Mezery mezi poli (Staggered) se nekopírují.
+     */
+    void copy_fields_from(const DIFPGrid& other) {
+        if (potential && other.potential) {
+            std::copy(other.potential, other.potential + padded_size, potential);
+            std::copy(other.mass, other.mass + padded_size, mass);
+            std::copy(other.vx, other.vx + padded_size, vx);
+            std::copy(other.vy, other.vy + padded_size, vy);
+            std::copy(other.friction, other.friction + padded_size, friction);
+            std::copy(other.pressure, other.pressure + padded_size, pressure);
+        }
     }
 
 public:
@@ -93,24 +218,19 @@ public:
 
     /**
      * @brief Hlavní konstruktor. Alokuje paměť s paddingem a zarovnáním.
+     * @param mode Rozložení polí (viz FieldLayout).
+     * @param slot Slot mřížky pro posun vůči ostatním mřížkám téhož výpočtu
+     *             (např. pomocné mřížky solveru 1..5, hlavní mřížka 0).
      */
-    DIFPGrid(size_t w, size_t h) : width(w), height(h), active_size(w * h) {
-        // Počet prvků, které se vejdou do jednoho SIMD registru
-        // (např. 64 / 8 = 8 double prvků pro AVX-512)
-        constexpr size_t SIMD_ELEMENTS = AVX_WIDTH_BYTES / sizeof(Real);
-        
-        // Zarovnání velikosti nahoru na nejbližší násobek SIMD šířky.
-        // Bitová magie: (n + m - 1) & ~(m - 1)
-        padded_size = (active_size + SIMD_ELEMENTS - 1) & ~(SIMD_ELEMENTS - 1);
+    DIFPGrid(size_t w, size_t h, FieldLayout mode = FieldLayout::Staggered, unsigned slot = 0)
+        : layout_mode(mode), layout_slot(slot), width(w), height(h), active_size(w * h) {
+        padded_size = padded_for(active_size);
 
-        // Celková alokace: 6 polí * padded_size
-        size_t total_elements = padded_size * 6;
-        
-        // Rezerva pro posun na 64-bytovou hranici (std::align)
-        size_t reserve_elements = AVX_WIDTH_BYTES / sizeof(Real); 
+        // Celková alokace: 6 polí * padded_size, mezery rozložení a rezerva pro std::align
+        layout = layout_for(padded_size, layout_mode, layout_slot);
         
         // Fyzická alokace paměti (inicializována na 0)
-        raw_memory.resize(total_elements + reserve_elements, Real(0));
+        raw_memory.resize(layout.elements, Real(0));
         
         // KRITICKÉ: Nastavení ukazatelů
         rebind_pointers();
@@ -126,6 +246,16 @@ public:
         state_bits.resize(bit_vector_size, 0);
     }
 
+    /**
+     * @brief Mřížka nad cizím blokem v rozložení layout_for(padded_for(w * h), mode, slot), bez kopie.
+     * @details block je zarovnaný začátek (jako block() u vlastnící mřížky), owner ho drží
+     *          naživu. Pole se neinicializují – platí, co v bloku je.
+     */
+    static DIFPGrid adopt(size_t w, size_t h, FieldLayout mode, unsigned slot, Real* block,
+                          std::shared_ptr<void> owner) {
+        return DIFPGrid(AdoptTag{}, w, h, mode, slot, block, std::move(owner));
+    }
+
     // --- IMPLEMENTACE RULE OF FIVE (Bezpečnost paměti) ---
 
     // 1. Destruktor
@@ -135,23 +265,29 @@ public:
 
     // 2. Kopírovací konstruktor (Copy Constructor)
     DIFPGrid(const DIFPGrid& other) 
-        : raw_memory(other.raw_memory), // Hluboká kopie datového vektoru
+        : raw_memory(other.layout.elements),
           state_bits(other.state_bits),
+          layout_mode(other.layout_mode), layout_slot(other.layout_slot), layout(other.layout),
           width(other.width), height(other.height), 
           active_size(other.active_size), padded_size(other.padded_size) 
     {
         // KRITICKÉ: Nasměrovat moje ukazatele do MOJÍ nové paměti.
         // Bez tohoto by this->potential ukazoval do other.raw_memory!
         rebind_pointers(); 
+        copy_fields_from(other);
     }
 
     // 3. Přesouvací konstruktor (Move Constructor)
     DIFPGrid(DIFPGrid&& other) noexcept 
         : raw_memory(std::move(other.raw_memory)), // Ukradne buffer vektoru (rychlé, žádná kopie)
           state_bits(std::move(other.state_bits)),
+          layout_mode(other.layout_mode), layout_slot(other.layout_slot), layout(other.layout),
+          external(other.external), external_owner(std::move(other.external_owner)),
           width(other.width), height(other.height), 
           active_size(other.active_size), padded_size(other.padded_size)
     {
+        other.external = nullptr;
+
         // I po přesunu musíme nastavit ukazatele, protože raw_memory se přesunula
         // do 'this', ale 'this->potential' je zatím neinicializovaný.
         rebind_pointers();
@@ -169,9 +305,15 @@ public:
     // 4. Kopírovací operátor přiřazení (Copy Assignment)
     DIFPGrid& operator=(const DIFPGrid& other) {
         if (this!= &other) {
-            // Standardní přiřazení vektoru (hluboká kopie)
-            raw_memory = other.raw_memory;
+            // Při stejné velikosti se buffer znovu použije (žádná realokace).
+            // Kopie přebírá rozložení zdroje.
+            raw_memory.resize(other.layout.elements);
             state_bits = other.state_bits;
+            external = nullptr;
+            external_owner.reset();
+            layout_mode = other.layout_mode;
+            layout_slot = other.layout_slot;
+            layout = other.layout;
             width = other.width;
             height = other.height;
             active_size = other.active_size;
@@ -179,6 +321,7 @@ public:
             
             // Obnovení vnitřní struktury ukazatelů
             rebind_pointers();
+            copy_fields_from(other);
         }
         return *this;
     }
@@ -189,6 +332,12 @@ public:
             // Standardní přesun vektoru (ukradení bufferu)
             raw_memory = std::move(other.raw_memory);
             state_bits = std::move(other.state_bits);
+            external = other.external;
+            external_owner = std::move(other.external_owner);
+            other.external = nullptr;
+            layout_mode = other.layout_mode;
+            layout_slot = other.layout_slot;
+            layout = other.layout;
             width = other.width;
             height = other.height;
             active_size = other.active_size;
@@ -199,7 +348,11 @@ public:
             
             // Vyčištění oběti
             other.potential = nullptr;
-            //... a další pointery
+            other.mass = nullptr;
+            other.vx = nullptr;
+            other.vy = nullptr;
+            other.friction = nullptr;
+            other.pressure = nullptr;
         }
         return *this;
     }
@@ -208,6 +361,45 @@ public:
 
     [[nodiscard]] size_t get_compute_size() const { return padded_size; }
 
+    [[nodiscard]] FieldLayout field_layout() const { return layout_mode; }
+    [[nodiscard]] unsigned stagger_slot() const { return layout_slot; }
+    [[nodiscard]] const Layout& memory_layout() const { return layout; }
+
+    // Zarovnaný začátek bloku polí (layout.span prvků včetně mezer)
+    [[nodiscard]] const Real* block() const { return potential ? potential - layout.offsets[0] : nullptr; }
+
+    // Pole leží v cizím bloku (adopt), ne v raw_memory
+    [[nodiscard]] bool is_external() const { return external != nullptr; }
+
+    /**
+     * @struct Footprint
+     * @brief Paměť mřížky po složkách v bajtech.
+     */
+    struct Footprint {
+        size_t fields;  // 6 polí * active_size (užitečná data)
+        size_t padding; // Doplnění polí na SIMD šířku, mezery rozložení + rezerva pro std::align
+        size_t bitset;  // state_bits
+
+        [[nodiscard]] size_t total() const { return fields + padding + bitset; }
+    };
+
+    // Odhad pro mřížku w x h bez alokace (stejný výpočet jako konstruktor)
+    [[nodiscard]] static Footprint footprint_for(size_t w, size_t h, FieldLayout mode = FieldLayout::Staggered,
+                                                 unsigned slot = 0) {
+        const size_t active = w * h;
+        const size_t padded = padded_for(active);
+        const size_t allocated = layout_for(padded, mode, slot).elements;
+        return {active * 6 * sizeof(Real), (allocated - active * 6) * sizeof(Real),
+                ((active + 63) / 64) * sizeof(uint64_t)};
+    }
+
+    // Skutečně držená paměť (kapacity vektorů); cizí blok (adopt) mřížce nepatří
+    [[nodiscard]] Footprint footprint() const {
+        if (external) return {0, 0, state_bits.capacity() * sizeof(uint64_t)};
+        const size_t fields = active_size * 6 * sizeof(Real);
+        return {fields, raw_memory.capacity() * sizeof(Real) - fields, state_bits.capacity() * sizeof(uint64_t)};
+    }
+
     // Bitová manipulace pro stavy (např. is_solid, is_fluid)
     [[nodiscard]] inline bool get_state(size_t idx) const {
         return (state_bits[idx >> 6] >> (idx & 63)) & 1ULL;
@@ -217,6 +409,11 @@ public:
         if (val) state_bits[idx >> 6] |= (1ULL << (idx & 63));
         else     state_bits[idx >> 6] &= ~(1ULL << (idx & 63));
     }
+
+    // Surová slova state_bits ((width * height + 63) / 64) pro serializaci (snapshot)
+    [[nodiscard]] const uint64_t* state_data() const { return state_bits.data(); }
+    [[nodiscard]] uint64_t* state_data() { return state_bits.data(); }
+    [[nodiscard]] size_t state_word_count() const { return state_bits.size(); }
 };
 
 #endif // DIFP_CORE_V3_HPP
\ No newline at end of file
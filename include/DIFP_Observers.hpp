@@ -0,0 +1,121 @@
+/**
+ * @file DIFP_Observers.hpp
+ * @brief Pozorovatelé (observers) vkládaní do vnitřních smyček enginů jako typové parametry.
+ * @details Engine volá háčky přímo na konkrétním typu pozorovatele, takže se prázdné
+ *          háčky NullObserver po inliningu úplně vypaří (žádná nepřímá volání, žádné
+ *          větvení). Vlastní pozorovatel dědí z NullObserver a překryje jen háčky,
+ *          které potřebuje.
+ *
+ *          Háčky paralelních taktů dostávají index bloku (chunk): bloky zpracovávají
+ *          různá vlákna současně, pozorovatel si proto drží stav po blocích
+ *          (velikost zjistí v on_tick_begin) a slučuje ho až v on_tick_end.
+ */
+
+#ifndef DIFP_OBSERVERS_HPP
+#define DIFP_OBSERVERS_HPP
+
+#include <vector>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @struct NullObserver
+ * @brief Výchozí pozorovatel bez efektu (přeloží se na nic).
+ */
+struct NullObserver {
+    // --- Informační vesmír (tick) ---
+
+    // Začátek taktu; n_chunks = počet paralelních bloků (1 pro sekvenční engine)
+    inline void on_tick_begin(size_t /*n_chunks*/) {}
+
+    // Skalární engine: proběhl přepis from -> to
+    inline void on_rewrite(size_t /*from*/, size_t /*to*/) {}
+
+    // Bitově pakovaný engine: slovo k před/po taktu a maska kvant, která se přesunula
+    inline void on_word(size_t /*chunk*/, size_t /*k*/, uint64_t /*before*/, uint64_t /*after*/,
+                        uint64_t /*moved*/) {}
+
+    // Konec bloku – volá vlákno, které blok zpracovalo (po posledním on_word / on_rewrite)
+    inline void on_chunk_end(size_t /*chunk*/) {}
+
+    inline void on_tick_end() {}
+
+    // --- Numerické solvery (RK4Solver::step) ---
+
+    template <typename Grid>
+    inline void on_step_begin(const Grid& /*grid*/, double /*dt*/) {}
+
+    // Po vyhodnocení derivace stage (1..4) ze stavu state
+    template <typename Grid>
+    inline void on_stage(int /*stage*/, const Grid& /*state*/, const Grid& /*derivative*/) {}
+
+    // Vnitřní smyčka finální integrace: nové hodnoty buňky i. Volá se jen z obyčejné
+    // (nevektorizované) smyčky, pozorovatel tedy smí mít stav (čítače, součty, sondy).
+    inline void on_cell_update(size_t /*i*/, double /*potential*/, double /*vx*/, double /*vy*/) {}
+
+    template <typename Grid>
+    inline void on_step_end(const Grid& /*grid*/, double /*dt*/) {}
+};
+
+/**
+ * @brief true, pokud pozorovatel překrývá on_cell_update (jinak zůstal prázdný háček
+ *        NullObserver a solver může finální smyčku vektorizovat).
+ */
+template <typename Observer>
+inline constexpr bool observes_cells =
+    !std::is_same_v<decltype(&Observer::on_cell_update), decltype(&NullObserver::on_cell_update)>;
+
+/**
+ * @struct ConservationObserver
+ * @brief Invariant zákona zachování informace: počet kvant před a po taktu se nesmí lišit.
+ */
+struct ConservationObserver : NullObserver {
+    std::vector<int64_t> chunk_balance;
+    uint64_t violations = 0;
+    uint64_t ticks = 0;
+
+    inline void on_tick_begin(size_t n_chunks) { chunk_balance.assign(n_chunks, 0); }
+
+    inline void on_word(size_t chunk, size_t /*k*/, uint64_t before, uint64_t after, uint64_t /*moved*/) {
+        chunk_balance[chunk] += __builtin_popcountll(after) - __builtin_popcountll(before);
+    }
+
+    inline void on_tick_end() {
+        int64_t balance = 0;
+        for (int64_t b : chunk_balance) balance += b;
+        if (balance != 0) ++violations;
+        ++ticks;
+    }
+};
+
+/**
+ * @struct RewriteLogObserver
+ * @brief Zaznamenává přepisy skalárního enginu (pro ladění malých mřížek).
+ */
+struct RewriteLogObserver : NullObserver {
+    std::vector<std::pair<size_t, size_t>> rewrites;
+
+    inline void on_rewrite(size_t from, size_t to) { rewrites.emplace_back(from, to); }
+};
+
+/**
+ * @struct ProbeObserver
+ * @brief Sonda: hodnota potenciálu a rychlosti v jedné buňce po každém kroku solveru.
+ */
+struct ProbeObserver : NullObserver {
+    size_t cell;
+    std::vector<double> potential;
+    std::vector<double> vx;
+
+    explicit ProbeObserver(size_t probe_cell) : cell(probe_cell) {}
+
+    // Čte se jen jednou za krok (ne ve vnitřní smyčce), vektorizace zůstane nedotčená
+    template <typename Grid>
+    inline void on_step_end(const Grid& grid, double /*dt*/) {
+        potential.push_back(grid.potential[cell]);
+        vx.push_back(grid.vx[cell]);
+    }
+};
+
+#endif // DIFP_OBSERVERS_HPP
@@ -0,0 +1,172 @@
+#include "histogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+constexpr size_t LANES = 4;         // Prokládané kopie privátního histogramu (rozvinutí níže)
+constexpr size_t BLOCK = 512;       // Hodnoty převedené na indexy najednou (v L1)
+constexpr size_t MAX_PASS = size_t(1) << 31; // 32bitové privátní čítače nepřetečou
+
+} // namespace
+
+FieldHistogram::FieldHistogram(size_t n_bins) : bins(n_bins) {
+    if (bins == 0) throw std::invalid_argument("FieldHistogram: bin count must be positive.");
+    counts.assign(bins, 0);
+}
+
+FieldHistogram::FieldHistogram(size_t n_bins, double range_lo, double range_hi)
+    : bins(n_bins), lo(range_lo), hi(range_hi), fixed_range(true) {
+    if (bins == 0 || !(range_hi > range_lo)) {
+        throw std::invalid_argument("FieldHistogram: need positive bin count and lo < hi.");
+    }
+    counts.assign(bins, 0);
+}
+
+void FieldHistogram::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+    underflow = overflow = nan_count = total = 0;
+    observed_min = observed_max = 0.0;
+}
+
+void FieldHistogram::build(const double* data, size_t n) {
+    clear();
+    if (!fixed_range) {
+        double mn = std::numeric_limits<double>::infinity(), mx = -mn;
+        #pragma omp parallel for simd reduction(min : mn) reduction(max : mx)
+        for (size_t i = 0; i < n; ++i) {
+            mn = std::min(mn, data[i]);
+            mx = std::max(mx, data[i]);
+        }
+        if (!(mn <= mx)) { // Prázdná data nebo jen NaN
+            mn = 0.0;
+            mx = 1.0;
+        }
+        lo = mn;
+        // Maximum musí padnout dovnitř: horní mez těsně nad ním
+        hi = (mx > mn) ? std::nextafter(mx, std::numeric_limits<double>::infinity()) : mn + 1.0;
+    }
+    bin_values(data, n);
+}
+
+void FieldHistogram::accumulate(const double* data, size_t n) {
+    if (!fixed_range) throw std::logic_error("FieldHistogram: accumulate() needs a fixed range.");
+    bin_values(data, n);
+}
+
+void FieldHistogram::bin_values(const double* data, size_t n) {
+    // Velká data po částech, aby 32bitové čítače vláken nepřetekly
+    while (n > MAX_PASS) {
+        bin_values(data, MAX_PASS);
+        data += MAX_PASS;
+        n -= MAX_PASS;
+    }
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    // Sloty: 0 = pod rozsahem, 1..bins, bins + 1 = nad rozsahem, bins + 2 = NaN
+    const size_t slots = bins + 3;
+    const size_t per_thread = LANES * slots;
+    thread_counts.assign(per_thread * static_cast<size_t>(threads), 0);
+
+    const double range_lo = lo, range_hi = hi;
+    const double scale = static_cast<double>(bins) / (hi - lo);
+    const double top_bin = static_cast<double>(bins - 1);
+    const int over_slot = static_cast<int>(bins) + 1;
+    const int nan_slot = static_cast<int>(bins) + 2;
+
+    const bool first = total == nan_count; // Dosud žádná číselná hodnota
+    double mn = std::numeric_limits<double>::infinity(), mx = -mn;
+
+    #pragma omp parallel reduction(min : mn) reduction(max : mx)
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        uint32_t* local = thread_counts.data() + per_thread * static_cast<size_t>(tid);
+        alignas(64) int32_t slot[BLOCK];
+
+        #pragma omp for schedule(static)
+        for (size_t b = 0; b < n; b += BLOCK) {
+            const size_t m = std::min(BLOCK, n - b);
+            const double* __restrict x = data + b;
+
+            // 1) Indexy přihrádek – bez větvení, vektorizovaně
+            #pragma omp simd reduction(min : mn) reduction(max : mx)
+            for (size_t j = 0; j < m; ++j) {
+                const double v = x[j];
+                double t = (v - range_lo) * scale;
+                t = (t >= 0.0) ? t : 0.0;                // Také NaN -> 0 (převod na int musí být definovaný)
+                t = (t < top_bin) ? t : top_bin;
+                int in_range = static_cast<int>(t) + 1;
+                int s = (v < range_lo) ? 0 : ((v >= range_hi) ? over_slot : in_range);
+                slot[j] = (v != v) ? nan_slot : s;
+                mn = std::min(mn, v);
+                mx = std::max(mx, v);
+            }
+
+            // 2) Přičtení do prokládaných kopií (rozvinuto: 4 nezávislé řetězce load-add-store)
+            uint32_t* __restrict c0 = local;
+            uint32_t* __restrict c1 = local + slots;
+            uint32_t* __restrict c2 = local + 2 * slots;
+            uint32_t* __restrict c3 = local + 3 * slots;
+            size_t j = 0;
+            for (; j + LANES <= m; j += LANES) {
+                ++c0[slot[j]];
+                ++c1[slot[j + 1]];
+                ++c2[slot[j + 2]];
+                ++c3[slot[j + 3]];
+            }
+            for (; j < m; ++j) ++c0[slot[j]];
+        }
+    }
+
+    // Sloučení privátních histogramů
+    for (size_t t = 0; t < static_cast<size_t>(threads); ++t) {
+        const uint32_t* local = thread_counts.data() + per_thread * t;
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            const uint32_t* c = local + lane * slots;
+            underflow += c[0];
+            for (size_t k = 0; k < bins; ++k) counts[k] += c[k + 1];
+            overflow += c[bins + 1];
+            nan_count += c[bins + 2];
+        }
+    }
+
+    total += n;
+    if (mn <= mx) {
+        observed_min = first ? mn : std::min(observed_min, mn);
+        observed_max = first ? mx : std::max(observed_max, mx);
+    }
+}
+
+double FieldHistogram::quantile(double q) const {
+    const uint64_t valid = total - nan_count;
+    if (valid == 0) return std::numeric_limits<double>::quiet_NaN();
+    q = std::clamp(q, 0.0, 1.0);
+    if (q <= 0.0) return observed_min;
+    if (q >= 1.0) return observed_max;
+
+    const double target = q * static_cast<double>(valid);
+    double seen = static_cast<double>(underflow);
+    if (target <= seen) return std::min(lo, observed_max);
+
+    const double width = (hi - lo) / static_cast<double>(bins);
+    for (size_t k = 0; k < bins; ++k) {
+        const double c = static_cast<double>(counts[k]);
+        if (c > 0.0 && seen + c >= target) {
+            double value = lo + width * (static_cast<double>(k) + (target - seen) / c);
+            return std::clamp(value, observed_min, observed_max);
+        }
+        seen += c;
+    }
+    return std::max(hi, observed_min);
+}
@@ -0,0 +1,113 @@
+#ifndef DIFP_HISTOGRAM_HPP
+#define DIFP_HISTOGRAM_HPP
+
+#include "DIFP_Core.hpp"
+#include "DIFP_Observers.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class FieldHistogram
+ * @brief Histogram pole DIFPGrid pro průběžný monitoring (in-situ, bez kopie dat).
+ * @details Binování je vektorizované: blok hodnot nejdřív převede na indexy přihrádek
+ *          ve smyčce omp simd, teprve pak se přičítá. Každé vlákno má vlastní
+ *          (privátní) histogram, rozdělený na 4 prokládané kopie, aby po sobě jdoucí
+ *          hodnoty ve stejné přihrádce na sebe nečekaly; kopie se sloučí na konci.
+ *
+ *          Kvantily se odečítají z histogramu lineární interpolací uvnitř přihrádky
+ *          (chyba nejvýše šířka přihrádky) – bez třídění a bez druhé kopie pole.
+ */
+class FieldHistogram {
+private:
+    size_t bins;
+    double lo = 0.0;
+    double hi = 1.0;
+    bool fixed_range = false;
+
+    std::vector<uint64_t> counts; // bins přihrádek
+    uint64_t underflow = 0;       // Hodnoty < lo
+    uint64_t overflow = 0;        // Hodnoty >= hi
+    uint64_t nan_count = 0;
+    uint64_t total = 0;           // Všechny hodnoty včetně mimo rozsah
+    double observed_min = 0.0;
+    double observed_max = 0.0;
+
+    // Privátní histogramy vláken (32bitové kvůli cache, znovupoužité mezi voláními)
+    std::vector<uint32_t> thread_counts;
+
+    void bin_values(const double* data, size_t n);
+
+public:
+    /**
+     * @param n_bins Počet přihrádek.
+     * Bez rozsahu se rozsah určí z dat při každém build() (jeden průchod min/max navíc).
+     */
+    explicit FieldHistogram(size_t n_bins = 1024);
+    FieldHistogram(size_t n_bins, double range_lo, double range_hi);
+
+    // Nový histogram z dat (předchozí obsah se zahodí)
+    void build(const double* data, size_t n);
+
+    // Přičte další data (jen s pevným rozsahem – např. kumulace přes kroky)
+    void accumulate(const double* data, size_t n);
+
+    void clear();
+
+    /**
+     * @brief Přibližný kvantil q v [0, 1] (hodnoty mimo rozsah se počítají do krajů).
+     */
+    [[nodiscard]] double quantile(double q) const;
+
+    [[nodiscard]] size_t bin_count() const { return bins; }
+    [[nodiscard]] double range_lo() const { return lo; }
+    [[nodiscard]] double range_hi() const { return hi; }
+    [[nodiscard]] const std::vector<uint64_t>& bin_counts() const { return counts; }
+    [[nodiscard]] uint64_t count() const { return total; }
+    [[nodiscard]] uint64_t below_range() const { return underflow; }
+    [[nodiscard]] uint64_t above_range() const { return overflow; }
+    [[nodiscard]] uint64_t nans() const { return nan_count; }
+    [[nodiscard]] double min() const { return observed_min; }
+    [[nodiscard]] double max() const { return observed_max; }
+};
+
+/**
+ * @struct QuantileRecord
+ * @brief Kvantily jednoho pole v jednom kroku.
+ */
+struct QuantileRecord {
+    uint64_t step;
+    double min, q01, q25, median, q75, q99, max;
+};
+
+/**
+ * @struct DistributionObserver
+ * @brief Pozorovatel RK4Solver::step: každých interval kroků histogram potenciálu a tlaku.
+ */
+struct DistributionObserver : NullObserver {
+    size_t interval;
+    uint64_t steps = 0;
+    FieldHistogram potential_hist;
+    FieldHistogram pressure_hist;
+    std::vector<QuantileRecord> potential;
+    std::vector<QuantileRecord> pressure;
+
+    explicit DistributionObserver(size_t every_n_steps = 10, size_t n_bins = 1024)
+        : interval(every_n_steps ? every_n_steps : 1), potential_hist(n_bins), pressure_hist(n_bins) {}
+
+    static QuantileRecord record(uint64_t step, const FieldHistogram& h) {
+        return {step, h.min(), h.quantile(0.01), h.quantile(0.25), h.quantile(0.5),
+                h.quantile(0.75), h.quantile(0.99), h.max()};
+    }
+
+    template <typename Grid>
+    inline void on_step_end(const Grid& grid, double /*dt*/) {
+        if (++steps % interval != 0) return;
+        potential_hist.build(grid.potential, grid.active_size);
+        pressure_hist.build(grid.pressure, grid.active_size);
+        potential.push_back(record(steps, potential_hist));
+        pressure.push_back(record(steps, pressure_hist));
+    }
+};
+
+#endif // DIFP_HISTOGRAM_HPP
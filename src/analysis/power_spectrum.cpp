@@ -0,0 +1,299 @@
+#include "power_spectrum.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+constexpr size_t COLUMN_BAND = 64; // Šířka pásu sloupcové fáze (x souvisle)
+
+bool is_power_of_two(size_t n) { return n && (n & (n - 1)) == 0; }
+
+size_t next_power_of_two(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+void make_twiddles(size_t n, std::vector<double>& c, std::vector<double>& s) {
+    c.assign(std::max<size_t>(n, 1), 1.0);
+    s.assign(std::max<size_t>(n, 1), 0.0);
+    const double pi = std::acos(-1.0);
+    for (size_t h = 1; h < n; h <<= 1) {
+        for (size_t j = 0; j < h; ++j) {
+            double angle = -pi * static_cast<double>(j) / static_cast<double>(h);
+            c[h + j] = std::cos(angle);
+            s[h + j] = std::sin(angle);
+        }
+    }
+}
+
+void make_bit_reverse(size_t n, std::vector<uint32_t>& rev) {
+    rev.assign(n, 0);
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < n) ++bits;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t r = 0;
+        for (unsigned b = 0; b < bits; ++b) r |= static_cast<uint32_t>((i >> b) & 1) << (bits - 1 - b);
+        rev[i] = r;
+    }
+}
+
+int resolve_threads(int requested) {
+    if (requested > 0) return requested;
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+} // namespace
+
+FFT2D::FFT2D(size_t width, size_t height, int n_threads)
+    : nx(width), ny(height), threads(resolve_threads(n_threads)) {
+    if (!is_power_of_two(nx) || !is_power_of_two(ny)) {
+        throw std::invalid_argument("FFT2D: dimensions must be powers of two.");
+    }
+    make_twiddles(nx, row_cos, row_sin);
+    make_twiddles(ny, col_cos, col_sin);
+    make_bit_reverse(nx, row_reverse);
+    make_bit_reverse(ny, col_reverse);
+}
+
+void FFT2D::rows(double* re, double* im) const {
+    const double* __restrict wc = row_cos.data();
+    const double* __restrict ws = row_sin.data();
+    const long long n_rows = static_cast<long long>(ny);
+
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (long long y = 0; y < n_rows; ++y) {
+        double* __restrict r = re + static_cast<size_t>(y) * nx;
+        double* __restrict i_ = im + static_cast<size_t>(y) * nx;
+        for (size_t k = 0; k < nx; ++k) {
+            size_t rk = row_reverse[k];
+            if (rk > k) {
+                std::swap(r[k], r[rk]);
+                std::swap(i_[k], i_[rk]);
+            }
+        }
+        for (size_t h = 1; h < nx; h <<= 1) {
+            for (size_t base = 0; base < nx; base += 2 * h) {
+                double* __restrict ar = r + base;
+                double* __restrict ai = i_ + base;
+                double* __restrict br = r + base + h;
+                double* __restrict bi = i_ + base + h;
+                const double* __restrict c = wc + h;
+                const double* __restrict s = ws + h;
+                #pragma omp simd
+                for (size_t j = 0; j < h; ++j) {
+                    double tr = c[j] * br[j] - s[j] * bi[j];
+                    double ti = c[j] * bi[j] + s[j] * br[j];
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+        }
+    }
+}
+
+void FFT2D::columns(double* re, double* im) const {
+    const long long n_bands = static_cast<long long>((nx + COLUMN_BAND - 1) / COLUMN_BAND);
+
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (long long band = 0; band < n_bands; ++band) {
+        const size_t x0 = static_cast<size_t>(band) * COLUMN_BAND;
+        const size_t bw = std::min(COLUMN_BAND, nx - x0);
+
+        for (size_t k = 0; k < ny; ++k) {
+            size_t rk = col_reverse[k];
+            if (rk > k) {
+                std::swap_ranges(re + k * nx + x0, re + k * nx + x0 + bw, re + rk * nx + x0);
+                std::swap_ranges(im + k * nx + x0, im + k * nx + x0 + bw, im + rk * nx + x0);
+            }
+        }
+        // Motýlek kombinuje řádky a a b; vnitřní smyčka přes souvislé x pásu
+        for (size_t h = 1; h < ny; h <<= 1) {
+            for (size_t base = 0; base < ny; base += 2 * h) {
+                for (size_t j = 0; j < h; ++j) {
+                    const double c = col_cos[h + j], s = col_sin[h + j];
+                    double* __restrict ar = re + (base + j) * nx + x0;
+                    double* __restrict ai = im + (base + j) * nx + x0;
+                    double* __restrict br = re + (base + j + h) * nx + x0;
+                    double* __restrict bi = im + (base + j + h) * nx + x0;
+                    #pragma omp simd
+                    for (size_t x = 0; x < bw; ++x) {
+                        double tr = c * br[x] - s * bi[x];
+                        double ti = c * bi[x] + s * br[x];
+                        br[x] = ar[x] - tr;
+                        bi[x] = ai[x] - ti;
+                        ar[x] += tr;
+                        ai[x] += ti;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FFT2D::forward(double* re, double* im) const {
+    rows(re, im);
+    columns(re, im);
+}
+
+RadialSpectrum radial_power_spectrum(const double* field, size_t width, size_t height, int n_threads) {
+    RadialSpectrum out;
+    if (width == 0 || height == 0) return out;
+    const int threads = resolve_threads(n_threads);
+    const size_t NX = next_power_of_two(width), NY = next_power_of_two(height);
+
+    double mean = 0.0;
+    const size_t cells = width * height;
+    #pragma omp parallel for simd reduction(+ : mean) num_threads(threads)
+    for (size_t i = 0; i < cells; ++i) mean += field[i];
+    mean /= static_cast<double>(cells);
+
+    std::vector<double> re(NX * NY, 0.0), im(NX * NY, 0.0);
+    for (size_t y = 0; y < height; ++y) {
+        const double* src = field + y * width;
+        double* dst = re.data() + y * NX;
+        for (size_t x = 0; x < width; ++x) dst[x] = src[x] - mean;
+    }
+
+    FFT2D fft(NX, NY, threads);
+    fft.forward(re.data(), im.data());
+
+    // Radiální biny v jednotkách základní frekvence delší strany
+    const size_t K = std::max(NX, NY);
+    const size_t n_bins = K / 2 + 1;
+    const double sx = static_cast<double>(K) / static_cast<double>(NX);
+    const double sy = static_cast<double>(K) / static_cast<double>(NY);
+    const double norm = 1.0 / (static_cast<double>(cells) * static_cast<double>(cells));
+
+    std::vector<double> power(n_bins * static_cast<size_t>(threads), 0.0);
+    std::vector<uint64_t> modes(n_bins * static_cast<size_t>(threads), 0);
+    #pragma omp parallel num_threads(threads)
+    {
+        size_t tid = 0;
+#ifdef _OPENMP
+        tid = static_cast<size_t>(omp_get_thread_num());
+#endif
+        double* p = power.data() + tid * n_bins;
+        uint64_t* m = modes.data() + tid * n_bins;
+        #pragma omp for schedule(static)
+        for (long long yy = 0; yy < static_cast<long long>(NY); ++yy) {
+            const size_t y = static_cast<size_t>(yy);
+            const double fy = sy * static_cast<double>(y <= NY / 2 ? y : NY - y);
+            for (size_t x = 0; x < NX; ++x) {
+                const double fx = sx * static_cast<double>(x <= NX / 2 ? x : NX - x);
+                const size_t bin = static_cast<size_t>(std::sqrt(fx * fx + fy * fy) + 0.5);
+                if (bin >= n_bins) continue; // Rohy za Nyquistem
+                const size_t i = y * NX + x;
+                p[bin] += (re[i] * re[i] + im[i] * im[i]) * norm;
+                ++m[bin];
+            }
+        }
+    }
+
+    out.power.assign(n_bins, 0.0);
+    out.modes.assign(n_bins, 0);
+    for (size_t t = 0; t < static_cast<size_t>(threads); ++t) {
+        for (size_t b = 0; b < n_bins; ++b) {
+            out.power[b] += power[t * n_bins + b];
+            out.modes[b] += modes[t * n_bins + b];
+        }
+    }
+    for (size_t b = 0; b < n_bins; ++b) {
+        if (out.modes[b]) out.power[b] /= static_cast<double>(out.modes[b]);
+    }
+    return out;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(size_t grid_width, size_t grid_height, int threads)
+    : width(grid_width), height(grid_height), fft_threads(threads > 0 ? threads : 1),
+      potential_copy(grid_width * grid_height), mass_copy(grid_width * grid_height) {
+    worker = std::thread(&SpectrumAnalyzer::worker_loop, this);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+bool SpectrumAnalyzer::submit(const DIFPGrid<double>& grid, uint64_t step) {
+    if (grid.width != width || grid.height != height) {
+        throw std::invalid_argument("SpectrumAnalyzer: grid size differs from the analyzer.");
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (busy || pending) {
+            ++dropped_count;
+            return false;
+        }
+        // Analyzátor je volný: kopie je jediná práce na straně simulace
+        std::memcpy(potential_copy.data(), grid.potential, grid.active_size * sizeof(double));
+        std::memcpy(mass_copy.data(), grid.mass, grid.active_size * sizeof(double));
+        pending_step = step;
+        pending = true;
+    }
+    wake.notify_one();
+    return true;
+}
+
+void SpectrumAnalyzer::worker_loop() {
+    std::vector<double> potential_work(width * height), mass_work(width * height);
+    for (;;) {
+        uint64_t step;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return pending || stopping; });
+            if (!pending) break; // stopping a nic nečeká
+            potential_work.swap(potential_copy);
+            mass_work.swap(mass_copy);
+            step = pending_step;
+            pending = false;
+            busy = true;
+        }
+
+        RadialSpectrum pot = radial_power_spectrum(potential_work.data(), width, height, fft_threads);
+        RadialSpectrum mass = radial_power_spectrum(mass_work.data(), width, height, fft_threads);
+        pot.step = mass.step = step;
+        pot.field = "potential";
+        mass.field = "mass";
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(std::move(pot));
+            finished.push_back(std::move(mass));
+            busy = false;
+        }
+        idle.notify_all();
+    }
+}
+
+void SpectrumAnalyzer::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return !busy && !pending; });
+}
+
+std::vector<RadialSpectrum> SpectrumAnalyzer::take_results() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<RadialSpectrum> out;
+    out.swap(finished);
+    return out;
+}
+
+uint64_t SpectrumAnalyzer::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped_count;
+}
@@ -0,0 +1,134 @@
+#ifndef DIFP_POWER_SPECTRUM_HPP
+#define DIFP_POWER_SPECTRUM_HPP
+
+#include "DIFP_Core.hpp"
+#include "DIFP_Observers.hpp"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class FFT2D
+ * @brief 2D FFT (radix 2, komplexní, SoA) pro mřížky velikosti mocniny dvou.
+ * @details Řádky se transformují každý zvlášť (vektorizace přes motýlky jedné etapy),
+ *          sloupce najednou v pásech: motýlek kombinuje dva celé řádky, vnitřní smyčka
+ *          jde přes souvislé x – bez transpozice. Obě fáze jsou paralelní (OpenMP).
+ *          Twiddle faktory etapy s polovinou h leží souvisle na indexech [h, 2h).
+ */
+class FFT2D {
+private:
+    size_t nx, ny;
+    std::vector<double> row_cos, row_sin; // Twiddle faktory pro délku nx
+    std::vector<double> col_cos, col_sin; // ... pro délku ny
+    std::vector<uint32_t> row_reverse, col_reverse;
+    int threads;
+
+    void rows(double* re, double* im) const;
+    void columns(double* re, double* im) const;
+
+public:
+    /**
+     * @param width, height Rozměry (mocniny dvou).
+     * @param n_threads Vlákna OpenMP pro transformaci (0 = výchozí počet).
+     */
+    FFT2D(size_t width, size_t height, int n_threads = 0);
+
+    // Dopředná transformace na místě: re/im mají width * height prvků po řádcích
+    void forward(double* re, double* im) const;
+
+    [[nodiscard]] size_t width() const { return nx; }
+    [[nodiscard]] size_t height() const { return ny; }
+};
+
+/**
+ * @struct RadialSpectrum
+ * @brief Radiálně průměrované výkonové spektrum P(k) jednoho pole.
+ * @details k v jednotkách základní frekvence delší strany (k = 1 je jedna vlna přes mřížku),
+ *          bin k pokrývá |k| v [k - 0.5, k + 0.5). Poslední bin je Nyquistova frekvence.
+ */
+struct RadialSpectrum {
+    uint64_t step = 0;
+    std::string field;
+    std::vector<double> power;   // Průměr |F(k)|^2 / N^2 přes módy v binu
+    std::vector<uint64_t> modes; // Počet módů v binu
+};
+
+/**
+ * @brief Spektrum pole (width x height, po řádcích). Střední hodnota se odečte,
+ *        ne-mocniny dvou se doplní nulami na nejbližší mocninu dvou.
+ */
+RadialSpectrum radial_power_spectrum(const double* field, size_t width, size_t height, int n_threads = 0);
+
+/**
+ * @class SpectrumAnalyzer
+ * @brief Výpočet spekter na vlákně na pozadí z kopie polí – krok simulace se nezastaví.
+ * @details submit() jen zkopíruje potenciál a hmotnost do připraveného bufferu (memcpy)
+ *          a probudí analyzátor. Pokud analyzátor ještě počítá předchozí snímek,
+ *          nový se zahodí (dropped()) – simulace nikdy nečeká na analýzu.
+ */
+class SpectrumAnalyzer {
+private:
+    size_t width, height;
+    int fft_threads;
+
+    // Snímek pro analyzátor (plní submit, čte vlákno)
+    std::vector<double> potential_copy, mass_copy;
+    uint64_t pending_step = 0;
+    bool pending = false;
+    bool busy = false;
+    bool stopping = false;
+    uint64_t dropped_count = 0;
+
+    std::vector<RadialSpectrum> finished;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread worker;
+
+    void worker_loop();
+
+public:
+    /**
+     * @param fft_threads Vlákna FFT na pozadí (nezávislá na vláknech simulace).
+     */
+    SpectrumAnalyzer(size_t grid_width, size_t grid_height, int fft_threads = 1);
+    ~SpectrumAnalyzer();
+
+    SpectrumAnalyzer(const SpectrumAnalyzer&) = delete;
+    SpectrumAnalyzer& operator=(const SpectrumAnalyzer&) = delete;
+
+    // Zkopíruje pole mřížky pro analýzu; false = analyzátor byl zaneprázdněn, snímek zahozen
+    bool submit(const DIFPGrid<double>& grid, uint64_t step);
+
+    // Počká na dokončení rozpracované analýzy
+    void wait();
+
+    // Odebere hotová spektra (potential a mass pro každý zpracovaný snímek)
+    std::vector<RadialSpectrum> take_results();
+
+    [[nodiscard]] uint64_t dropped() const;
+};
+
+/**
+ * @struct SpectrumObserver
+ * @brief Pozorovatel RK4Solver::step: každých interval kroků předá snímek analyzátoru.
+ */
+struct SpectrumObserver : NullObserver {
+    SpectrumAnalyzer& analyzer;
+    size_t interval;
+    uint64_t steps = 0;
+
+    SpectrumObserver(SpectrumAnalyzer& target, size_t every_n_steps)
+        : analyzer(target), interval(every_n_steps ? every_n_steps : 1) {}
+
+    template <typename Grid>
+    inline void on_step_end(const Grid& grid, double /*dt*/) {
+        if (++steps % interval == 0) analyzer.submit(grid, steps);
+    }
+};
+
+#endif // DIFP_POWER_SPECTRUM_HPP
@@ -0,0 +1,295 @@
+#include "region_index.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+// Zarovnaný dyadický úsek [index << level, (index + 1) << level)
+struct Piece {
+    size_t level;
+    size_t index;
+};
+
+constexpr size_t MAX_PIECES = 128; // 2 úseky na bit 64bitového rozsahu
+
+// Rozklad [lo, hi) na největší zarovnané úseky (jako dotaz intervalového stromu)
+size_t decompose(size_t lo, size_t hi, Piece* out) {
+    size_t n = 0;
+    while (lo < hi) {
+        size_t level = lo ? static_cast<size_t>(__builtin_ctzll(lo)) : 63;
+        while ((size_t(1) << level) > hi - lo) --level;
+        out[n++] = {level, lo >> level};
+        lo += size_t(1) << level;
+    }
+    return n;
+}
+
+size_t floor_log2(size_t v) {
+    return 63u - static_cast<size_t>(__builtin_clzll(v));
+}
+
+int max_threads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+const double* field_pointer(const DIFPGrid<double>& grid, size_t field) {
+    switch (field) {
+        case 0: return grid.potential;
+        case 1: return grid.mass;
+        case 2: return grid.vx;
+        case 3: return grid.vy;
+        case 4: return grid.friction;
+        default: return grid.pressure;
+    }
+}
+
+} // namespace
+
+// --- SummedAreaTable ---
+
+void SummedAreaTable::build(const double* field, size_t width, size_t height) {
+    w = width;
+    h = height;
+    const size_t stride = w + 1;
+    table.resize(stride * (h + 1));
+    std::fill(table.begin(), table.begin() + static_cast<std::ptrdiff_t>(stride), 0.0);
+    if (w == 0 || h == 0) return;
+
+    const size_t strips_wanted = std::min(static_cast<size_t>(max_threads()), h);
+    const size_t strip_rows = (h + strips_wanted - 1) / strips_wanted;
+    const size_t strips = (h + strip_rows - 1) / strip_rows;
+    double* t = table.data();
+
+    // 1) Lokální tabulka každého pásu: scan řádku + předchozí řádek pásu
+    #pragma omp parallel for schedule(static)
+    for (size_t s = 0; s < strips; ++s) {
+        const size_t y_end = std::min(h, (s + 1) * strip_rows);
+        for (size_t y = s * strip_rows; y < y_end; ++y) {
+            const double* src = field + y * w;
+            double* out = t + (y + 1) * stride;
+            out[0] = 0.0;
+            double run = 0.0;
+            if (y == s * strip_rows) {
+                #pragma omp simd reduction(inscan, + : run)
+                for (size_t x = 0; x < w; ++x) {
+                    run += src[x];
+                    #pragma omp scan inclusive(run)
+                    out[x + 1] = run;
+                }
+            } else {
+                const double* above = out - stride;
+                #pragma omp simd reduction(inscan, + : run)
+                for (size_t x = 0; x < w; ++x) {
+                    run += src[x];
+                    #pragma omp scan inclusive(run)
+                    out[x + 1] = run + above[x + 1];
+                }
+            }
+        }
+    }
+    if (strips == 1) return;
+
+    // 2) Přenos mezi pásy: součet spodních (lokálních) řádků všech pásů nad pásem s
+    carry.assign(strips * stride, 0.0);
+    for (size_t s = 1; s < strips; ++s) {
+        const double* prev = carry.data() + (s - 1) * stride;
+        const double* bottom = t + s * strip_rows * stride;
+        double* cur = carry.data() + s * stride;
+        #pragma omp simd
+        for (size_t x = 0; x < stride; ++x) cur[x] = prev[x] + bottom[x];
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (size_t s = 1; s < strips; ++s) {
+        const double* add = carry.data() + s * stride;
+        const size_t y_end = std::min(h, (s + 1) * strip_rows);
+        for (size_t y = s * strip_rows; y < y_end; ++y) {
+            double* row = t + (y + 1) * stride;
+            #pragma omp simd
+            for (size_t x = 0; x < stride; ++x) row[x] += add[x];
+        }
+    }
+}
+
+size_t SummedAreaTable::memory_bytes_for(size_t width, size_t height) {
+    const size_t strips = std::min(static_cast<size_t>(max_threads()), height);
+    const size_t carry_rows = strips > 1 ? strips : 0;
+    return ((width + 1) * (height + 1) + carry_rows * (width + 1)) * sizeof(double);
+}
+
+// --- ExtremaPyramid ---
+
+void ExtremaPyramid::build(const double* field, size_t width, size_t height) {
+    w = width;
+    h = height;
+    base.assign(field, field + w * h);
+    if (w == 0 || h == 0) {
+        levels_x = levels_y = 0;
+        levels.clear();
+        return;
+    }
+    levels_x = floor_log2(w) + 1;
+    levels_y = floor_log2(h) + 1;
+    levels.resize(levels_x * levels_y);
+
+    for (size_t a = 0; a < levels_x; ++a) {
+        for (size_t b = 0; b < levels_y; ++b) {
+            if (a == 0 && b == 0) continue;
+            Level& out = levels[a * levels_y + b];
+            out.w = w >> a;
+            out.h = h >> b;
+            out.min.resize(out.w * out.h);
+            out.max.resize(out.w * out.h);
+
+            // Zdroj: o úroveň jemnější v x (jen řádek b = 0), jinak v y
+            const bool along_x = (b == 0);
+            const Level* src = along_x ? &levels[(a - 1) * levels_y] : &levels[a * levels_y + b - 1];
+            const bool from_base = along_x ? (a == 1) : (a == 0 && b == 1);
+            const double* in_min = from_base ? base.data() : src->min.data();
+            const double* in_max = from_base ? base.data() : src->max.data();
+            const size_t in_w = from_base ? w : src->w;
+            double* out_min = out.min.data();
+            double* out_max = out.max.data();
+            const size_t ow = out.w;
+
+            if (along_x) {
+                #pragma omp parallel for schedule(static)
+                for (size_t y = 0; y < out.h; ++y) {
+                    const double* rmin = in_min + y * in_w;
+                    const double* rmax = in_max + y * in_w;
+                    #pragma omp simd
+                    for (size_t i = 0; i < ow; ++i) {
+                        out_min[y * ow + i] = std::min(rmin[2 * i], rmin[2 * i + 1]);
+                        out_max[y * ow + i] = std::max(rmax[2 * i], rmax[2 * i + 1]);
+                    }
+                }
+            } else {
+                #pragma omp parallel for schedule(static)
+                for (size_t y = 0; y < out.h; ++y) {
+                    const double* min0 = in_min + 2 * y * in_w;
+                    const double* max0 = in_max + 2 * y * in_w;
+                    #pragma omp simd
+                    for (size_t i = 0; i < ow; ++i) {
+                        out_min[y * ow + i] = std::min(min0[i], min0[i + in_w]);
+                        out_max[y * ow + i] = std::max(max0[i], max0[i + in_w]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <bool IsMax>
+double ExtremaPyramid::query(size_t x0, size_t y0, size_t cw, size_t ch) const {
+    Piece px[MAX_PIECES], py[MAX_PIECES];
+    const size_t nx = decompose(x0, x0 + cw, px);
+    const size_t ny = decompose(y0, y0 + ch, py);
+
+    double best = IsMax ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    for (size_t j = 0; j < ny; ++j) {
+        for (size_t i = 0; i < nx; ++i) {
+            double v;
+            if (px[i].level == 0 && py[j].level == 0) {
+                v = base[py[j].index * w + px[i].index];
+            } else {
+                const Level& level = levels[px[i].level * levels_y + py[j].level];
+                const size_t idx = py[j].index * level.w + px[i].index;
+                v = IsMax ? level.max[idx] : level.min[idx];
+            }
+            best = IsMax ? std::max(best, v) : std::min(best, v);
+        }
+    }
+    return best;
+}
+
+double ExtremaPyramid::min(size_t x0, size_t y0, size_t cw, size_t ch) const {
+    return query<false>(x0, y0, cw, ch);
+}
+
+double ExtremaPyramid::max(size_t x0, size_t y0, size_t cw, size_t ch) const {
+    return query<true>(x0, y0, cw, ch);
+}
+
+size_t ExtremaPyramid::memory_bytes() const {
+    size_t bytes = base.size() * sizeof(double);
+    for (const Level& level : levels) bytes += (level.min.size() + level.max.size()) * sizeof(double);
+    return bytes;
+}
+
+size_t ExtremaPyramid::memory_bytes_for(size_t width, size_t height) {
+    size_t bytes = width * height * sizeof(double);
+    if (width == 0 || height == 0) return bytes;
+    for (size_t a = 0; a <= floor_log2(width); ++a) {
+        for (size_t b = 0; b <= floor_log2(height); ++b) {
+            if (a || b) bytes += 2 * (width >> a) * (height >> b) * sizeof(double);
+        }
+    }
+    return bytes;
+}
+
+// --- RegionIndex ---
+
+RegionIndex::RegionIndex(uint32_t sum_fields, uint32_t extrema_fields)
+    : sum_mask(sum_fields), extrema_mask(extrema_fields) {
+    if (((sum_fields | extrema_fields) >> 6) != 0) {
+        throw std::invalid_argument("RegionIndex: unknown field in mask.");
+    }
+}
+
+void RegionIndex::rebuild(const DIFPGrid<double>& grid) {
+    w = grid.width;
+    h = grid.height;
+    for (size_t f = 0; f < 6; ++f) {
+        if (sum_mask & (1u << f)) sums[f].build(field_pointer(grid, f), w, h);
+        if (extrema_mask & (1u << f)) extrema[f].build(field_pointer(grid, f), w, h);
+    }
+    ++builds;
+}
+
+void RegionIndex::check(uint32_t mask, FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const {
+    if (field_count(field) != 1 || !(mask & field)) {
+        throw std::invalid_argument("RegionIndex: field is not indexed for this query.");
+    }
+    if (builds == 0) throw std::logic_error("RegionIndex: rebuild() has not been called.");
+    if (cw == 0 || ch == 0 || x0 > w || y0 > h || cw > w - x0 || ch > h - y0) {
+        throw std::invalid_argument("RegionIndex: rectangle is empty or outside the grid.");
+    }
+}
+
+double RegionIndex::sum(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const {
+    check(sum_mask, field, x0, y0, cw, ch);
+    return sums[__builtin_ctz(field)].sum(x0, y0, cw, ch);
+}
+
+double RegionIndex::mean(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const {
+    return sum(field, x0, y0, cw, ch) / static_cast<double>(cw * ch);
+}
+
+double RegionIndex::min(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const {
+    check(extrema_mask, field, x0, y0, cw, ch);
+    return extrema[__builtin_ctz(field)].min(x0, y0, cw, ch);
+}
+
+double RegionIndex::max(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const {
+    check(extrema_mask, field, x0, y0, cw, ch);
+    return extrema[__builtin_ctz(field)].max(x0, y0, cw, ch);
+}
+
+size_t RegionIndex::memory_bytes() const {
+    size_t bytes = 0;
+    for (size_t f = 0; f < 6; ++f) bytes += sums[f].memory_bytes() + extrema[f].memory_bytes();
+    return bytes;
+}
+
+size_t RegionIndex::memory_bytes_for(size_t width, size_t height, uint32_t sum_fields, uint32_t extrema_fields) {
+    return field_count(sum_fields) * SummedAreaTable::memory_bytes_for(width, height) +
+           field_count(extrema_fields) * ExtremaPyramid::memory_bytes_for(width, height);
+}
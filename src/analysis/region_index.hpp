@@ -0,0 +1,155 @@
+#ifndef DIFP_REGION_INDEX_HPP
+#define DIFP_REGION_INDEX_HPP
+
+#include "DIFP_Core.hpp"
+#include "DIFP_Observers.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class SummedAreaTable
+ * @brief Tabulka kumulovaných součtů: součet libovolného obdélníku ze 4 čtení (O(1)).
+ * @details Tabulka má rozměr (W + 1) x (H + 1) s nulovým prvním řádkem i sloupcem,
+ *          T[y][x] = součet pole přes [0, x) x [0, y).
+ *
+ *          Stavba jde po pásech řádků (jeden pás na vlákno): uvnitř pásu prefixový
+ *          scan řádku (omp simd scan) rovnou přičítá předchozí řádek pásu, dokud je
+ *          v cache. Druhý průchod přičte ke každému pásu spodní řádek všech pásů nad ním
+ *          (krátký sériový scan přes pásy). Celkem dva průchody pamětí.
+ *
+ *          Součet je rozdílem velkých kumulovaných hodnot: absolutní chyba je řádově
+ *          eps * (součet |hodnot| celé mřížky), ne eps * výsledek.
+ */
+class SummedAreaTable {
+private:
+    size_t w = 0;
+    size_t h = 0;
+    std::vector<double> table; // (w + 1) * (h + 1)
+    std::vector<double> carry; // Spodní řádky pásů (druhý průchod)
+
+public:
+    SummedAreaTable() = default;
+
+    void build(const double* field, size_t width, size_t height);
+
+    /**
+     * @brief Součet přes [x0, x0 + cw) x [y0, y0 + ch); obdélník musí ležet v mřížce.
+     */
+    [[nodiscard]] inline double sum(size_t x0, size_t y0, size_t cw, size_t ch) const {
+        const size_t stride = w + 1;
+        const double* top = table.data() + y0 * stride;
+        const double* bottom = table.data() + (y0 + ch) * stride;
+        return bottom[x0 + cw] - bottom[x0] - top[x0 + cw] + top[x0];
+    }
+
+    [[nodiscard]] size_t width() const { return w; }
+    [[nodiscard]] size_t height() const { return h; }
+    [[nodiscard]] size_t memory_bytes() const { return (table.capacity() + carry.capacity()) * sizeof(double); }
+    [[nodiscard]] static size_t memory_bytes_for(size_t width, size_t height);
+};
+
+/**
+ * @class ExtremaPyramid
+ * @brief Min/max pyramida (anizotropní mipmapa) pro dotazy na extrém obdélníku.
+ * @details Úroveň (a, b) drží min a max zarovnaných bloků 2^a x 2^b. Interval [x0, x1)
+ *          se rozloží na nejvýše 2·log2(W) zarovnaných dyadických úseků (jako v intervalovém
+ *          stromu), stejně y; každá dvojice úseků je jedna buňka jedné úrovně. Dotaz je
+ *          tedy O(log W · log H) čtení bez ohledu na plochu obdélníku.
+ *
+ *          Úroveň (a, b) vzniká z (a - 1, b) nebo (a, b - 1) párovou redukcí (SIMD přes
+ *          řádek, paralelně přes řádky). Paměť: základ + přibližně 3x pole pro min i max.
+ */
+class ExtremaPyramid {
+private:
+    struct Level {
+        size_t w = 0;
+        size_t h = 0;
+        std::vector<double> min;
+        std::vector<double> max;
+    };
+
+    size_t w = 0;
+    size_t h = 0;
+    size_t levels_x = 0;       // floor(log2 W) + 1
+    size_t levels_y = 0;
+    std::vector<double> base;  // Úroveň (0, 0): kopie pole (min = max)
+    std::vector<Level> levels; // Index a * levels_y + b; (0, 0) nevyužitá
+
+    template <bool IsMax>
+    double query(size_t x0, size_t y0, size_t cw, size_t ch) const;
+
+public:
+    ExtremaPyramid() = default;
+
+    void build(const double* field, size_t width, size_t height);
+
+    // Minimum / maximum přes [x0, x0 + cw) x [y0, y0 + ch); obdélník neprázdný a v mřížce
+    [[nodiscard]] double min(size_t x0, size_t y0, size_t cw, size_t ch) const;
+    [[nodiscard]] double max(size_t x0, size_t y0, size_t cw, size_t ch) const;
+
+    [[nodiscard]] size_t width() const { return w; }
+    [[nodiscard]] size_t height() const { return h; }
+    [[nodiscard]] size_t memory_bytes() const;
+    [[nodiscard]] static size_t memory_bytes_for(size_t width, size_t height);
+};
+
+/**
+ * @class RegionIndex
+ * @brief Udržované tabulky součtů a min/max pyramidy nad vybranými poli DIFPGrid.
+ * @details Index je snímek: po změně mřížky se obnoví rebuild() (nebo pozorovatelem
+ *          RegionIndexObserver každých N kroků). Dotazy mezi obnovami vidí stav
+ *          posledního rebuild(), ne živou mřížku.
+ */
+class RegionIndex {
+private:
+    uint32_t sum_mask;
+    uint32_t extrema_mask;
+    size_t w = 0;
+    size_t h = 0;
+    uint64_t builds = 0;
+    SummedAreaTable sums[6];
+    ExtremaPyramid extrema[6];
+
+    void check(uint32_t mask, FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const;
+
+public:
+    /**
+     * @param sum_fields Pole se součtovou tabulkou (FIELD_... | ...).
+     * @param extrema_fields Pole s min/max pyramidou.
+     */
+    RegionIndex(uint32_t sum_fields, uint32_t extrema_fields);
+
+    void rebuild(const DIFPGrid<double>& grid);
+
+    // Dotazy na obdélník [x0, x0 + cw) x [y0, y0 + ch); pole musí být indexované
+    [[nodiscard]] double sum(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const;
+    [[nodiscard]] double mean(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const;
+    [[nodiscard]] double min(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const;
+    [[nodiscard]] double max(FieldMask field, size_t x0, size_t y0, size_t cw, size_t ch) const;
+
+    [[nodiscard]] uint64_t build_count() const { return builds; }
+    [[nodiscard]] size_t memory_bytes() const;
+    [[nodiscard]] static size_t memory_bytes_for(size_t width, size_t height, uint32_t sum_fields,
+                                                 uint32_t extrema_fields);
+};
+
+/**
+ * @struct RegionIndexObserver
+ * @brief Pozorovatel solveru: obnoví RegionIndex každých interval kroků.
+ */
+struct RegionIndexObserver : NullObserver {
+    RegionIndex& index;
+    size_t interval;
+    uint64_t steps = 0;
+
+    RegionIndexObserver(RegionIndex& target, size_t every_n_steps = 1)
+        : index(target), interval(every_n_steps ? every_n_steps : 1) {}
+
+    template <typename Grid>
+    inline void on_step_end(const Grid& grid, double /*dt*/) {
+        if (++steps % interval == 0) index.rebuild(grid);
+    }
+};
+
+#endif // DIFP_REGION_INDEX_HPP
@@ -0,0 +1,182 @@
+#include "alloc_tracker.hpp"
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// Konstantně inicializované: platné i pro alokace před main() a po jeho konci
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> free_count{0};
+std::atomic<uint64_t> allocated_bytes{0};
+
+} // namespace
+
+#ifdef DIFP_ALLOC_TRACKING
+
+namespace {
+
+inline void count_allocation(size_t bytes) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void count_free(void* ptr) {
+    if (ptr) free_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+// Vnitřní vstupy glibc: náhrada malloc níže je volá, new je volá přímo (jinak by se
+// alokace přes new počítala dvakrát)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    count_allocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    count_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    count_allocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    count_free(ptr);
+    __libc_free(ptr);
+}
+} // extern "C"
+
+namespace {
+inline void* raw_allocate(size_t size) { return __libc_malloc(size ? size : 1); }
+inline void* raw_allocate_aligned(size_t size, size_t alignment) {
+    return __libc_memalign(alignment, size ? size : 1);
+}
+inline void raw_free(void* ptr) { __libc_free(ptr); }
+} // namespace
+#else
+namespace {
+inline void* raw_allocate(size_t size) { return std::malloc(size ? size : 1); }
+inline void* raw_allocate_aligned(size_t size, size_t alignment) {
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+inline void raw_free(void* ptr) { std::free(ptr); }
+} // namespace
+#endif
+
+namespace {
+
+void* tracked_new(size_t size) {
+    count_allocation(size);
+    if (void* ptr = raw_allocate(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* tracked_new_aligned(size_t size, std::align_val_t alignment) {
+    count_allocation(size);
+    if (void* ptr = raw_allocate_aligned(size, static_cast<size_t>(alignment))) return ptr;
+    throw std::bad_alloc();
+}
+
+void tracked_delete(void* ptr) {
+    count_free(ptr);
+    raw_free(ptr);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return tracked_new(size); }
+void* operator new[](size_t size) { return tracked_new(size); }
+void* operator new(size_t size, std::align_val_t al) { return tracked_new_aligned(size, al); }
+void* operator new[](size_t size, std::align_val_t al) { return tracked_new_aligned(size, al); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return raw_allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return raw_allocate(size);
+}
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return raw_allocate_aligned(size, static_cast<size_t>(al));
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return raw_allocate_aligned(size, static_cast<size_t>(al));
+}
+
+void operator delete(void* ptr) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_delete(ptr); }
+
+#endif // DIFP_ALLOC_TRACKING
+
+namespace alloc_tracking {
+
+bool available() {
+#ifdef DIFP_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationCounters totals() {
+    return {allocation_count.load(std::memory_order_relaxed), free_count.load(std::memory_order_relaxed),
+            allocated_bytes.load(std::memory_order_relaxed)};
+}
+
+} // namespace alloc_tracking
+
+void AllocationProfile::record(const std::string& name, const AllocationCounters& delta) {
+    Phase* phase = nullptr;
+    for (Phase& p : phases) {
+        if (p.name == name) phase = &p;
+    }
+    if (!phase) {
+        phases.push_back(Phase{name, 0, {}, {}});
+        phase = &phases.back();
+    }
+    ++phase->runs;
+    phase->counters.allocations += delta.allocations;
+    phase->counters.frees += delta.frees;
+    phase->counters.bytes += delta.bytes;
+    phase->last = delta;
+}
+
+const AllocationProfile::Phase* AllocationProfile::find(const std::string& name) const {
+    for (const Phase& p : phases) {
+        if (p.name == name) return &p;
+    }
+    return nullptr;
+}
+
+void require_no_allocations(const AllocationCounters& delta, const char* phase) {
+    if (delta.allocations == 0) return;
+    throw std::logic_error(std::string("Allocation in zero-allocation phase '") + phase + "': " +
+                           std::to_string(delta.allocations) + " allocations, " + std::to_string(delta.bytes) +
+                           " bytes.");
+}
@@ -0,0 +1,94 @@
+#ifndef DIFP_ALLOC_TRACKER_HPP
+#define DIFP_ALLOC_TRACKER_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Počítání alokací na haldě (instrumentační režim).
+ *
+ * S volbou CMake DIFP_ALLOC_TRACKING=ON nahradí alloc_tracker.cpp globální operator
+ * new/delete (všechny varianty) a na glibc i malloc/calloc/realloc/free; každé volání
+ * přičte do globálních atomických čítačů. Počítá se za celý proces – i vlákna OpenMP
+ * a vlákna na pozadí (zapisovač událostí, analyzátor spektra).
+ *
+ * Bez volby je API dostupné, ale čítače stojí na nule a available() vrací false.
+ */
+
+struct AllocationCounters {
+    uint64_t allocations = 0; // new, malloc, calloc, realloc
+    uint64_t frees = 0;       // delete, free
+    uint64_t bytes = 0;       // Požadované bajty (bez režie alokátoru)
+
+    [[nodiscard]] AllocationCounters operator-(const AllocationCounters& start) const {
+        return {allocations - start.allocations, frees - start.frees, bytes - start.bytes};
+    }
+};
+
+namespace alloc_tracking {
+
+// Je počítání zkompilované (DIFP_ALLOC_TRACKING)?
+bool available();
+
+// Součty od startu procesu
+AllocationCounters totals();
+
+} // namespace alloc_tracking
+
+/**
+ * @class AllocationScope
+ * @brief Alokace od konstrukce objektu (RAII měření jedné fáze).
+ */
+class AllocationScope {
+private:
+    AllocationCounters start;
+
+public:
+    AllocationScope() : start(alloc_tracking::totals()) {}
+
+    [[nodiscard]] AllocationCounters delta() const { return alloc_tracking::totals() - start; }
+};
+
+/**
+ * @class AllocationProfile
+ * @brief Součty alokací po pojmenovaných fázích (např. "rk4.step", "tick").
+ * @details measure() spustí tělo uvnitř AllocationScope a rozdíl připíše fázi až po
+ *          měření, takže vlastní alokace záznamu se do fáze nepočítají.
+ */
+class AllocationProfile {
+public:
+    struct Phase {
+        std::string name;
+        uint64_t runs = 0;
+        AllocationCounters counters;
+        AllocationCounters last; // Poslední běh
+    };
+
+private:
+    std::vector<Phase> phases;
+
+public:
+    void record(const std::string& name, const AllocationCounters& delta);
+
+    template <typename Body>
+    void measure(const std::string& name, Body&& body) {
+        AllocationScope scope;
+        body();
+        const AllocationCounters delta = scope.delta();
+        record(name, delta);
+    }
+
+    [[nodiscard]] const Phase* find(const std::string& name) const;
+    [[nodiscard]] const std::vector<Phase>& entries() const { return phases; }
+    void clear() { phases.clear(); }
+};
+
+/**
+ * @brief Vynucení ustáleného stavu bez alokací.
+ * @throws std::logic_error, pokud fáze alokovala (s počtem a objemem ve zprávě).
+ */
+void require_no_allocations(const AllocationCounters& delta, const char* phase);
+
+#endif // DIFP_ALLOC_TRACKER_HPP
@@ -0,0 +1,130 @@
+#include "memory_report.hpp"
+#include "solvers/rk4_solver.hpp"
+#include "solvers/etdrk4_solver.hpp"
+#include "analysis/region_index.hpp"
+#include "universe/packed_universe.hpp"
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr double MIB = 1024.0 * 1024.0;
+
+// Hodnota "Klíč:   123 kB" ze souboru ve formátu /proc (0, pokud chybí)
+size_t proc_kib(const char* path, const char* key) {
+    std::ifstream in(path);
+    std::string line;
+    const size_t key_len = std::strlen(key);
+    while (std::getline(in, line)) {
+        if (line.compare(0, key_len, key) == 0 && line.size() > key_len && line[key_len] == ':') {
+            return static_cast<size_t>(std::strtoull(line.c_str() + key_len + 1, nullptr, 10)) * 1024;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+const char* memory_category_name(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Fields:  return "fields";
+        case MemoryCategory::Padding: return "padding";
+        case MemoryCategory::Scratch: return "scratch";
+        case MemoryCategory::Bitset:  return "bitset";
+        case MemoryCategory::Pool:    return "pool";
+        case MemoryCategory::Index:   return "index";
+    }
+    return "?";
+}
+
+void MemoryReport::add(const std::string& component, MemoryCategory category, size_t bytes) {
+    items.push_back({component, category, bytes});
+}
+
+void MemoryReport::add_grid(const std::string& component, const DIFPGrid<double>::Footprint& footprint) {
+    add(component, MemoryCategory::Fields, footprint.fields);
+    add(component, MemoryCategory::Padding, footprint.padding);
+    add(component, MemoryCategory::Bitset, footprint.bitset);
+}
+
+size_t MemoryReport::total() const {
+    size_t bytes = 0;
+    for (const MemoryItem& item : items) bytes += item.bytes;
+    return bytes;
+}
+
+size_t MemoryReport::total(MemoryCategory category) const {
+    size_t bytes = 0;
+    for (const MemoryItem& item : items) {
+        if (item.category == category) bytes += item.bytes;
+    }
+    return bytes;
+}
+
+void MemoryReport::print(std::ostream& out) const {
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    for (const MemoryItem& item : items) {
+        out << "  " << std::left << std::setw(24) << item.component << std::setw(9)
+            << memory_category_name(item.category) << std::right << std::setw(12) << item.bytes / MIB << " MiB\n";
+    }
+    out << "  --\n";
+    for (size_t c = 0; c < MEMORY_CATEGORY_COUNT; ++c) {
+        const size_t bytes = total(static_cast<MemoryCategory>(c));
+        if (bytes) {
+            out << "  " << std::left << std::setw(33) << memory_category_name(static_cast<MemoryCategory>(c))
+                << std::right << std::setw(12) << bytes / MIB << " MiB\n";
+        }
+    }
+    out << "  " << std::left << std::setw(33) << "celkem" << std::right << std::setw(12) << total() / MIB
+        << " MiB\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+ProcessMemory process_memory() {
+    ProcessMemory mem;
+#if defined(__unix__) || defined(__APPLE__)
+    mem.page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+#if defined(__linux__)
+    mem.rss = proc_kib("/proc/self/status", "VmRSS");
+    mem.peak_rss = proc_kib("/proc/self/status", "VmHWM");
+    mem.huge_page_size = proc_kib("/proc/meminfo", "Hugepagesize");
+    mem.anon_huge_bytes = proc_kib("/proc/self/smaps_rollup", "AnonHugePages");
+    mem.available = proc_kib("/proc/meminfo", "MemAvailable");
+#endif
+    return mem;
+}
+
+MemoryReport estimate_memory(const MemoryPlan& plan) {
+    MemoryReport report;
+    const size_t w = plan.width, h = plan.height;
+
+    const DIFPGrid<double>::Footprint grid = DIFPGrid<double>::footprint_for(w, h);
+    for (size_t g = 0; g < plan.grids; ++g) report.add_grid("grid[" + std::to_string(g) + "]", grid);
+
+    for (size_t s = 0; s < plan.rk4_solvers; ++s) {
+        report.add("rk4[" + std::to_string(s) + "]", MemoryCategory::Scratch, RK4Solver::memory_bytes_for(w, h));
+    }
+    for (size_t s = 0; s < plan.etdrk4_solvers; ++s) {
+        report.add("etdrk4[" + std::to_string(s) + "]", MemoryCategory::Scratch,
+                   ETDRK4Solver::memory_bytes_for(w, h, plan.etdrk4_operators));
+    }
+    if (plan.region_sum_fields | plan.region_extrema_fields) {
+        report.add("region_index", MemoryCategory::Index,
+                   RegionIndex::memory_bytes_for(w, h, plan.region_sum_fields, plan.region_extrema_fields));
+    }
+    if (plan.universe_width && plan.universe_height) {
+        report.add("packed_universe", MemoryCategory::Bitset,
+                   PackedUniverse::memory_bytes_for(plan.universe_width, plan.universe_height));
+    }
+    return report;
+}
@@ -0,0 +1,94 @@
+#ifndef DIFP_MEMORY_REPORT_HPP
+#define DIFP_MEMORY_REPORT_HPP
+
+#include "DIFP_Core.hpp"
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Účetnictví paměti: kolik bajtů drží která složka běhu a kolik by držela (dry run).
+ *
+ * Složky hlásí vlastní paměť přes memory_bytes() a stejný výpočet bez alokace přes
+ * statické memory_bytes_for(...) – odhad z konfigurace tak sdílí vzorec s implementací.
+ */
+
+enum class MemoryCategory {
+    Fields,  // Užitečná data polí
+    Padding, // Doplnění na SIMD šířku a rezerva zarovnání
+    Scratch, // Pomocné mřížky solverů
+    Bitset,  // Bitová pole (state_bits, pakovaný vesmír)
+    Pool,    // Fronty, dávky a znovupoužitelné buffery
+    Index,   // Analytické indexy (RegionIndex, ...)
+};
+
+constexpr size_t MEMORY_CATEGORY_COUNT = 6;
+
+const char* memory_category_name(MemoryCategory category);
+
+struct MemoryItem {
+    std::string component;
+    MemoryCategory category;
+    size_t bytes;
+};
+
+/**
+ * @class MemoryReport
+ * @brief Seznam (složka, kategorie, bajty) se součty po kategoriích.
+ */
+class MemoryReport {
+private:
+    std::vector<MemoryItem> items;
+
+public:
+    void add(const std::string& component, MemoryCategory category, size_t bytes);
+
+    // Mřížka rozdělená na pole, padding a bitové pole
+    void add_grid(const std::string& component, const DIFPGrid<double>::Footprint& footprint);
+    void add_grid(const std::string& component, const DIFPGrid<double>& grid) { add_grid(component, grid.footprint()); }
+
+    [[nodiscard]] size_t total() const;
+    [[nodiscard]] size_t total(MemoryCategory category) const;
+    [[nodiscard]] const std::vector<MemoryItem>& entries() const { return items; }
+
+    // Tabulka složek a součty po kategoriích (MiB)
+    void print(std::ostream& out) const;
+};
+
+/**
+ * @struct ProcessMemory
+ * @brief Paměť procesu podle OS (Linux /proc; jinde jen velikost stránky).
+ */
+struct ProcessMemory {
+    size_t rss = 0;             // Aktuální rezidentní paměť (VmRSS)
+    size_t peak_rss = 0;        // Maximum od startu (VmHWM)
+    size_t page_size = 0;       // Základní stránka
+    size_t huge_page_size = 0;  // Velikost huge page systému (Hugepagesize)
+    size_t anon_huge_bytes = 0; // Paměť procesu v transparentních huge pages (AnonHugePages)
+    size_t available = 0;       // Paměť dostupná v systému (MemAvailable)
+};
+
+ProcessMemory process_memory();
+
+/**
+ * @struct MemoryPlan
+ * @brief Konfigurace běhu pro odhad paměti bez alokace.
+ */
+struct MemoryPlan {
+    size_t width = 0;
+    size_t height = 0;
+    size_t grids = 1;             // Hlavní mřížky (ensemble, okna pararealu, ...)
+    size_t rk4_solvers = 1;
+    size_t etdrk4_solvers = 0;
+    size_t etdrk4_operators = 1;  // Unikátní dvojice (mass, friction)
+    uint32_t region_sum_fields = 0;
+    uint32_t region_extrema_fields = 0;
+    size_t universe_width = 0;    // PackedUniverse (0 = žádný)
+    size_t universe_height = 0;
+};
+
+MemoryReport estimate_memory(const MemoryPlan& plan);
+
+#endif // DIFP_MEMORY_REPORT_HPP
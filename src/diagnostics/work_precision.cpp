@@ -0,0 +1,133 @@
+#include "work_precision.hpp"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr double MASS_LO = 0.5, MASS_HI = 2.0;
+constexpr double FRICTION_LO = 0.05, FRICTION_HI = 3.0;
+
+// Úroveň k z levels rovnoměrně (geometricky pro tření) mezi lo a hi
+double level(size_t k, size_t levels, double lo, double hi, bool geometric) {
+    if (levels < 2) return lo;
+    const double u = double(k) / double(levels - 1);
+    return geometric ? lo * std::pow(hi / lo, u) : lo + (hi - lo) * u;
+}
+
+} // namespace
+
+ManufacturedProblem::ManufacturedProblem(size_t width, size_t height, size_t n_materials)
+    : w(width), h(height), materials(n_materials ? n_materials : 1) {
+    if (w == 0 || h == 0) throw std::invalid_argument("ManufacturedProblem: empty grid.");
+}
+
+void ManufacturedProblem::initial(DIFPGrid<double>& grid) const {
+    if (grid.width != w || grid.height != h) {
+        throw std::invalid_argument("ManufacturedProblem: grid size does not match the problem.");
+    }
+    const double pi = std::acos(-1.0);
+    for (size_t y = 0; y < h; ++y) {
+        const size_t fi = y * materials / h;
+        const double cy = std::cos(2.0 * pi * double(y) / double(h));
+        for (size_t x = 0; x < w; ++x) {
+            const size_t i = y * w + x;
+            const size_t mi = x * materials / w;
+            const double sx = std::sin(2.0 * pi * double(x) / double(w));
+            grid.potential[i] = sx * cy;
+            grid.vx[i] = 0.5 * cy;
+            grid.vy[i] = -0.25 * sx;
+            grid.mass[i] = level(mi, materials, MASS_LO, MASS_HI, false);
+            grid.friction[i] = level(fi, materials, FRICTION_LO, FRICTION_HI, true);
+        }
+    }
+}
+
+void ManufacturedProblem::exact(const DIFPGrid<double>& initial, double t, DIFPGrid<double>& out) const {
+    const size_t n = w * h;
+    for (size_t i = 0; i < n; ++i) {
+        const double m = initial.mass[i], f = initial.friction[i];
+        const double p0 = initial.potential[i];
+        const double s0 = initial.vx[i] + initial.vy[i];
+        const double d0 = initial.vx[i] - initial.vy[i];
+
+        const double disc = std::sqrt(f * f + 8.0 / m);
+        const double r1 = 0.5 * (-f + disc), r2 = 0.5 * (-f - disc);
+        // pot(0) = p0, pot'(0) = -s0
+        const double a = (-s0 - r2 * p0) / (r1 - r2);
+        const double b = p0 - a;
+        const double e1 = std::exp(r1 * t), e2 = std::exp(r2 * t);
+
+        const double s = -(a * r1 * e1 + b * r2 * e2);
+        const double d = d0 * std::exp(-f * t);
+        out.potential[i] = a * e1 + b * e2;
+        out.vx[i] = 0.5 * (s + d);
+        out.vy[i] = 0.5 * (s - d);
+    }
+}
+
+std::vector<WorkPrecisionPoint> run_work_precision(const ManufacturedProblem& problem,
+                                                   const std::vector<IntegratorCase>& cases,
+                                                   const std::vector<double>& dts, double t_end) {
+    DIFPGrid<double> start(problem.width(), problem.height());
+    problem.initial(start);
+    DIFPGrid<double> reference = start;
+    problem.exact(start, t_end, reference);
+
+    const size_t n = start.active_size;
+    double norm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        norm += reference.potential[i] * reference.potential[i] + reference.vx[i] * reference.vx[i] +
+                reference.vy[i] * reference.vy[i];
+    }
+    norm = std::sqrt(norm);
+
+    std::vector<WorkPrecisionPoint> points;
+    DIFPGrid<double> grid = start;
+    for (const IntegratorCase& c : cases) {
+        for (double dt_wanted : dts) {
+            const size_t steps = std::max<size_t>(1, static_cast<size_t>(std::llround(t_end / dt_wanted)));
+            const double dt = t_end / double(steps);
+            grid = start;
+
+            auto t0 = std::chrono::steady_clock::now();
+            c.integrate(grid, dt, steps);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            double sum_sq = 0.0, max_err = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                const double ep = grid.potential[i] - reference.potential[i];
+                const double ex = grid.vx[i] - reference.vx[i];
+                const double ey = grid.vy[i] - reference.vy[i];
+                sum_sq += ep * ep + ex * ex + ey * ey;
+                max_err = std::max({max_err, std::fabs(ep), std::fabs(ex), std::fabs(ey)});
+            }
+            // NaN (nestabilní krok) zůstane NaN a nikdy neprojde cílem přesnosti
+            points.push_back({c.name, dt, steps, seconds, std::sqrt(sum_sq) / norm, max_err});
+        }
+    }
+    return points;
+}
+
+void write_work_precision_csv(const std::string& path, const std::vector<WorkPrecisionPoint>& points) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("write_work_precision_csv: cannot open " + path);
+    out << "integrator,dt,steps,seconds,error_l2,error_max\n" << std::setprecision(10);
+    for (const WorkPrecisionPoint& p : points) {
+        out << p.integrator << ',' << p.dt << ',' << p.steps << ',' << p.seconds << ',' << p.error_l2 << ','
+            << p.error_max << '\n';
+    }
+    if (!out) throw std::runtime_error("write_work_precision_csv: write failed for " + path);
+}
+
+const WorkPrecisionPoint* cheapest_for(const std::vector<WorkPrecisionPoint>& points, double target) {
+    const WorkPrecisionPoint* best = nullptr;
+    for (const WorkPrecisionPoint& p : points) {
+        if (!(p.error_l2 <= target)) continue;
+        if (!best || p.seconds < best->seconds) best = &p;
+    }
+    return best;
+}
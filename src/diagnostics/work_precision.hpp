@@ -0,0 +1,77 @@
+#ifndef DIFP_WORK_PRECISION_HPP
+#define DIFP_WORK_PRECISION_HPP
+
+#include "DIFP_Core.hpp"
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @class ManufacturedProblem
+ * @brief Tlumená vlna (physics_kernel.hpp) s přesným řešením v uzavřeném tvaru.
+ * @details Rovnice buňky jsou lineární a buňky nejsou svázané, přesné řešení lze
+ *          proto napsat přímo. Pro s = vx + vy a d = vx - vy platí
+ *
+ *              pot'' + f pot' - (2/m) pot = 0,   s = -pot',   d' = -f d,
+ *
+ *          takže pot(t) = A e^{r1 t} + B e^{r2 t} s kořeny r = (-f ± sqrt(f² + 8/m)) / 2.
+ *          Materiály (mass, friction) se střídají po blocích mřížky, aby úloha měla
+ *          rozptyl tuhosti; počáteční stav je hladká vlna přes celou mřížku.
+ */
+class ManufacturedProblem {
+private:
+    size_t w;
+    size_t h;
+    size_t materials;
+
+public:
+    /**
+     * @param materials Počet úrovní mass i friction (materials² kombinací po blocích).
+     */
+    ManufacturedProblem(size_t width, size_t height, size_t materials = 4);
+
+    // Počáteční stav včetně polí mass a friction
+    void initial(DIFPGrid<double>& grid) const;
+
+    // Přesné řešení v čase t z počátečního stavu initial (pole potential, vx, vy)
+    void exact(const DIFPGrid<double>& initial, double t, DIFPGrid<double>& out) const;
+
+    [[nodiscard]] size_t width() const { return w; }
+    [[nodiscard]] size_t height() const { return h; }
+};
+
+/**
+ * @struct IntegratorCase
+ * @brief Integrátor pro srovnání: integrate(grid, dt, steps) provede steps kroků
+ *        včetně vlastní přípravy (koeficienty, buffery) – ta patří do ceny.
+ */
+struct IntegratorCase {
+    std::string name;
+    std::function<void(DIFPGrid<double>& grid, double dt, size_t steps)> integrate;
+};
+
+struct WorkPrecisionPoint {
+    std::string integrator;
+    double dt;
+    size_t steps;
+    double seconds;   // Čas integrace do t_end
+    double error_l2;  // Relativní L2 chyba (potential, vx, vy)
+    double error_max; // Maximální absolutní chyba
+};
+
+/**
+ * @brief Všechny integrátory pro všechna dt do času t_end (dt se zaokrouhlí tak,
+ *        aby t_end byl celý počet kroků).
+ */
+std::vector<WorkPrecisionPoint> run_work_precision(const ManufacturedProblem& problem,
+                                                   const std::vector<IntegratorCase>& cases,
+                                                   const std::vector<double>& dts, double t_end);
+
+// CSV: integrator,dt,steps,seconds,error_l2,error_max (throws při chybě zápisu)
+void write_work_precision_csv(const std::string& path, const std::vector<WorkPrecisionPoint>& points);
+
+// Nejlevnější bod s error_l2 <= target (nullptr, pokud ho nikdo nedosáhl)
+const WorkPrecisionPoint* cheapest_for(const std::vector<WorkPrecisionPoint>& points, double target);
+
+#endif // DIFP_WORK_PRECISION_HPP
@@ -0,0 +1,129 @@
+#ifndef DIFP_CRC32C_HPP
+#define DIFP_CRC32C_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#if defined(__SSE4_2__) && defined(__PCLMUL__)
+#include <immintrin.h>
+#define DIFP_CRC32C_HARDWARE 1
+#endif
+
+/**
+ * CRC32C (Castagnoli, polynom 0x82F63B78) – kontrolní součty bloků snapshotů.
+ *
+ * S SSE4.2 + PCLMUL (-march=native) počítá instrukce crc32 tři nezávislé proudy
+ * současně (skryje latenci 3 cykly) a mezivýsledky se spojí násobením bez přenosu
+ * (pclmulqdq) konstantou x^(8n) mod P. Bez nich zůstává tabulková varianta.
+ */
+namespace crc32c {
+
+constexpr uint32_t POLY = 0x82F63B78u;
+
+inline const std::array<uint32_t, 256>& table() {
+    static const std::array<uint32_t, 256> t = [] {
+        std::array<uint32_t, 256> out{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ POLY : (c >> 1);
+            out[i] = c;
+        }
+        return out;
+    }();
+    return t;
+}
+
+// Tabulková varianta (referenční, bez závislosti na instrukční sadě)
+inline uint32_t extend_portable(uint32_t crc, const void* data, size_t n) {
+    const auto& t = table();
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = t[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// a * b mod P v zrcadlené reprezentaci (bit 31 = x^0)
+inline uint32_t multiply_mod(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = 1u << 31; m; m >>= 1) {
+        if (a & m) product ^= b;
+        b = (b & 1) ? (b >> 1) ^ POLY : (b >> 1);
+    }
+    return product;
+}
+
+// x^e mod P
+inline uint32_t x_power_mod(uint64_t e) {
+    uint32_t result = 1u << 31;
+    uint32_t base = 1u << 30;
+    while (e) {
+        if (e & 1) result = multiply_mod(result, base);
+        base = multiply_mod(base, base);
+        e >>= 1;
+    }
+    return result;
+}
+
+#ifdef DIFP_CRC32C_HARDWARE
+
+constexpr size_t LANE_BYTES = 4096; // Délka jednoho ze tří proudů v bloku
+
+// Registr r posunutý o n bajtů nul = crc32_u64(0, clmul(r, x^(8n-33) mod P))
+inline uint64_t shift_product(uint32_t r, uint32_t k) {
+    __m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(r)),
+                                           _mm_cvtsi32_si128(static_cast<int>(k)), 0x00);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+}
+
+inline uint32_t extend_hardware(uint32_t crc, const void* data, size_t n) {
+    static const uint32_t k_lane = x_power_mod(8 * LANE_BYTES - 33);
+    static const uint32_t k_two_lanes = x_power_mod(16 * LANE_BYTES - 33);
+
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t r = ~crc;
+
+    // Tři proudy: [0, L), [L, 2L), [2L, 3L); druhý a třetí začínají z nuly
+    while (n >= 3 * LANE_BYTES) {
+        uint64_t r1 = 0, r2 = 0;
+        for (size_t i = 0; i < LANE_BYTES; i += 8) {
+            uint64_t w0, w1, w2;
+            std::memcpy(&w0, p + i, 8);
+            std::memcpy(&w1, p + LANE_BYTES + i, 8);
+            std::memcpy(&w2, p + 2 * LANE_BYTES + i, 8);
+            r = _mm_crc32_u64(r, w0);
+            r1 = _mm_crc32_u64(r1, w1);
+            r2 = _mm_crc32_u64(r2, w2);
+        }
+        uint64_t folded = shift_product(static_cast<uint32_t>(r), k_two_lanes) ^
+                          shift_product(static_cast<uint32_t>(r1), k_lane);
+        r = _mm_crc32_u64(0, folded) ^ r2;
+        p += 3 * LANE_BYTES;
+        n -= 3 * LANE_BYTES;
+    }
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        r = _mm_crc32_u64(r, w);
+    }
+    uint32_t r32 = static_cast<uint32_t>(r);
+    for (; n; --n, ++p) r32 = _mm_crc32_u8(r32, *p);
+    return ~r32;
+}
+
+#endif
+
+// Pokračuje v součtu crc (začátek = 0) přes dalších n bajtů
+inline uint32_t extend(uint32_t crc, const void* data, size_t n) {
+#ifdef DIFP_CRC32C_HARDWARE
+    return extend_hardware(crc, data, n);
+#else
+    return extend_portable(crc, data, n);
+#endif
+}
+
+inline uint32_t compute(const void* data, size_t n) { return extend(0, data, n); }
+
+} // namespace crc32c
+
+#endif // DIFP_CRC32C_HPP
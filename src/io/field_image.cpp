@@ -0,0 +1,110 @@
+#include "field_image.hpp"
+#include "crc32c.hpp"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+constexpr char FIELD_IMAGE_MAGIC[8] = {'D', 'I', 'F', 'P', 'I', 'M', 'G', '1'};
+constexpr uint32_t FIELD_IMAGE_VERSION = 2;
+
+uint32_t header_checksum(const FieldImageHeader& h) {
+    return crc32c::compute(&h, offsetof(FieldImageHeader, header_crc));
+}
+
+} // namespace
+
+void write_field_image(const std::string& path, const DIFPGrid<double>& grid) {
+    using Layout = DIFPGrid<double>::Layout;
+    const Layout& layout = grid.memory_layout();
+    if (layout.alignment > FIELD_IMAGE_DATA_OFFSET) {
+        throw std::invalid_argument("write_field_image: grid alignment exceeds the data offset.");
+    }
+    FieldImageHeader head{};
+    std::memcpy(head.magic, FIELD_IMAGE_MAGIC, sizeof(head.magic));
+    head.version = FIELD_IMAGE_VERSION;
+    head.layout = static_cast<uint32_t>(grid.field_layout());
+    head.width = grid.width;
+    head.height = grid.height;
+    head.padded_size = grid.get_compute_size();
+    head.stagger_slot = grid.stagger_slot();
+    head.alignment = static_cast<uint32_t>(layout.alignment);
+    for (size_t f = 0; f < 6; ++f) head.offsets[f] = layout.offsets[f];
+    head.span = layout.span;
+    head.data_offset = FIELD_IMAGE_DATA_OFFSET;
+    const size_t bytes = layout.span * sizeof(double);
+    head.state_offset = head.data_offset + bytes;
+    head.state_words = grid.state_word_count();
+    const size_t state_bytes = head.state_words * sizeof(uint64_t);
+    head.data_crc = crc32c::extend(crc32c::compute(grid.block(), bytes), grid.state_data(), state_bytes);
+    head.header_crc = header_checksum(head);
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("write_field_image: cannot open " + path);
+    static const uint8_t zeros[FIELD_IMAGE_DATA_OFFSET] = {};
+    bool ok = std::fwrite(&head, sizeof(head), 1, f) == 1 &&
+              std::fwrite(zeros, 1, FIELD_IMAGE_DATA_OFFSET - sizeof(head), f) == FIELD_IMAGE_DATA_OFFSET - sizeof(head) &&
+              std::fwrite(grid.block(), 1, bytes, f) == bytes &&
+              std::fwrite(grid.state_data(), 1, state_bytes, f) == state_bytes;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) throw std::runtime_error("write_field_image: write failed for " + path);
+}
+
+bool FieldImage::open(const std::string& path) {
+    valid = false;
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(FieldImageHeader)) return false;
+    std::memcpy(&head, file.data(), sizeof(head));
+
+    bool ok = std::memcmp(head.magic, FIELD_IMAGE_MAGIC, sizeof(head.magic)) == 0 &&
+              head.version == FIELD_IMAGE_VERSION && head.header_crc == header_checksum(head) &&
+              head.data_offset == FIELD_IMAGE_DATA_OFFSET && head.layout <= uint32_t(FieldLayout::Staggered) &&
+              head.padded_size == DIFPGrid<double>::padded_for(head.width * head.height);
+    if (ok) {
+        // Rozložení musí být přesně to, co by DIFPGrid spočítal sám (adopt na něj spoléhá)
+        const auto expected = DIFPGrid<double>::layout_for(head.padded_size, FieldLayout(head.layout),
+                                                           head.stagger_slot);
+        ok = expected.alignment == head.alignment && expected.span == head.span &&
+             head.state_offset == head.data_offset + head.span * sizeof(double) &&
+             head.state_words == (head.width * head.height + 63) / 64 &&
+             head.state_offset + head.state_words * sizeof(uint64_t) <= file.size();
+        for (size_t f = 0; f < 6 && ok; ++f) ok = expected.offsets[f] == head.offsets[f];
+    }
+    if (!ok) return false;
+    file_path = path;
+    valid = true;
+    return true;
+}
+
+bool FieldImage::verify() const {
+    if (!valid) return false;
+    MappedFile file;
+    if (!file.open(file_path, MappedFile::Access::Sequential)) return false;
+    if (head.state_offset + head.state_words * sizeof(uint64_t) > file.size()) return false;
+    // Stav leží hned za polemi: jeden souvislý průchod
+    return crc32c::compute(file.data() + head.data_offset, head.state_offset + head.state_words * sizeof(uint64_t) -
+                                                               head.data_offset) == head.data_crc;
+}
+
+DIFPGrid<double> FieldImage::map_private(uint32_t written) const {
+    if (!valid) throw std::logic_error("FieldImage: map_private() without a successful open().");
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(file_path, MappedFile::Access::Sequential, MappedFile::Mode::CopyOnWrite) ||
+        head.state_offset + head.state_words * sizeof(uint64_t) > file->size()) {
+        throw std::runtime_error("FieldImage: cannot map " + file_path);
+    }
+    for (size_t f = 0; f < 6; ++f) {
+        if (written & (1u << f)) {
+            file->populate(head.data_offset + head.offsets[f] * sizeof(double), head.padded_size * sizeof(double),
+                           true);
+        }
+    }
+    double* block = reinterpret_cast<double*>(file->mutable_data() + head.data_offset);
+    const uint8_t* state = file->data() + head.state_offset;
+    DIFPGrid<double> grid = DIFPGrid<double>::adopt(head.width, head.height, FieldLayout(head.layout),
+                                                    head.stagger_slot, block, std::move(file));
+    std::memcpy(grid.state_data(), state, head.state_words * sizeof(uint64_t));
+    return grid;
+}
@@ -0,0 +1,85 @@
+#ifndef DIFP_FIELD_IMAGE_HPP
+#define DIFP_FIELD_IMAGE_HPP
+
+#include "DIFP_Core.hpp"
+#include "mapped_file.hpp"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Obraz paměti DIFPGrid pro sdílené počáteční podmínky (sweep, ensemble).
+ *
+ * Formát souboru (little-endian):
+ *   [FieldImageHeader, doplněno nulami na FIELD_IMAGE_DATA_OFFSET] [zarovnaný blok polí] [state_bits]
+ *
+ * Blok polí je bajt po bajtu totéž, co DIFPGrid drží od zarovnaného začátku (block(),
+ * layout.span prvků včetně mezer mezi poli). Data začínají na hranici stránky, takže
+ * po mmap leží blok zarovnaně a mřížka nad ním vznikne bez kopie (DIFPGrid::adopt).
+ * Slova state_bits následují hned za blokem polí; map_private() je do mřížky zkopíruje
+ * (mřížka je drží ve vlastním vektoru).
+ * Na rozdíl od snapshotu (dlaždice, výřezy) je to formát pro jedno rychlé namapování.
+ */
+
+constexpr uint64_t FIELD_IMAGE_DATA_OFFSET = ALIASING_PERIOD_BYTES;
+
+struct FieldImageHeader {
+    char magic[8];          // "DIFPIMG1"
+    uint32_t version;       // 2: se state_bits
+    uint32_t layout;        // FieldLayout
+    uint64_t width;
+    uint64_t height;
+    uint64_t padded_size;
+    uint32_t stagger_slot;
+    uint32_t alignment;     // Zarovnání bloku v bajtech (<= FIELD_IMAGE_DATA_OFFSET)
+    uint64_t offsets[6];    // Offsety polí v prvcích (DIFPGrid::Layout)
+    uint64_t span;          // Prvků v bloku
+    uint64_t data_offset;
+    uint64_t state_offset;  // Slova state_bits za blokem polí
+    uint64_t state_words;   // (width * height + 63) / 64
+    uint32_t data_crc;      // CRC32C bloku polí a state_bits (v tomto pořadí)
+    uint32_t header_crc;    // CRC32C předchozích 132 bajtů hlavičky
+};
+static_assert(sizeof(FieldImageHeader) == 136, "FieldImageHeader musi mit 136 bajtu.");
+
+/**
+ * @brief Zapíše mřížku jako obraz paměti. Při chybě zápisu vyhodí std::runtime_error.
+ */
+void write_field_image(const std::string& path, const DIFPGrid<double>& grid);
+
+/**
+ * @class FieldImage
+ * @brief Obraz otevřený pro opakované mapování; každá mřížka z map_private() má
+ *        vlastní copy-on-write mapování souboru.
+ * @details Čtené stránky (typicky mass, pressure) sdílí všechna mapování v page cache,
+ *          stránku zkopíruje jádro až při prvním zápisu. Soubor zůstává beze změny.
+ *          map_private() lze volat z více vláken i z procesů po fork().
+ */
+class FieldImage {
+private:
+    std::string file_path;
+    FieldImageHeader head{};
+    bool valid = false;
+
+public:
+    // false, pokud soubor nejde otevřít, nemá platnou hlavičku nebo nesedí velikost
+    bool open(const std::string& path);
+
+    [[nodiscard]] bool is_open() const { return valid; }
+    [[nodiscard]] const FieldImageHeader& header() const { return head; }
+    [[nodiscard]] size_t width() const { return head.width; }
+    [[nodiscard]] size_t height() const { return head.height; }
+
+    // Ověří CRC32C bloku polí a state_bits (projde celý soubor)
+    [[nodiscard]] bool verify() const;
+
+    /**
+     * @brief Soukromá copy-on-write mřížka nad souborem (mapování žije s mřížkou).
+     * @param written Pole (FieldMask), do kterých běh určitě zapíše: jejich stránky se
+     *                zkopírují hned (MappedFile::populate), ostatní až při zápisu.
+     * @details state_bits se zkopírují z obrazu. Při chybě mapování vyhodí std::runtime_error.
+     */
+    [[nodiscard]] DIFPGrid<double> map_private(uint32_t written = FIELD_POTENTIAL | FIELD_VX | FIELD_VY) const;
+};
+
+#endif // DIFP_FIELD_IMAGE_HPP
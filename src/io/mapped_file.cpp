@@ -0,0 +1,102 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+bool MappedFile::open(const std::string& path, Access access, Mode mode) {
+    close();
+    DWORD flags = (access == Access::Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    const bool cow = mode == Mode::CopyOnWrite;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, cow ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, cow ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_handle = file;
+    mapping_handle = mapping;
+    base = static_cast<uint8_t*>(view);
+    length = static_cast<size_t>(file_size.QuadPart);
+    writable = cow;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) UnmapViewOfFile(base);
+    if (mapping_handle) CloseHandle(static_cast<HANDLE>(mapping_handle));
+    if (file_handle) CloseHandle(static_cast<HANDLE>(file_handle));
+    base = nullptr;
+    length = 0;
+    writable = false;
+    file_handle = mapping_handle = nullptr;
+}
+
+bool MappedFile::populate(size_t, size_t, bool) { return false; }
+
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+bool MappedFile::open(const std::string& path, Access access, Mode mode) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    const bool cow = mode == Mode::CopyOnWrite;
+    // MAP_PRIVATE: zápis zkopíruje stránku, soubor zůstane beze změny (fd stačí O_RDONLY)
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), cow ? PROT_READ | PROT_WRITE : PROT_READ,
+                   cow ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    ::close(fd); // Mapování drží soubor otevřený samo
+    if (p == MAP_FAILED) return false;
+
+    madvise(p, static_cast<size_t>(st.st_size), access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    base = static_cast<uint8_t*>(p);
+    length = static_cast<size_t>(st.st_size);
+    writable = cow;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) munmap(base, length);
+    base = nullptr;
+    length = 0;
+    writable = false;
+}
+
+bool MappedFile::populate(size_t offset, size_t bytes, bool for_write) {
+    if (!base || offset >= length || (for_write && !writable)) return false;
+#if defined(MADV_POPULATE_READ) && defined(MADV_POPULATE_WRITE)
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t begin = offset & ~(page - 1);
+    const size_t end = std::min(offset + bytes, length);
+    return madvise(base + begin, end - begin, for_write ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) == 0;
+#else
+    (void)bytes;
+    return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef DIFP_MAPPED_FILE_HPP
+#define DIFP_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class MappedFile
+ * @brief Soubor namapovaný do paměti (POSIX mmap / Win32 MapViewOfFile).
+ * @details Stránky se načítají až při prvním přístupu, takže otevření velkého
+ *          souboru nic nestojí a paměť drží jen jádro (page cache), ne proces.
+ *          V režimu CopyOnWrite lze do mapování zapisovat: zapsaná stránka se
+ *          zkopiuje jen pro toto mapování, soubor ani ostatní mapování ji nevidí.
+ */
+class MappedFile {
+public:
+    enum class Access {
+        Random,     // Několik bloků napříč souborem (bez read-ahead)
+        Sequential, // Celý soubor od začátku do konce (agresivní read-ahead)
+    };
+
+    enum class Mode {
+        ReadOnly,    // Sdílené stránky page cache, zápis je chyba
+        CopyOnWrite, // Soukromé mapování: čtené stránky sdílené, zapsané zkopírované
+    };
+
+private:
+    uint8_t* base = nullptr;
+    size_t length = 0;
+    bool writable = false;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false, pokud soubor neexistuje, je prázdný nebo ho nelze namapovat
+    bool open(const std::string& path, Access access = Access::Random, Mode mode = Mode::ReadOnly);
+    void close();
+
+    [[nodiscard]] const uint8_t* data() const { return base; }
+    // Jen v režimu CopyOnWrite, jinak nullptr
+    [[nodiscard]] uint8_t* mutable_data() { return writable ? base : nullptr; }
+
+    /**
+     * @brief Namapuje stránky rozsahu předem jednou operací jádra (Linux MADV_POPULATE_*).
+     * @details S for_write v režimu CopyOnWrite rovnou vytvoří soukromé kopie: zápis do
+     *          dosud čtené stránky by jinak stál dva výpadky stránky (čtení + kopie).
+     *          Bez podpory jádra nic nedělá a vrátí false.
+     */
+    bool populate(size_t offset, size_t bytes, bool for_write);
+    [[nodiscard]] size_t size() const { return length; }
+    [[nodiscard]] bool is_open() const { return base != nullptr; }
+};
+
+#endif // DIFP_MAPPED_FILE_HPP
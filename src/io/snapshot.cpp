@@ -0,0 +1,283 @@
+#include "snapshot.hpp"
+#include "crc32c.hpp"
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'D', 'I', 'F', 'P', 'S', 'N', 'P', '1'};
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+constexpr uint64_t CHUNK_ALIGNMENT = 64;
+
+template <typename Grid>
+auto field_pointer(Grid& grid, SnapshotField field) -> decltype(grid.potential) {
+    switch (field) {
+        case SnapshotField::Potential: return grid.potential;
+        case SnapshotField::Mass:      return grid.mass;
+        case SnapshotField::VX:        return grid.vx;
+        case SnapshotField::VY:        return grid.vy;
+        case SnapshotField::Friction:  return grid.friction;
+        case SnapshotField::Pressure:  return grid.pressure;
+    }
+    return nullptr;
+}
+
+uint32_t header_checksum(const SnapshotHeader& h) {
+    return crc32c::compute(&h, offsetof(SnapshotHeader, header_crc));
+}
+
+} // namespace
+
+const char* snapshot_field_name(SnapshotField field) {
+    static const char* const names[SNAPSHOT_FIELD_COUNT] = {"potential", "mass", "vx", "vy", "friction", "pressure"};
+    uint32_t i = static_cast<uint32_t>(field);
+    return i < SNAPSHOT_FIELD_COUNT ? names[i] : "?";
+}
+
+void write_snapshot(const std::string& path, const DIFPGrid<double>& grid, uint64_t step, double time,
+                    uint32_t tile_width, uint32_t tile_height) {
+    if (tile_width == 0 || tile_height == 0) {
+        throw std::invalid_argument("write_snapshot: tile size must be positive.");
+    }
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("write_snapshot: cannot open " + path);
+    std::vector<char> io_buffer(size_t(1) << 20);
+    std::setvbuf(f, io_buffer.data(), _IOFBF, io_buffer.size());
+
+    SnapshotHeader head{};
+    std::memcpy(head.magic, SNAPSHOT_MAGIC, sizeof(head.magic));
+    head.version = SNAPSHOT_VERSION;
+    head.field_count = SNAPSHOT_FIELD_COUNT;
+    head.width = grid.width;
+    head.height = grid.height;
+    head.tile_width = tile_width;
+    head.tile_height = tile_height;
+    head.step = step;
+    head.time = time;
+
+    const size_t tiles_x = (grid.width + tile_width - 1) / tile_width;
+    const size_t tiles_y = (grid.height + tile_height - 1) / tile_height;
+
+    bool ok = std::fwrite(&head, sizeof(head), 1, f) == 1;
+    uint64_t position = sizeof(head);
+    static const uint8_t zeros[CHUNK_ALIGNMENT] = {};
+    auto pad_to_alignment = [&]() {
+        uint64_t pad = (CHUNK_ALIGNMENT - position % CHUNK_ALIGNMENT) % CHUNK_ALIGNMENT;
+        ok = ok && std::fwrite(zeros, 1, pad, f) == pad;
+        position += pad;
+    };
+
+    std::vector<SnapshotChunk> chunks;
+    chunks.reserve(SNAPSHOT_FIELD_COUNT * tiles_x * tiles_y + 1);
+
+    // Jedna řada dlaždic: skládání dlaždic a CRC paralelně, zápis pak sériově v pořadí indexu
+    const size_t tile_stride = size_t(tile_width) * tile_height;
+    std::vector<double> tile_row(tiles_x * tile_stride);
+    std::vector<uint32_t> row_checksums(tiles_x);
+
+    for (uint32_t field = 0; field < SNAPSHOT_FIELD_COUNT && ok; ++field) {
+        const double* src = field_pointer(grid, static_cast<SnapshotField>(field));
+        for (size_t ty = 0; ty < tiles_y && ok; ++ty) {
+            const size_t y0 = ty * tile_height;
+            const size_t th = std::min<size_t>(tile_height, grid.height - y0);
+
+            #pragma omp parallel for schedule(static)
+            for (size_t tx = 0; tx < tiles_x; ++tx) {
+                const size_t x0 = tx * tile_width;
+                const size_t tw = std::min<size_t>(tile_width, grid.width - x0);
+                double* tile = tile_row.data() + tx * tile_stride;
+                for (size_t r = 0; r < th; ++r) {
+                    std::memcpy(tile + r * tw, src + (y0 + r) * grid.width + x0, tw * sizeof(double));
+                }
+                row_checksums[tx] = crc32c::compute(tile, tw * th * sizeof(double));
+            }
+
+            for (size_t tx = 0; tx < tiles_x && ok; ++tx) {
+                const size_t tw = std::min<size_t>(tile_width, grid.width - tx * tile_width);
+                pad_to_alignment();
+                const uint64_t bytes = tw * th * sizeof(double);
+                SnapshotChunk chunk{};
+                chunk.field = field;
+                chunk.tile_x = static_cast<uint32_t>(tx);
+                chunk.tile_y = static_cast<uint32_t>(ty);
+                chunk.checksum = row_checksums[tx];
+                chunk.offset = position;
+                chunk.bytes = bytes;
+                chunks.push_back(chunk);
+
+                ok = ok && std::fwrite(tile_row.data() + tx * tile_stride, 1, bytes, f) == bytes;
+                position += bytes;
+            }
+        }
+    }
+
+    // Blok state_bits (jeden, za všemi poli)
+    if (ok) {
+        pad_to_alignment();
+        const uint64_t bytes = grid.state_word_count() * sizeof(uint64_t);
+        SnapshotChunk chunk{};
+        chunk.field = SNAPSHOT_STATE_CHUNK;
+        chunk.checksum = crc32c::compute(grid.state_data(), bytes);
+        chunk.offset = position;
+        chunk.bytes = bytes;
+        chunks.push_back(chunk);
+        ok = std::fwrite(grid.state_data(), 1, bytes, f) == bytes;
+        position += bytes;
+    }
+
+    pad_to_alignment();
+    head.index_offset = position;
+    head.chunk_count = chunks.size();
+    head.index_crc = crc32c::compute(chunks.data(), chunks.size() * sizeof(SnapshotChunk));
+    head.header_crc = header_checksum(head);
+    ok = ok && std::fwrite(chunks.data(), sizeof(SnapshotChunk), chunks.size(), f) == chunks.size();
+
+    // Hlavička se přepíše až nakonec: nedokončený soubor nemá platný index_offset
+    ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&head, sizeof(head), 1, f) == 1;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) throw std::runtime_error("write_snapshot: write failed for " + path);
+}
+
+SnapshotReader::~SnapshotReader() { close(); }
+
+void SnapshotReader::close() {
+    file.close();
+    mapping = nullptr;
+    mapped_bytes = 0;
+    index = nullptr;
+    chunk_state.reset();
+}
+
+bool SnapshotReader::open(const std::string& path, MappedFile::Access access) {
+    close();
+    if (!file.open(path, access) || file.size() < sizeof(SnapshotHeader)) {
+        file.close();
+        return false;
+    }
+    mapping = file.data();
+    mapped_bytes = file.size();
+
+    std::memcpy(&head, mapping, sizeof(head));
+    bool ok = std::memcmp(head.magic, SNAPSHOT_MAGIC, sizeof(head.magic)) == 0 &&
+              (head.version == 1 || head.version == SNAPSHOT_VERSION) && head.field_count == SNAPSHOT_FIELD_COUNT &&
+              head.header_crc == header_checksum(head) && head.tile_width && head.tile_height;
+    if (ok) {
+        tiles_x = (head.width + head.tile_width - 1) / head.tile_width;
+        tiles_y = (head.height + head.tile_height - 1) / head.tile_height;
+        const size_t state_chunks = has_state_bits() ? 1 : 0;
+        ok = head.chunk_count == SNAPSHOT_FIELD_COUNT * tiles_x * tiles_y + state_chunks &&
+             head.index_offset % alignof(SnapshotChunk) == 0 &&
+             head.index_offset + head.chunk_count * sizeof(SnapshotChunk) <= mapped_bytes;
+    }
+    if (ok) {
+        index = reinterpret_cast<const SnapshotChunk*>(mapping + head.index_offset);
+        ok = crc32c::compute(index, head.chunk_count * sizeof(SnapshotChunk)) == head.index_crc;
+    }
+    if (!ok) {
+        close();
+        return false;
+    }
+    chunk_state.reset(new std::atomic<uint8_t>[head.chunk_count]);
+    for (size_t i = 0; i < head.chunk_count; ++i) chunk_state[i].store(0, std::memory_order_relaxed);
+    return true;
+}
+
+const SnapshotChunk* SnapshotReader::find_chunk(SnapshotField field, size_t tx, size_t ty) const {
+    const size_t f = static_cast<size_t>(field);
+    if (!mapping || f >= SNAPSHOT_FIELD_COUNT || tx >= tiles_x || ty >= tiles_y) return nullptr;
+    // Zapisovač ukládá bloky v pořadí pole, řádek dlaždic, sloupec dlaždic
+    const SnapshotChunk* c = &index[(f * tiles_y + ty) * tiles_x + tx];
+    if (c->field != f || c->tile_x != tx || c->tile_y != ty) return nullptr;
+    return c;
+}
+
+bool SnapshotReader::verify_chunk(size_t chunk_index) const {
+    uint8_t state = chunk_state[chunk_index].load(std::memory_order_acquire);
+    if (state == 0) {
+        const SnapshotChunk& c = index[chunk_index];
+        bool ok = c.offset + c.bytes <= mapped_bytes && c.offset % CHUNK_ALIGNMENT == 0 &&
+                  crc32c::compute(mapping + c.offset, c.bytes) == c.checksum;
+        state = ok ? 1 : 2;
+        chunk_state[chunk_index].store(state, std::memory_order_release);
+    }
+    return state == 1;
+}
+
+const double* SnapshotReader::chunk_data(SnapshotField field, size_t tx, size_t ty, size_t& tw, size_t& th) const {
+    const SnapshotChunk* c = find_chunk(field, tx, ty);
+    if (!c || !verify_chunk(static_cast<size_t>(c - index))) return nullptr;
+    tw = std::min<size_t>(head.tile_width, head.width - tx * head.tile_width);
+    th = std::min<size_t>(head.tile_height, head.height - ty * head.tile_height);
+    if (c->bytes != tw * th * sizeof(double)) return nullptr;
+    return reinterpret_cast<const double*>(mapping + c->offset);
+}
+
+bool SnapshotReader::read_region(SnapshotField field, size_t x0, size_t y0, size_t w, size_t h, double* out) const {
+    if (!mapping || x0 + w > head.width || y0 + h > head.height) return false;
+    if (w == 0 || h == 0) return true;
+
+    const size_t TW = head.tile_width, TH = head.tile_height;
+    for (size_t ty = y0 / TH; ty <= (y0 + h - 1) / TH; ++ty) {
+        for (size_t tx = x0 / TW; tx <= (x0 + w - 1) / TW; ++tx) {
+            size_t tw, th;
+            const double* data = chunk_data(field, tx, ty, tw, th);
+            if (!data) return false;
+
+            // Průnik výřezu s dlaždicí v souřadnicích mřížky
+            const size_t gx0 = std::max(x0, tx * TW), gx1 = std::min(x0 + w, tx * TW + tw);
+            const size_t gy0 = std::max(y0, ty * TH), gy1 = std::min(y0 + h, ty * TH + th);
+            for (size_t gy = gy0; gy < gy1; ++gy) {
+                std::memcpy(out + (gy - y0) * w + (gx0 - x0), data + (gy - ty * TH) * tw + (gx0 - tx * TW),
+                            (gx1 - gx0) * sizeof(double));
+            }
+        }
+    }
+    return true;
+}
+
+bool SnapshotReader::load(DIFPGrid<double>& grid) const {
+    if (!mapping || grid.width != head.width || grid.height != head.height) return false;
+
+    // Obnova: bloky se ověřují a kopírují paralelně (každý blok míří do jiné části mřížky)
+    const size_t per_field = tiles_x * tiles_y;
+    const long long n_chunks = static_cast<long long>(SNAPSHOT_FIELD_COUNT * per_field);
+    bool ok = true;
+    #pragma omp parallel for schedule(dynamic) reduction(&& : ok)
+    for (long long c = 0; c < n_chunks; ++c) {
+        const size_t field = static_cast<size_t>(c) / per_field;
+        const size_t t = static_cast<size_t>(c) % per_field;
+        const size_t tx = t % tiles_x, ty = t / tiles_x;
+        size_t tw, th;
+        const double* data = chunk_data(static_cast<SnapshotField>(field), tx, ty, tw, th);
+        if (!data) {
+            ok = false;
+            continue;
+        }
+        double* dst = field_pointer(grid, static_cast<SnapshotField>(field)) + ty * head.tile_height * head.width +
+                      tx * head.tile_width;
+        for (size_t r = 0; r < th; ++r) std::memcpy(dst + r * head.width, data + r * tw, tw * sizeof(double));
+    }
+    if (!ok || !has_state_bits()) return ok;
+
+    // Blok state_bits je poslední v indexu
+    const size_t state_index = static_cast<size_t>(head.chunk_count) - 1;
+    const SnapshotChunk& c = index[state_index];
+    const uint64_t bytes = grid.state_word_count() * sizeof(uint64_t);
+    if (c.field != SNAPSHOT_STATE_CHUNK || c.bytes != bytes || !verify_chunk(state_index)) return false;
+    std::memcpy(grid.state_data(), mapping + c.offset, bytes);
+    return true;
+}
+
+size_t SnapshotReader::verify_all() const {
+    if (!mapping) return 0;
+    size_t corrupted = 0;
+    const long long n_chunks = static_cast<long long>(head.chunk_count);
+    #pragma omp parallel for schedule(dynamic) reduction(+ : corrupted)
+    for (long long i = 0; i < n_chunks; ++i) {
+        if (!verify_chunk(static_cast<size_t>(i))) ++corrupted;
+    }
+    return corrupted;
+}
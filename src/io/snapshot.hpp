@@ -0,0 +1,147 @@
+#ifndef DIFP_SNAPSHOT_HPP
+#define DIFP_SNAPSHOT_HPP
+
+#include "DIFP_Core.hpp"
+#include "mapped_file.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Snapshot DIFPGrid po blocích (pole x dlaždice) s indexem a kontrolními součty.
+ *
+ * Formát souboru (little-endian):
+ *   [SnapshotHeader, 80 B] ... bloky dat ... [index: chunk_count x SnapshotChunk]
+ *
+ * Blok = jedna dlaždice (tile_width x tile_height, u okraje menší) jednoho pole,
+ * hodnoty double po řádcích dlaždice. Bloky začínají na 64B hranici, po mmap jsou
+ * tedy data zarovnaná stejně jako v DIFPGrid. Index je na konci (zapisuje se až po
+ * datech), hlavička na něj ukazuje. Čtení výřezu jednoho pole sáhne jen na bloky,
+ * které výřez protíná.
+ *
+ * Za bloky polí následuje jeden blok state_bits (field == SNAPSHOT_STATE_CHUNK, dlaždice 0,0,
+ * (width * height + 63) / 64 slov uint64_t), poslední v indexu. Verze 1 ho neměla; load()
+ * takového souboru nechá stavové bity mřížky beze změny.
+ *
+ * Kontrolní součty bloků (CRC32C, viz crc32c.hpp) se počítají paralelně už při
+ * skládání dlaždic pro zápis; při čtení se ověřují líně nebo paralelně (load, verify_all).
+ */
+
+enum class SnapshotField : uint32_t {
+    Potential = 0,
+    Mass,
+    VX,
+    VY,
+    Friction,
+    Pressure,
+};
+
+constexpr uint32_t SNAPSHOT_FIELD_COUNT = 6;
+
+// Hodnota SnapshotChunk::field bloku se state_bits (verze 2)
+constexpr uint32_t SNAPSHOT_STATE_CHUNK = SNAPSHOT_FIELD_COUNT;
+
+const char* snapshot_field_name(SnapshotField field);
+
+struct SnapshotHeader {
+    char magic[8];          // "DIFPSNP1"
+    uint32_t version;
+    uint32_t field_count;
+    uint64_t width;
+    uint64_t height;
+    uint32_t tile_width;
+    uint32_t tile_height;
+    uint64_t step;          // Krok simulace (metadata)
+    double time;            // Simulační čas (metadata)
+    uint64_t index_offset;
+    uint64_t chunk_count;
+    uint32_t index_crc;     // CRC32C celého indexu
+    uint32_t header_crc;    // CRC32C předchozích 76 bajtů hlavičky
+};
+static_assert(sizeof(SnapshotHeader) == 80, "SnapshotHeader musi mit 80 bajtu.");
+
+struct SnapshotChunk {
+    uint32_t field;
+    uint32_t tile_x;
+    uint32_t tile_y;
+    uint32_t checksum;      // CRC32C dat bloku
+    uint64_t offset;        // Od začátku souboru
+    uint64_t bytes;
+};
+static_assert(sizeof(SnapshotChunk) == 32, "SnapshotChunk musi mit 32 bajtu.");
+
+/**
+ * @brief Zapíše všech šest polí mřížky a state_bits. Při chybě zápisu vyhodí std::runtime_error.
+ */
+void write_snapshot(const std::string& path, const DIFPGrid<double>& grid, uint64_t step = 0,
+                    double time = 0.0, uint32_t tile_width = 256, uint32_t tile_height = 256);
+
+/**
+ * @class SnapshotReader
+ * @brief Náhodný přístup do snapshotu přes mmap (čte se jen to, na co se sáhne).
+ * @details Kontrolní součet bloku se ověří při prvním čtení bloku (jednou za otevření),
+ *          verify_all() ověří všechny. Čtecí metody lze volat z více vláken současně.
+ */
+class SnapshotReader {
+private:
+    MappedFile file;
+    const uint8_t* mapping = nullptr;
+    size_t mapped_bytes = 0;
+    SnapshotHeader head{};
+    const SnapshotChunk* index = nullptr;
+    size_t tiles_x = 0;
+    size_t tiles_y = 0;
+
+    // 0 = neověřeno, 1 = v pořádku, 2 = poškozeno
+    std::unique_ptr<std::atomic<uint8_t>[]> chunk_state;
+
+    const SnapshotChunk* find_chunk(SnapshotField field, size_t tx, size_t ty) const;
+    bool verify_chunk(size_t chunk_index) const;
+
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    /**
+     * @param access Random pro výřezy, Sequential pro průchod všemi bloky (analýza).
+     * @return false, pokud soubor nelze otevřít, nemá platnou hlavičku nebo je index poškozený.
+     */
+    bool open(const std::string& path, MappedFile::Access access = MappedFile::Access::Random);
+    void close();
+
+    [[nodiscard]] bool is_open() const { return mapping != nullptr; }
+    [[nodiscard]] const SnapshotHeader& header() const { return head; }
+    [[nodiscard]] size_t width() const { return head.width; }
+    [[nodiscard]] size_t height() const { return head.height; }
+    [[nodiscard]] size_t tile_columns() const { return tiles_x; }
+    [[nodiscard]] size_t tile_rows() const { return tiles_y; }
+
+    /**
+     * @brief Přímý (zero-copy) pohled na data bloku; nullptr, pokud blok neexistuje nebo je poškozený.
+     * @param tw, th Rozměry dlaždice (u okraje mřížky menší než tile_width x tile_height).
+     */
+    const double* chunk_data(SnapshotField field, size_t tx, size_t ty, size_t& tw, size_t& th) const;
+
+    /**
+     * @brief Výřez [x0, x0+w) x [y0, y0+h) jednoho pole do out (po řádcích, w * h hodnot).
+     * @return false při výřezu mimo mřížku nebo poškozeném bloku.
+     */
+    bool read_region(SnapshotField field, size_t x0, size_t y0, size_t w, size_t h, double* out) const;
+
+    // Snapshot obsahuje blok state_bits (verze 2 a novější)
+    [[nodiscard]] bool has_state_bits() const { return head.version >= 2; }
+
+    // Načte všechna pole a state_bits do mřížky (rozměry musí sedět); bloky ověřuje paralelně
+    bool load(DIFPGrid<double>& grid) const;
+
+    // Ověří kontrolní součty všech bloků paralelně; vrací počet poškozených
+    size_t verify_all() const;
+};
+
+#endif // DIFP_SNAPSHOT_HPP
@@ -0,0 +1,40 @@
+#ifndef DIFP_SPSC_RING_HPP
+#define DIFP_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class SpscRing
+ * @brief Lock-free fronta jeden producent / jeden konzument s pevnou kapacitou (mocnina dvou).
+ * @details Bez ukazatelů a alokací: s triviálně kopírovatelným T ji lze umístit i do paměti
+ *          sdílené mezi procesy (viz steering.hpp), indexy jsou lock-free atomiky.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Kapacita musi byt mocnina dvou.");
+
+private:
+    T slots[Capacity];
+    alignas(64) std::atomic<size_t> head{0}; // Zapisuje konzument
+    alignas(64) std::atomic<size_t> tail{0}; // Zapisuje producent
+
+public:
+    bool push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+        slots[t & (Capacity - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        value = slots[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif // DIFP_SPSC_RING_HPP
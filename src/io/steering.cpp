@@ -0,0 +1,367 @@
+#include "steering.hpp"
+#include "snapshot.hpp"
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char STEERING_MAGIC[8] = {'D', 'I', 'F', 'P', 'S', 'T', 'R', '1'};
+constexpr uint32_t STEERING_VERSION = 2;
+
+std::string segment_path(const std::string& name) {
+    if (name.empty() || name.find_first_of("/\\") != std::string::npos) {
+        throw std::invalid_argument("Steering: segment name must be non-empty and without slashes.");
+    }
+#ifdef _WIN32
+    return "Local\\difp_steer_" + name;
+#else
+    return "/difp_steer_" + name;
+#endif
+}
+
+uint32_t current_pid() {
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// Proces s daným PID běží (při nejistotě, např. EPERM, se bere jako živý)
+bool process_alive(uint32_t pid) {
+    if (pid == 0) return false;
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!process) return GetLastError() != ERROR_INVALID_PARAMETER;
+    DWORD code = 0;
+    const bool alive = !GetExitCodeProcess(process, &code) || code == STILL_ACTIVE;
+    CloseHandle(process);
+    return alive;
+#else
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+#endif
+}
+
+bool segment_valid(const SteeringSegment* segment) {
+    return segment->ready.load(std::memory_order_acquire) &&
+           std::memcmp(segment->magic, STEERING_MAGIC, sizeof(segment->magic)) == 0 &&
+           segment->version == STEERING_VERSION && segment->command_bytes == sizeof(SteeringCommand);
+}
+
+// Obsadí slot producenta; slot nástroje, jehož proces skončil (kill -9), se převezme
+bool claim_producer(SteeringSegment* segment) {
+    const uint32_t self = current_pid();
+    uint32_t expected = 0;
+    if (segment->producer.compare_exchange_strong(expected, self, std::memory_order_acq_rel)) return true;
+    return !process_alive(expected) &&
+           segment->producer.compare_exchange_strong(expected, self, std::memory_order_acq_rel);
+}
+
+void init_segment(SteeringSegment* segment) {
+    std::memcpy(segment->magic, STEERING_MAGIC, sizeof(segment->magic));
+    segment->version = STEERING_VERSION;
+    segment->command_bytes = sizeof(SteeringCommand);
+    segment->owner.store(current_pid(), std::memory_order_relaxed);
+    segment->ready.store(1, std::memory_order_release);
+}
+
+SteeringCommand blank(SteeringOp op) {
+    SteeringCommand c{};
+    c.op = static_cast<uint32_t>(op);
+    return c;
+}
+
+// Oblast [x0, x0 + w) x [y0, y0 + h) celá uvnitř mřížky (bez přetečení součtu)
+bool inside(const SteeringCommand& c, const DIFPGrid<double>& grid) {
+    return c.width && c.height && c.x0 < grid.width && c.y0 < grid.height && c.width <= grid.width - c.x0 &&
+           c.height <= grid.height - c.y0;
+}
+
+// Přičtení value k oblasti nesmí dát nekonečno ani NaN, u mass ani hodnotu <= 0. Ověří se
+// celá oblast předem, aby se odmítnutý příkaz nepropsal do mřížky ani zčásti.
+bool paint_add_valid(const SteeringCommand& c, const DIFPGrid<double>& grid, double* const (&fields)[6]) {
+    for (size_t f = 0; f < 6; ++f) {
+        if (!(c.target & (1u << f))) continue;
+        const bool positive = (1u << f) == FIELD_MASS;
+        for (size_t y = c.y0; y < size_t(c.y0) + c.height; ++y) {
+            const double* row = fields[f] + y * grid.width + c.x0;
+            for (size_t x = 0; x < c.width; ++x) {
+                const double sum = row[x] + c.value;
+                if (!std::isfinite(sum) || (positive && !(sum > 0.0))) return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+SteeringCommand SteeringCommand::set_parameter(SteeringParameter parameter, double value) {
+    SteeringCommand c = blank(SteeringOp::SetParameter);
+    c.target = static_cast<uint32_t>(parameter);
+    c.value = value;
+    return c;
+}
+
+SteeringCommand SteeringCommand::paint_field(uint32_t fields, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h,
+                                             double value, PaintMode mode) {
+    SteeringCommand c = blank(SteeringOp::PaintField);
+    c.target = fields;
+    c.mode = static_cast<uint32_t>(mode);
+    c.x0 = x0;
+    c.y0 = y0;
+    c.width = w;
+    c.height = h;
+    c.value = value;
+    return c;
+}
+
+SteeringCommand SteeringCommand::paint_state(uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, bool value) {
+    SteeringCommand c = paint_field(0, x0, y0, w, h, value ? 1.0 : 0.0);
+    c.op = static_cast<uint32_t>(SteeringOp::PaintState);
+    return c;
+}
+
+SteeringCommand SteeringCommand::snapshot(const std::string& path) {
+    if (path.empty() || path.size() >= STEERING_PATH_BYTES) {
+        throw std::invalid_argument("SteeringCommand: snapshot path is empty or too long.");
+    }
+    SteeringCommand c = blank(SteeringOp::Snapshot);
+    std::memcpy(c.path, path.c_str(), path.size() + 1);
+    return c;
+}
+
+SteeringCommand SteeringCommand::stop() { return blank(SteeringOp::Stop); }
+
+bool SteeringQueue::apply(const SteeringCommand& c, DIFPGrid<double>& grid, SteeringState& state) {
+    switch (static_cast<SteeringOp>(c.op)) {
+        case SteeringOp::SetParameter:
+            if (c.target == uint32_t(SteeringParameter::TimeStep)) {
+                if (!(c.value > 0.0) || !std::isfinite(c.value)) return false;
+                state.dt = c.value;
+                return true;
+            }
+            if (c.target == uint32_t(SteeringParameter::Paused)) {
+                state.paused = c.value != 0.0;
+                return true;
+            }
+            return false;
+
+        case SteeringOp::PaintField: {
+            if (!c.target || (c.target >> 6) || c.mode > uint32_t(PaintMode::Add) || !inside(c, grid)) return false;
+            double* const fields[6] = {grid.potential, grid.mass, grid.vx, grid.vy, grid.friction, grid.pressure};
+            const double v = c.value;
+            const bool add = c.mode == uint32_t(PaintMode::Add);
+            // Hmota je ve jmenovateli každé stage RK4: nekonečno, NaN ani mass <= 0 do mřížky nesmí
+            if (!std::isfinite(v)) return false;
+            if (!add && (c.target & FIELD_MASS) && !(v > 0.0)) return false;
+            if (add && !paint_add_valid(c, grid, fields)) return false;
+            for (size_t f = 0; f < 6; ++f) {
+                if (!(c.target & (1u << f))) continue;
+                for (size_t y = c.y0; y < size_t(c.y0) + c.height; ++y) {
+                    double* __restrict row = fields[f] + y * grid.width + c.x0;
+                    if (add) {
+                        #pragma omp simd
+                        for (size_t x = 0; x < c.width; ++x) row[x] += v;
+                    } else {
+                        #pragma omp simd
+                        for (size_t x = 0; x < c.width; ++x) row[x] = v;
+                    }
+                }
+            }
+            state.painted |= c.target;
+            return true;
+        }
+
+        case SteeringOp::PaintState:
+            if (!inside(c, grid) || std::isnan(c.value)) return false;
+            for (size_t y = c.y0; y < size_t(c.y0) + c.height; ++y) {
+                for (size_t x = c.x0; x < size_t(c.x0) + c.width; ++x) grid.set_state(y * grid.width + x, c.value != 0.0);
+            }
+            return true;
+
+        case SteeringOp::Snapshot:
+            // Cesta přišla z cizího procesu: bez nuly uvnitř pole ji nelze použít
+            if (!std::memchr(c.path, '\0', sizeof(c.path)) || !c.path[0]) return false;
+            try {
+                write_snapshot(c.path, grid, state.step, state.time);
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+            ++state.snapshots;
+            return true;
+
+        case SteeringOp::Stop:
+            state.stop = true;
+            return true;
+    }
+    return false;
+}
+
+#ifdef _WIN32
+
+SteeringQueue::SteeringQueue(const std::string& name) : segment_name(name) {
+    const std::string path = segment_path(name);
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                        static_cast<DWORD>(sizeof(SteeringSegment)), path.c_str());
+    if (!mapping) throw std::runtime_error("SteeringQueue: cannot create shared memory " + path);
+    const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SteeringSegment));
+    if (!view) {
+        CloseHandle(mapping);
+        throw std::runtime_error("SteeringQueue: cannot map shared memory " + path);
+    }
+    // Pojmenovaný objekt existuje, dokud ho někdo drží: živá simulace, nebo jen nástroj po spadlém běhu
+    const SteeringSegment* previous = static_cast<const SteeringSegment*>(view);
+    if (existed && previous->ready.load(std::memory_order_acquire) &&
+        process_alive(previous->owner.load(std::memory_order_acquire))) {
+        UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        throw std::runtime_error("SteeringQueue: segment " + path + " belongs to a running simulation.");
+    }
+    mapping_handle = mapping;
+    segment = new (view) SteeringSegment{};
+    init_segment(segment);
+}
+
+SteeringQueue::~SteeringQueue() {
+    if (segment) {
+        segment->ready.store(0, std::memory_order_release);
+        UnmapViewOfFile(segment);
+    }
+    if (mapping_handle) CloseHandle(static_cast<HANDLE>(mapping_handle));
+}
+
+bool SteeringClient::attach(const std::string& name) {
+    detach();
+    const std::string path = segment_path(name);
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, path.c_str());
+    if (!mapping) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SteeringSegment));
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_handle = mapping;
+    segment = static_cast<SteeringSegment*>(view);
+    if (!segment_valid(segment) || !claim_producer(segment)) {
+        UnmapViewOfFile(segment);
+        CloseHandle(mapping);
+        segment = nullptr;
+        mapping_handle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void SteeringClient::detach() {
+    if (!segment) return;
+    uint32_t self = current_pid();
+    segment->producer.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+    UnmapViewOfFile(segment);
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+    segment = nullptr;
+    mapping_handle = nullptr;
+}
+
+#else
+
+SteeringQueue::SteeringQueue(const std::string& name) : segment_name(name) {
+    const std::string path = segment_path(name);
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // Segment živé simulace se nesmí odpojit; po spadlém běhu se nahradí
+        // (nástroje připojené ke starému objektu u něj zůstanou)
+        uint32_t owner = 0;
+        const int old_fd = shm_open(path.c_str(), O_RDONLY, 0);
+        if (old_fd >= 0) {
+            struct stat st;
+            if (fstat(old_fd, &st) == 0 && static_cast<size_t>(st.st_size) == sizeof(SteeringSegment)) {
+                void* old = mmap(nullptr, sizeof(SteeringSegment), PROT_READ, MAP_SHARED, old_fd, 0);
+                if (old != MAP_FAILED) {
+                    const SteeringSegment* previous = static_cast<const SteeringSegment*>(old);
+                    if (segment_valid(previous)) owner = previous->owner.load(std::memory_order_acquire);
+                    munmap(old, sizeof(SteeringSegment));
+                }
+            }
+            ::close(old_fd);
+        }
+        if (process_alive(owner)) {
+            throw std::runtime_error("SteeringQueue: segment " + path + " belongs to a running simulation (pid " +
+                                     std::to_string(owner) + ").");
+        }
+        shm_unlink(path.c_str());
+        fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) throw std::runtime_error("SteeringQueue: cannot create shared memory " + path);
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, sizeof(SteeringSegment)) == 0) {
+        p = mmap(nullptr, sizeof(SteeringSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        throw std::runtime_error("SteeringQueue: cannot map shared memory " + path);
+    }
+    segment = new (p) SteeringSegment{};
+    init_segment(segment);
+}
+
+SteeringQueue::~SteeringQueue() {
+    if (!segment) return;
+    segment->ready.store(0, std::memory_order_release);
+    munmap(segment, sizeof(SteeringSegment));
+    shm_unlink(segment_path(segment_name).c_str());
+}
+
+bool SteeringClient::attach(const std::string& name) {
+    detach();
+    const std::string path = segment_path(name);
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == sizeof(SteeringSegment)) {
+        p = mmap(nullptr, sizeof(SteeringSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    segment = static_cast<SteeringSegment*>(p);
+    if (!segment_valid(segment) || !claim_producer(segment)) {
+        munmap(p, sizeof(SteeringSegment));
+        segment = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void SteeringClient::detach() {
+    if (!segment) return;
+    uint32_t self = current_pid();
+    segment->producer.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+    munmap(segment, sizeof(SteeringSegment));
+    segment = nullptr;
+}
+
+#endif
+
+bool SteeringClient::send(const SteeringCommand& command) {
+    return segment && segment->queue.push(command);
+}
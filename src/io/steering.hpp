@@ -0,0 +1,187 @@
+#ifndef DIFP_STEERING_HPP
+#define DIFP_STEERING_HPP
+
+#include "DIFP_Core.hpp"
+#include "spsc_ring.hpp"
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Řízení běžící simulace zvenku (steering) přes sdílenou paměť.
+ *
+ * Simulace vytvoří pojmenovaný segment (SteeringQueue), lokální nástroj (difp_steer)
+ * se k němu připojí (SteeringClient) a vkládá příkazy do lock-free SPSC fronty
+ * (SpscRing) přímo ve sdílené paměti – bez socketů, zámků a systémových volání.
+ * Simulace frontu vyprázdní mezi kroky (drain); prázdná fronta stojí jedno
+ * atomické načtení, takže drain() lze volat po každém kroku.
+ *
+ * Segment má jednoho producenta: druhý nástroj se nepřipojí, dokud se první neodpojí
+ * (nebo neskončí jeho proces). Segment živé simulace se stejným jménem nový běh nepřepíše.
+ */
+
+constexpr size_t STEERING_QUEUE_DEPTH = 256;
+constexpr size_t STEERING_PATH_BYTES = 88;
+
+enum class SteeringOp : uint32_t {
+    SetParameter = 1, // target = SteeringParameter, value
+    PaintField,       // target = maska polí (FieldMask), mode = PaintMode, oblast, value
+    PaintState,       // oblast state_bits, value != 0 -> nastavit
+    Snapshot,         // path (write_snapshot)
+    Stop,
+};
+
+enum class SteeringParameter : uint32_t {
+    TimeStep = 0, // dt > 0
+    Paused,       // value != 0 -> pozastavit
+};
+
+enum class PaintMode : uint32_t {
+    Set = 0,
+    Add, // Vstřik hmoty/energie: pole += value
+};
+
+/**
+ * @struct SteeringCommand
+ * @brief Příkaz pevné velikosti (kopíruje se celý do slotu fronty).
+ */
+struct SteeringCommand {
+    uint32_t op;                      // SteeringOp
+    uint32_t target;
+    uint32_t mode;
+    uint32_t x0, y0, width, height;
+    uint32_t reserved;
+    double value;
+    char path[STEERING_PATH_BYTES];   // Zakončeno nulou
+
+    static SteeringCommand set_parameter(SteeringParameter parameter, double value);
+    static SteeringCommand paint_field(uint32_t fields, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h,
+                                       double value, PaintMode mode = PaintMode::Set);
+    static SteeringCommand paint_state(uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, bool value);
+    // Vyhodí std::invalid_argument, pokud se cesta nevejde do STEERING_PATH_BYTES
+    static SteeringCommand snapshot(const std::string& path);
+    static SteeringCommand stop();
+};
+static_assert(sizeof(SteeringCommand) == 128, "SteeringCommand musi mit 128 bajtu.");
+
+/**
+ * @struct SteeringSegment
+ * @brief Obsah sdílené paměti. Čítače applied/rejected zapisuje jen simulace, nástroj
+ *        podle nich pozná, že jeho příkazy byly zpracovány.
+ */
+struct SteeringSegment {
+    char magic[8];                        // "DIFPSTR1"
+    uint32_t version;
+    uint32_t command_bytes;               // sizeof(SteeringCommand)
+    std::atomic<uint32_t> ready;          // 1 až po inicializaci segmentu
+    std::atomic<uint32_t> owner;          // PID simulace (0 = neznámý)
+    std::atomic<uint32_t> producer;       // PID připojeného nástroje (0 = žádný)
+    alignas(64) std::atomic<uint64_t> applied;
+    std::atomic<uint64_t> rejected;
+    SpscRing<SteeringCommand, STEERING_QUEUE_DEPTH> queue;
+};
+
+static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "Steering potrebuje lock-free atomiky (sdileni mezi procesy).");
+
+/**
+ * @struct SteeringState
+ * @brief Stav řízení, který patří smyčce simulace (ne mřížce).
+ */
+struct SteeringState {
+    double dt = 0.01;
+    uint64_t step = 0;     // Pro metadata snapshotu
+    double time = 0.0;
+    bool paused = false;
+    bool stop = false;
+    uint64_t snapshots = 0;
+    uint32_t painted = 0;  // FieldMask polí změněných malováním; nuluje volající
+};
+
+/**
+ * @class SteeringQueue
+ * @brief Strana simulace: vlastní segment (vytvoří ho a při zániku odstraní).
+ */
+class SteeringQueue {
+private:
+    std::string segment_name;
+    SteeringSegment* segment = nullptr;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+
+    bool apply(const SteeringCommand& command, DIFPGrid<double>& grid, SteeringState& state);
+
+public:
+    /**
+     * @param name Jméno segmentu (bez lomítek); segment po spadlém běhu se stejným jménem se nahradí.
+     * @details Pokud segment se stejným jménem patří běžícímu procesu, nebo sdílenou paměť
+     *          nelze vytvořit, vyhodí std::runtime_error.
+     */
+    explicit SteeringQueue(const std::string& name);
+    ~SteeringQueue();
+
+    SteeringQueue(const SteeringQueue&) = delete;
+    SteeringQueue& operator=(const SteeringQueue&) = delete;
+
+    /**
+     * @brief Zpracuje čekající příkazy (nejvýše STEERING_QUEUE_DEPTH), volat mezi kroky.
+     * @details Neplatný příkaz (oblast mimo mřížku, neznámé pole, hodnota inf/NaN, mass <= 0
+     *          i po přičtení, chyba zápisu snapshotu) se zahodí celý a započítá do rejected,
+     *          simulaci nepřeruší. Vrací počet příkazů.
+     *
+     *          Namalovaná pole se přidají do state.painted. Volající, který drží data odvozená
+     *          z mřížky, je musí podle masky obnovit a masku vynulovat: při FIELD_MASS |
+     *          FIELD_FRICTION ETDRK4Solver::invalidate() (tabulky operátorů podle mass a friction),
+     *          při indexovaných polích RegionIndex::rebuild().
+     */
+    inline size_t drain(DIFPGrid<double>& grid, SteeringState& state) {
+        SteeringCommand command;
+        size_t count = 0;
+        while (count < STEERING_QUEUE_DEPTH && segment->queue.pop(command)) {
+            const bool ok = apply(command, grid, state);
+            (ok ? segment->applied : segment->rejected).fetch_add(1, std::memory_order_release);
+            ++count;
+        }
+        return count;
+    }
+
+    [[nodiscard]] const std::string& name() const { return segment_name; }
+    [[nodiscard]] uint64_t applied() const { return segment->applied.load(std::memory_order_acquire); }
+    [[nodiscard]] uint64_t rejected() const { return segment->rejected.load(std::memory_order_acquire); }
+    [[nodiscard]] bool has_client() const { return segment->producer.load(std::memory_order_acquire) != 0; }
+};
+
+/**
+ * @class SteeringClient
+ * @brief Strana nástroje: připojí se k segmentu běžící simulace.
+ */
+class SteeringClient {
+private:
+    SteeringSegment* segment = nullptr;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+
+public:
+    SteeringClient() = default;
+    ~SteeringClient() { detach(); }
+
+    SteeringClient(const SteeringClient&) = delete;
+    SteeringClient& operator=(const SteeringClient&) = delete;
+
+    // false, pokud segment neexistuje, není platný, nebo už má živého producenta
+    // (slot po ukončeném nástroji se převezme)
+    bool attach(const std::string& name);
+    void detach();
+
+    // false, pokud je fronta plná (simulace nestíhá nebo neběží)
+    bool send(const SteeringCommand& command);
+
+    [[nodiscard]] bool is_attached() const { return segment != nullptr; }
+    [[nodiscard]] uint64_t applied() const { return segment->applied.load(std::memory_order_acquire); }
+    [[nodiscard]] uint64_t rejected() const { return segment->rejected.load(std::memory_order_acquire); }
+};
+
+#endif // DIFP_STEERING_HPP
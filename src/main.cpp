@@ -1,58 +1,1401 @@
 #include <iostream>
 #include <vector>
 #include <cstdint> // Pro přesné datové typy jako uint8_t
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include "universe/rewrite_rule.hpp"
+#include "universe/bitsliced_ensemble.hpp"
+#include "universe/packed_universe.hpp"
+#include "universe/species_universe.hpp"
+#include "universe/cycle_detector.hpp"
+#include "universe/event_recorder.hpp"
+#include "solvers/rk4_solver.hpp"
+#include "solvers/parareal.hpp"
+#include "solvers/etdrk4_solver.hpp"
+#include "solvers/split_operators.hpp"
+#include "solvers/physics_kernel.hpp"
+#include "solvers/explicit_rk.hpp"
+#include "solvers/adjoint_rk4.hpp"
+#include "solvers/parameter_sweep.hpp"
+#include "io/snapshot.hpp"
+#include "io/field_image.hpp"
+#include "io/steering.hpp"
+#include "io/crc32c.hpp"
+#include "analysis/histogram.hpp"
+#include "analysis/power_spectrum.hpp"
+#include "analysis/region_index.hpp"
+#include "diagnostics/alloc_tracker.hpp"
+#include "diagnostics/memory_report.hpp"
+#include "diagnostics/work_precision.hpp"
+#include "DIFP_Observers.hpp"
+
+// --quick (poslední argument): zmenšené úlohy pro ctest; kontroly výsledků zůstávají stejné
+static bool quick_run = false;
 
 /**
- * STRUKTURA: Node (Uzel mřížky)
- * Reprezentuje nejmenší kvantum prostoru.
- * V tvé teorii uzel nemá paměť, jen aktuální stav.
+ * REŽIM: Ensemble (--ensemble)
+ * Místo jednoho procesu na počáteční podmínku běží 512 vesmírů v jednom
+ * bitově řezaném souboru (8 x 64 bitů = jeden zmm registr na buňku).
+ * Všech 512 vesmírů malé 2D mřížky se ověří proti referenčnímu tick().
  */
-struct Node {
-    // 0 = volný prostor (vakuum), 1 = aktivní informace (hmota)
-    uint8_t state; 
-    
-    // density reprezentuje "zahuštění" mřížky v tomto bodě.
-    // V budoucnu bude ovlivňovat, kolik taktů musí uzel "čekat", než provede přepis.
-    float density; 
-};
+int run_ensemble() {
+    const size_t WIDTH = 4096;
+    const size_t HEIGHT = 1;
+    const int TICKS = 1000;
+    const double DENSITY = 0.3;
+
+    BitslicedEnsemble<8> ensemble(WIDTH, HEIGHT);
+
+    // Každý vesmír dostane vlastní náhodnou počáteční podmínku (seed = index vesmíru)
+    for (size_t u = 0; u < ensemble.UNIVERSES; ++u) {
+        std::mt19937_64 rng(u);
+        std::bernoulli_distribution occupied(DENSITY);
+        for (size_t i = 0; i < ensemble.size(); ++i) ensemble.set_cell(u, i, occupied(rng));
+    }
+
+    std::vector<UniverseStats> before = ensemble.statistics();
+    for (int t = 0; t < TICKS; ++t) ensemble.tick();
+    std::vector<UniverseStats> after = ensemble.statistics();
+
+    double mean_drift = 0.0;
+    for (size_t u = 0; u < ensemble.UNIVERSES; ++u) {
+        if (before[u].particles != after[u].particles) {
+            std::cerr << "Porušen zákon zachování informace ve vesmíru " << u << std::endl;
+            return 1;
+        }
+        mean_drift += after[u].mean_x - before[u].mean_x;
+    }
+    mean_drift /= static_cast<double>(ensemble.UNIVERSES);
+
+    std::cout << "--- ENSEMBLE: " << ensemble.UNIVERSES << " vesmiru, " << WIDTH << " uzlu, "
+              << TICKS << " taktu ---" << std::endl;
+    for (size_t u = 0; u < 4; ++u) {
+        std::cout << "Vesmir " << u << ": castic = " << after[u].particles
+                  << ", teziste x: " << before[u].mean_x << " -> " << after[u].mean_x << std::endl;
+    }
+    std::cout << "Prumerny posun teziste: " << mean_drift << std::endl;
+
+    // Každý vesmír (všechny bity všech W slov) proti skalárnímu tick() na 2D mřížce
+    const size_t CHECK_W = 256, CHECK_H = 4;
+    const int CHECK_TICKS = 200;
+    BitslicedEnsemble<8> check(CHECK_W, CHECK_H);
+    std::vector<std::vector<Node>> references(check.UNIVERSES);
+    for (size_t u = 0; u < check.UNIVERSES; ++u) {
+        std::mt19937_64 rng(1000 + u);
+        std::bernoulli_distribution occupied(0.05 + 0.9 * double(u) / double(check.UNIVERSES));
+        references[u].assign(CHECK_W * CHECK_H, Node{0, 1.0f});
+        for (Node& n : references[u]) n.state = occupied(rng) ? 1 : 0;
+        check.load_universe(u, references[u]);
+    }
+    for (int t = 0; t < CHECK_TICKS; ++t) check.tick();
+    size_t mismatched = 0;
+    std::vector<Node> lane;
+    for (size_t u = 0; u < check.UNIVERSES; ++u) {
+        for (int t = 0; t < CHECK_TICKS; ++t) tick(references[u], int(CHECK_W), int(CHECK_H));
+        check.store_universe(u, lane);
+        for (size_t i = 0; i < lane.size(); ++i) {
+            if (lane[i].state != references[u][i].state) {
+                ++mismatched;
+                break;
+            }
+        }
+    }
+    std::cout << "Vesmiry = referencni tick() (" << check.UNIVERSES << " vesmiru, " << CHECK_W << "x" << CHECK_H << ", "
+              << CHECK_TICKS << " taktu): " << (mismatched ? "CHYBA" : "OK") << std::endl;
+    return mismatched ? 1 : 0;
+}
+
+/**
+ * REŽIM: Dlouhý pruh (--strip)
+ * 1D pruh s 1 bitem na uzel, takt počítaný paralelním scanem přes všechna jádra.
+ * První takt se ověří proti sekvenčnímu průchodu.
+ */
+int run_strip() {
+    const size_t WIDTH = quick_run ? size_t(1) << 20 : size_t(1) << 28; // 268M uzlů = 32 MB
+    const int TICKS = 20;
+
+    PackedUniverse strip(WIDTH, 1);
+    std::mt19937_64 rng(42);
+    std::bernoulli_distribution occupied(0.5);
+    for (size_t i = 0; i < strip.cells; ++i) strip.set_state(i, occupied(rng));
+
+    PackedUniverse reference = strip;
+    reference.tick_serial();
+    strip.tick_parallel();
+    if (strip.words() != reference.words()) {
+        std::cerr << "Paralelni takt se lisi od sekvencniho pruchodu!" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < TICKS; ++t) strip.tick_parallel();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "--- STRIP: " << WIDTH << " uzlu, " << TICKS << " taktu ---" << std::endl;
+    std::cout << "Paralelni takt = sekvencni pruchod: OK" << std::endl;
+    std::cout << "Propustnost: " << (double(WIDTH) * TICKS / seconds) * 1e-9 << " Guzlu/s" << std::endl;
+    return 0;
+}
+
+/**
+ * REŽIM: Více druhů (--species)
+ * Hmota [X] a antihmota [A] se pohybují, značka [#] je statická překážka.
+ */
+int run_species() {
+    const size_t WIDTH = 20;
+    SpeciesUniverse<2> strip(WIDTH, 1);
+    strip.set_species(0, MATTER);
+    strip.set_species(1, ANTIMATTER);
+    strip.set_species(5, MATTER);
+    strip.set_species(12, MARKER);
+
+    std::cout << "--- VICEDRUHOVY VESMIR ---" << std::endl;
+    std::cout << "Legenda: [X] = Hmota, [A] = Antihmota, [#] = Znacka, [ ] = Volny prostor" << std::endl;
+    for (int t = 0; t < 15; ++t) {
+        std::cout << "Takt " << t << ": ";
+        for (size_t i = 0; i < WIDTH; ++i) {
+            switch (strip.get_species(i)) {
+                case MATTER:     std::cout << "[X]"; break;
+                case ANTIMATTER: std::cout << "[A]"; break;
+                case MARKER:     std::cout << "[#]"; break;
+                default:         std::cout << "[ ]"; break;
+            }
+        }
+        std::cout << std::endl;
+        strip.tick_parallel();
+    }
+
+    // Ověření paralelního taktu proti sekvenčnímu průchodu na náhodné 2D mřížce
+    SpeciesUniverse<2> world(1000, 300), reference(1000, 300);
+    std::mt19937_64 rng(7);
+    for (size_t i = 0; i < world.cells; ++i) {
+        unsigned s = static_cast<unsigned>(rng() % 4);
+        world.set_species(i, s);
+        reference.set_species(i, s);
+    }
+    for (int t = 0; t < 10; ++t) {
+        world.tick_parallel();
+        reference.tick_serial();
+    }
+    if (world.words() != reference.words()) {
+        std::cerr << "Paralelni takt se lisi od sekvencniho pruchodu!" << std::endl;
+        return 1;
+    }
+    std::cout << "Paralelni takt = sekvencni pruchod: OK" << std::endl;
+    return 0;
+}
+
+/**
+ * REŽIM: Detekce cyklů (--cycles)
+ * Vesmír dříve či později skončí na periodické orbitě (zde pevný bod – vše se
+ * nahromadí u pravého okraje). Další takty by byly jen zbytečný výpočet.
+ * Zkrácený běh se ověří proti plnému běhu o několik taktů delšímu, než je nalezení orbity.
+ */
+int run_cycles() {
+    const size_t WIDTH = quick_run ? 10000 : 100000;
+    const uint64_t TICKS = 1000000000ULL;
+
+    PackedUniverse strip(WIDTH, 1);
+    std::mt19937_64 rng(1);
+    std::bernoulli_distribution occupied(0.1);
+    for (size_t i = 0; i < strip.cells; ++i) strip.set_state(i, occupied(rng));
+    const PackedUniverse initial = strip;
+
+    CycleDetector detector;
+    auto start = std::chrono::steady_clock::now();
+    RunSummary summary = run_with_cycle_detection(strip, TICKS, detector);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "--- DETEKCE CYKLU: " << WIDTH << " uzlu, pozadovano " << summary.ticks_requested << " taktu ---" << std::endl;
+    if (summary.cycle_found) {
+        std::cout << "Orbita od taktu " << summary.cycle.start << ", perioda " << summary.cycle.period << std::endl;
+    } else {
+        std::cout << "Zadna orbita nenalezena" << std::endl;
+    }
+    std::cout << "Spocteno taktu: " << summary.ticks_executed << " (" << seconds << " s)" << std::endl;
+
+    // Přeskočení zbytku musí dát stejný stav jako plný běh (délka mimo násobek periody)
+    const uint64_t check_ticks = 2 * summary.ticks_executed + 7;
+    PackedUniverse skipped = initial, full = initial;
+    CycleDetector check_detector;
+    run_with_cycle_detection(skipped, check_ticks, check_detector);
+    for (uint64_t t = 0; t < check_ticks; ++t) full.tick_parallel();
+    const bool ok = summary.cycle_found && skipped.words() == full.words();
+    std::cout << "Zkraceny beh = plny beh (" << check_ticks << " taktu): " << (ok ? "OK" : "CHYBA") << std::endl;
+    return ok ? 0 : 1;
+}
+
+/**
+ * REŽIM: Aktivita (--activity [soubor.csv])
+ * Čítače přepisů po taktech a akumulovaná tepelná mapa po dlaždicích.
+ */
+int run_activity(const char* csv_path) {
+    const size_t WIDTH = 4096;
+    const size_t HEIGHT = 256;
+    const int TICKS = 200;
+
+    PackedUniverse world(WIDTH, HEIGHT);
+    std::mt19937_64 rng(3);
+    for (size_t y = 0; y < HEIGHT; ++y) {
+        // Hustota roste s řádkem -> husté řádky se u pravého okraje zasekávají rychleji
+        std::bernoulli_distribution occupied(0.05 + 0.9 * double(y) / double(HEIGHT));
+        for (size_t x = 0; x < WIDTH; ++x) world.set_state(y * WIDTH + x, occupied(rng));
+    }
+
+    ActivityMap heat(world.words().size(), 16); // Dlaždice 16 slov = 1024 uzlů
+    world.attach_activity_map(&heat);
+
+    std::cout << "--- AKTIVITA: " << WIDTH << "x" << HEIGHT << ", " << TICKS << " taktu ---" << std::endl;
+    for (int t = 0; t < TICKS; ++t) {
+        world.tick_parallel();
+        if (t % 40 == 0) {
+            const TickCounters& c = world.last_tick();
+            std::cout << "Takt " << t << ": prepisu = " << c.rewrites << ", aktivnich slov = " << c.active_words
+                      << ", aktivnich dlazdic = " << c.active_tiles << "/" << heat.tile_count() << std::endl;
+        }
+    }
+    world.attach_activity_map(nullptr);
+
+    heat.write_csv(csv_path);
+    std::cout << "Tepelna mapa zapsana do " << csv_path << std::endl;
+    return 0;
+}
+
+/**
+ * REŽIM: Pozorovatelé (--observe)
+ * Invariant zachování informace v taktu a sonda v kroku RK4, obojí bez úprav smyček.
+ */
+int run_observe() {
+    PackedUniverse world(1 << 16, 64);
+    std::mt19937_64 rng(11);
+    std::bernoulli_distribution occupied(0.4);
+    for (size_t i = 0; i < world.cells; ++i) world.set_state(i, occupied(rng));
+
+    ConservationObserver conservation;
+    for (int t = 0; t < 100; ++t) world.tick_parallel(conservation);
+
+    std::vector<Node> strip(20, Node{0, 1.0f});
+    strip[0].state = 1;
+    strip[3].state = 1;
+    RewriteLogObserver log;
+    tick(strip, 20, 1, log);
+
+    DIFPGrid<double> grid(256, 256);
+    for (size_t i = 0; i < grid.active_size; ++i) grid.potential[i] = std::sin(0.01 * double(i));
+    RK4Solver solver;
+    ProbeObserver probe(grid.active_size / 2);
+    for (int s = 0; s < 100; ++s) solver.step(grid, 0.01, probe);
+
+    std::cout << "--- POZOROVATELE ---" << std::endl;
+    std::cout << "Zachovani informace: " << conservation.ticks << " taktu, poruseni: "
+              << conservation.violations << std::endl;
+    std::cout << "Prepisy v prvnim taktu pruhu:";
+    for (const auto& r : log.rewrites) std::cout << " " << r.first << "->" << r.second;
+    std::cout << std::endl;
+    std::cout << "Sonda RK4 (bunka " << probe.cell << "): potencial " << probe.potential.front()
+              << " -> " << probe.potential.back() << " po " << probe.potential.size() << " krocich" << std::endl;
+    return conservation.violations ? 1 : 0;
+}
+
+/**
+ * REŽIM: Záznam událostí (--events [soubor])
+ * Každý přepis (takt, odkud, kam) jde do sloupcového souboru na pozadí.
+ */
+int run_events(const char* path) {
+    const size_t WIDTH = quick_run ? size_t(1) << 20 : size_t(1) << 24;
+    const int TICKS = 20;
+
+    PackedUniverse strip(WIDTH, 1);
+    std::mt19937_64 rng(5);
+    std::bernoulli_distribution occupied(0.5);
+    for (size_t i = 0; i < strip.cells; ++i) strip.set_state(i, occupied(rng));
+
+    EventRecorder recorder(path);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < TICKS; ++t) strip.tick_parallel(recorder);
+    double tick_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    recorder.flush();
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double events = double(recorder.events_recorded());
+    std::cout << "--- ZAZNAM UDALOSTI: " << WIDTH << " uzlu, " << TICKS << " taktu ---" << std::endl;
+    std::cout << "Udalosti: " << recorder.events_recorded() << ", bajtu: " << recorder.bytes_written()
+              << " (" << double(recorder.bytes_written()) / events << " B/udalost)" << std::endl;
+    std::cout << "Takty: " << events / tick_seconds * 1e-6 << " M udalosti/s, vcetne zapisu: "
+              << events / total_seconds * 1e-6 << " M udalosti/s" << std::endl;
+    std::cout << "Fond davek: " << double(recorder.pool_bytes()) / (1024.0 * 1024.0) << " MiB" << std::endl;
+
+    // Zpětné čtení po dávkách (záznam se do paměti nevejde celý)
+    uint64_t read_back = 0;
+    bool ok = read_events(path, [&read_back](const RewriteEvent*, size_t count) { read_back += count; });
+    if (!ok || read_back != recorder.events_recorded()) {
+        std::cerr << "Soubor udalosti nelze zpetne precist!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
 /**
- * FUNKCE: rewrite (Informační přepis)
- * Toto je srdce tvého vesmíru. Implementuje princip výměny 1:1.
- * Informace se nepohybuje "skrze" prostor, ale body si vymění stavy.
+ * REŽIM: Parareal (--parareal)
+ * Paralelní integrace v čase proti sériovému jemnému RK4 na stejné mřížce.
  */
-void rewrite(Node& current, Node& neighbor) {
-    // Pokud je cílový uzel volný (stav 0), proběhne výměna.
-    // Hmota (1) se přesune vpřed, prázdnota (0) se vrátí dozadu.
-    if (current.state == 1 && neighbor.state == 0) {
-        neighbor.state = 1;
-        current.state = 0;
-        // Poznámka: Zde se zachovává zákon zachování informace. 
-        // Počet jedniček v systému zůstává konstantní.
+int run_parareal() {
+    const double T = 4.0;
+    PararealConfig config;
+    config.slices = 8;
+    config.fine_steps_per_slice = 200;
+    config.coarse_steps_per_slice = 2;
+    config.tolerance = 1e-9;
+
+    DIFPGrid<double> initial(256, 256);
+    for (size_t i = 0; i < initial.active_size; ++i) {
+        initial.potential[i] = std::sin(0.01 * double(i));
+        initial.vx[i] = 0.1 * std::cos(0.02 * double(i));
+    }
+
+    DIFPGrid<double> serial = initial;
+    RK4Solver solver;
+    const size_t total_steps = config.slices * config.fine_steps_per_slice;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < total_steps; ++s) solver.step(serial, T / double(total_steps));
+    double serial_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    DIFPGrid<double> parallel = initial;
+    PararealDriver driver(config);
+    start = std::chrono::steady_clock::now();
+    PararealReport report = driver.run(parallel, T);
+    double parareal_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double error = 0.0;
+    for (size_t i = 0; i < initial.active_size; ++i) {
+        error = std::max(error, std::fabs(parallel.potential[i] - serial.potential[i]));
     }
+
+    std::cout << "--- PARAREAL: " << config.slices << " oken, " << total_steps << " jemnych kroku ---" << std::endl;
+    std::cout << "Iteraci: " << report.iterations << (report.converged ? " (konvergovalo)" : " (nekonvergovalo)") << std::endl;
+    for (size_t k = 0; k < report.residuals.size(); ++k) {
+        std::cout << "  iterace " << k + 1 << ": oprava = " << report.residuals[k] << std::endl;
+    }
+    std::cout << "Odchylka od serioveho behu: " << error << std::endl;
+    std::cout << "Cas: seriove " << serial_seconds << " s, parareal " << parareal_seconds << " s" << std::endl;
+    return 0;
 }
 
 /**
- * FUNKCE: tick (Planckův čas / Takt)
- * Představuje jeden nejmenší časový úsek vesmíru.
- * Během jednoho taktu proběhne v mřížce jedna vlna přepisů.
+ * REŽIM: Exponenciální integrátor (--etdrk4)
+ * Tuhá mřížka (dva materiály, jeden se silným tlumením): ETDRK4 s velkým krokem
+ * proti RK4 se stejným krokem a proti jemnému RK4 jako referenci.
  */
-void tick(std::vector<Node>& grid, int width, int height) {
-    // Procházíme mřížku odzadu (zprava doleva), aby se nám 
-    // informace v jednom taktu neposunula o víc než jeden uzel.
-    // To simuluje rychlostní limit 'c'.
-    for (int y = 0; y < height; ++y) {
-        for (int x = width - 2; x >= 0; --x) {
-            int idx = y * width + x;
-            int nextIdx = y * width + (x + 1);
-            
-            // Aplikujeme pravidlo přepisu pro každý bod a jeho pravého souseda
-            rewrite(grid[idx], grid[nextIdx]);
+int run_etdrk4() {
+    const double T = 1.0;
+    const size_t W = 128, H = 128;
+
+    DIFPGrid<double> initial(W, H);
+    for (size_t i = 0; i < initial.active_size; ++i) {
+        initial.potential[i] = std::sin(0.01 * double(i));
+        initial.vx[i] = 0.1 * std::cos(0.02 * double(i));
+        initial.vy[i] = 0.05 * std::sin(0.03 * double(i));
+        initial.friction[i] = ((i / W) < H / 2) ? 0.1 : 1000.0; // vlastní číslo ~ -1000
+    }
+
+    auto max_error = [&](const DIFPGrid<double>& x, const DIFPGrid<double>& ref) {
+        double e = 0.0;
+        for (size_t i = 0; i < ref.active_size; ++i) {
+            e = std::max(e, std::fabs(x.potential[i] - ref.potential[i]));
+            e = std::max(e, std::fabs(x.vx[i] - ref.vx[i]));
         }
+        return e;
+    };
+
+    // Reference: RK4 hluboko pod mezí stability (dt * 1000 = 0.25)
+    const size_t ref_steps = 4000;
+    DIFPGrid<double> reference = initial;
+    RK4Solver rk4;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < ref_steps; ++s) rk4.step(reference, T / double(ref_steps));
+    double ref_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "--- ETDRK4: " << W << "x" << H << ", T = " << T << ", reference " << ref_steps
+              << " kroku RK4 (" << ref_seconds << " s) ---" << std::endl;
+
+    for (size_t steps : {10, 20, 50, 100}) {
+        const double dt = T / double(steps);
+
+        DIFPGrid<double> exp_grid = initial;
+        ETDRK4Solver etd;
+        start = std::chrono::steady_clock::now();
+        for (size_t s = 0; s < steps; ++s) etd.step(exp_grid, dt);
+        double etd_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        DIFPGrid<double> rk_grid = initial;
+        for (size_t s = 0; s < steps; ++s) rk4.step(rk_grid, dt);
+
+        std::cout << "dt = " << dt << ": ETDRK4 chyba " << max_error(exp_grid, reference)
+                  << " (" << etd.unique_operators() << " operatory, " << etd_seconds << " s)"
+                  << ", RK4 chyba " << max_error(rk_grid, reference) << std::endl;
     }
+    return 0;
 }
 
-int main() {
+/**
+ * REŽIM: Operator splitting (--splitting)
+ * Strang (tření + vlna) sloučený do jednoho průchodu proti samostatným průchodům a RK4.
+ */
+int run_splitting() {
+    const size_t W = quick_run ? 256 : 1024, H = W;
+    const double dt = 0.01;
+    const size_t steps = 20;
+
+    DIFPGrid<double> initial(W, H);
+    for (size_t i = 0; i < initial.active_size; ++i) {
+        initial.potential[i] = std::sin(0.01 * double(i));
+        initial.vx[i] = 0.1 * std::cos(0.02 * double(i));
+        initial.friction[i] = ((i / W) < H / 2) ? 0.1 : 2.0;
+    }
+
+    using WaveSplit = SplittingStepper<DampingOperator, WaveOperator>;
+    WaveSplit fused(SplittingScheme::Strang, DampingOperator{}, WaveOperator{});
+    WaveSplit separate(SplittingScheme::Strang, DampingOperator{}, WaveOperator{}, 4096, false);
+
+    auto timed = [&](DIFPGrid<double>& grid, auto&& one_step) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t s = 0; s < steps; ++s) one_step(grid);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    DIFPGrid<double> a = initial, b = initial, c = initial;
+    RK4Solver rk4;
+    double fused_seconds = timed(a, [&](DIFPGrid<double>& g) { fused.step(g, dt); });
+    double separate_seconds = timed(b, [&](DIFPGrid<double>& g) { separate.step(g, dt); });
+    double rk4_seconds = timed(c, [&](DIFPGrid<double>& g) { rk4.step(g, dt); });
+
+    bool identical = std::equal(a.potential, a.potential + a.active_size, b.potential) &&
+                     std::equal(a.vx, a.vx + a.active_size, b.vx);
+    double error = 0.0;
+    for (size_t i = 0; i < initial.active_size; ++i) error = std::max(error, std::fabs(a.potential[i] - c.potential[i]));
+
+    std::cout << "--- SPLITTING (Strang: treni + vlna), " << W << "x" << H << ", " << steps << " kroku ---" << std::endl;
+    std::cout << "Sloucene: " << fused.passes().size() << " pruchody, " << fused_seconds << " s, "
+              << fused.traffic_bytes(initial) / (1 << 20) << " MiB/krok" << std::endl;
+    std::cout << "Samostatne: " << separate.passes().size() << " pruchody, " << separate_seconds << " s, "
+              << separate.traffic_bytes(initial) / (1 << 20) << " MiB/krok" << std::endl;
+    std::cout << "RK4Solver: " << rk4_seconds << " s, odchylka splittingu " << error << std::endl;
+    std::cout << "Sloucene = samostatne: " << (identical ? "OK" : "CHYBA") << std::endl;
+
+    // Globální operátor přeruší slučování: A(dt/2) | D(dt/2) W(dt) D(dt/2) | A(dt/2)
+    SplittingStepper<AdvectionOperator, DampingOperator, WaveOperator> with_advection(
+        SplittingScheme::Strang, AdvectionOperator{}, DampingOperator{}, WaveOperator{});
+    std::cout << "S advekci:";
+    for (const auto& pass : with_advection.passes()) {
+        std::cout << " [" << (pass.fused ? "sloucene " : "globalni ") << pass.stages.size() << "]";
+    }
+    std::cout << std::endl;
+    with_advection.step(a, dt);
+    return identical ? 0 : 1;
+}
+
+/**
+ * REŽIM: Snapshot po blocích (--snapshot [soubor])
+ * Zápis mřížky, čtení výřezu jednoho pole přes mmap a ověření kontrolních součtů.
+ */
+int run_snapshot(const char* path) {
+    const size_t W = 2048, H = 2048;
+    DIFPGrid<double> grid(W, H);
+    for (size_t i = 0; i < grid.active_size; ++i) {
+        grid.potential[i] = std::sin(0.01 * double(i));
+        grid.vx[i] = 0.1 * std::cos(0.02 * double(i));
+        grid.vy[i] = double(i);
+        if (i % 7 == 0) grid.set_state(i, true);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    write_snapshot(path, grid, 42, 0.42);
+    double write_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    SnapshotReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "Snapshot nelze otevrit!" << std::endl;
+        return 1;
+    }
+    const size_t x0 = 1000, y0 = 700, rw = 300, rh = 200;
+    std::vector<double> region(rw * rh);
+    bool ok = reader.read_region(SnapshotField::VY, x0, y0, rw, rh, region.data());
+    double region_ms = 1000.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (size_t y = 0; ok && y < rh; ++y) {
+        for (size_t x = 0; x < rw; ++x) {
+            if (region[y * rw + x] != grid.vy[(y0 + y) * W + x0 + x]) ok = false;
+        }
+    }
+
+    // Ověření zbylých bloků (paralelně), pak obnova celé mřížky
+    start = std::chrono::steady_clock::now();
+    size_t corrupted = reader.verify_all();
+    double verify_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    DIFPGrid<double> loaded(W, H);
+    ok = ok && corrupted == 0 && reader.load(loaded) &&
+         std::equal(grid.potential, grid.potential + grid.active_size, loaded.potential) &&
+         std::equal(grid.vx, grid.vx + grid.active_size, loaded.vx) &&
+         std::equal(grid.state_data(), grid.state_data() + grid.state_word_count(), loaded.state_data());
+
+    // Propustnost CRC32C: hardwarová varianta proti tabulkové
+    const size_t crc_bytes = grid.get_compute_size() * sizeof(double);
+    start = std::chrono::steady_clock::now();
+    uint32_t crc_fast = crc32c::compute(grid.vy, crc_bytes);
+    double fast_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    uint32_t crc_table = crc32c::extend_portable(0, grid.vy, crc_bytes);
+    double table_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ok = ok && crc_fast == crc_table;
+
+    std::cout << "--- SNAPSHOT: " << W << "x" << H << ", dlazdice " << reader.header().tile_width << "x"
+              << reader.header().tile_height << ", " << reader.header().chunk_count << " bloku ---" << std::endl;
+    std::cout << "Zapis: " << write_seconds << " s" << std::endl;
+    std::cout << "Otevreni + vyrez " << rw << "x" << rh << " pole " << snapshot_field_name(SnapshotField::VY)
+              << ": " << region_ms << " ms" << std::endl;
+    std::cout << "Poskozene bloky: " << corrupted << " (overeni " << verify_seconds << " s)" << std::endl;
+    std::cout << "CRC32C: " << crc_bytes / fast_seconds / 1e9 << " GB/s (tabulka " << crc_bytes / table_seconds / 1e9
+              << " GB/s)" << std::endl;
+    std::cout << "Vyrez a plne nacteni = mrizka: " << (ok ? "OK" : "CHYBA") << std::endl;
+    return ok ? 0 : 1;
+}
+
+/**
+ * REŽIM: Rozdělení polí za běhu (--histogram)
+ * DistributionObserver v RK4Solver::step: kvantily potenciálu každých 5 kroků
+ * a cena histogramu proti jedné stage solveru.
+ */
+int run_histogram() {
+    const size_t W = 2048, H = 2048;
+    const size_t steps = 20;
+    const double dt = 0.01;
+
+    DIFPGrid<double> grid(W, H);
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    for (size_t i = 0; i < grid.active_size; ++i) {
+        grid.potential[i] = std::sin(0.001 * double(i)) + 0.1 * noise(rng);
+        grid.vx[i] = 0.1 * std::cos(0.002 * double(i));
+    }
+
+    RK4Solver solver;
+    DistributionObserver observer(5, 4096);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < steps; ++s) solver.step(grid, dt, observer);
+    double run_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Cena samotného histogramu (vč. průchodu min/max)
+    FieldHistogram hist(4096);
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < 10; ++r) hist.build(grid.potential, grid.active_size);
+    double hist_ms = 100.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "--- HISTOGRAM: " << W << "x" << H << ", " << steps << " kroku RK4, kvantily kazdych "
+              << observer.interval << " kroku ---" << std::endl;
+    std::cout << "krok   min        q01        median     q99        max" << std::endl;
+    for (const QuantileRecord& r : observer.potential) {
+        std::cout << r.step << "   " << r.min << "  " << r.q01 << "  " << r.median << "  " << r.q99 << "  " << r.max
+                  << std::endl;
+    }
+    const double stage_ms = 1000.0 * run_seconds / double(steps) / 4.0;
+    std::cout << "Histogram " << hist.bin_count() << " prihradek: " << hist_ms << " ms, stage RK4 ~" << stage_ms
+              << " ms" << std::endl;
+    return 0;
+}
+
+/**
+ * REŽIM: Výkonové spektrum za běhu (--spectrum)
+ * SpectrumObserver předává každý 5. krok kopii polí analyzátoru na pozadí;
+ * srovnání doby kroků s analýzou a bez ní.
+ */
+int run_spectrum() {
+    const size_t W = 1024, H = 1024;
+    const size_t steps = 40;
+    const double dt = 0.01;
+    const double pi = std::acos(-1.0);
+
+    DIFPGrid<double> initial(W, H);
+    std::mt19937_64 rng(11);
+    std::normal_distribution<double> noise(0.0, 0.01);
+    for (size_t y = 0; y < H; ++y) {
+        for (size_t x = 0; x < W; ++x) {
+            const size_t i = y * W + x;
+            initial.potential[i] = std::sin(2.0 * pi * 16.0 * double(x) / double(W)) + noise(rng);
+            initial.mass[i] = 1.0 + 0.5 * std::cos(2.0 * pi * 4.0 * double(y) / double(H));
+        }
+    }
+
+    DIFPGrid<double> plain = initial;
+    RK4Solver solver;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < steps; ++s) solver.step(plain, dt);
+    double plain_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    DIFPGrid<double> grid = initial;
+    SpectrumAnalyzer analyzer(W, H, 1);
+    SpectrumObserver observer(analyzer, 5);
+    start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < steps; ++s) solver.step(grid, dt, observer);
+    double observed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    analyzer.wait();
+
+    std::cout << "--- SPEKTRUM: " << W << "x" << H << ", " << steps << " kroku, snimek kazdych "
+              << observer.interval << " kroku ---" << std::endl;
+    for (const RadialSpectrum& sp : analyzer.take_results()) {
+        size_t peak = 1;
+        for (size_t k = 1; k < sp.power.size(); ++k) {
+            if (sp.power[k] > sp.power[peak]) peak = k;
+        }
+        std::cout << "krok " << sp.step << " " << sp.field << ": maximum P(k) pri k = " << peak
+                  << ", P = " << sp.power[peak] << std::endl;
+    }
+    std::cout << "Kroky bez analyzy " << plain_seconds << " s, s analyzou " << observed_seconds
+              << " s, zahozenych snimku: " << analyzer.dropped() << std::endl;
+    return 0;
+}
+
+/**
+ * REŽIM: Dotazy na oblasti (--regions)
+ * RegionIndex nad hmotností (součty) a potenciálem (min/max), obnovovaný pozorovatelem
+ * po krocích RK4; náhodné obdélníky proti přímému průchodu oblastí.
+ */
+int run_regions() {
+    const size_t W = quick_run ? 512 : 2048, H = W;
+    const size_t steps = 10;
+    const size_t queries = 2000;
+    const double dt = 0.01;
+
+    DIFPGrid<double> grid(W, H);
+    std::mt19937_64 rng(5);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    for (size_t i = 0; i < grid.active_size; ++i) {
+        grid.potential[i] = std::sin(0.001 * double(i)) + 0.1 * noise(rng);
+        grid.mass[i] = 1.0 + 0.25 * std::abs(noise(rng));
+    }
+
+    RK4Solver solver;
+    RegionIndex index(FIELD_MASS | FIELD_POTENTIAL, FIELD_POTENTIAL);
+    RegionIndexObserver observer(index, 5);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < steps; ++s) solver.step(grid, dt, observer);
+    double run_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    index.rebuild(grid);
+    double build_ms = 1000.0 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Náhodné obdélníky: dotaz z indexu a přímý průchod
+    std::uniform_int_distribution<size_t> pick_x(0, W - 1), pick_y(0, H - 1);
+    std::vector<size_t> rects(queries * 4);
+    for (size_t q = 0; q < queries; ++q) {
+        size_t x0 = pick_x(rng), y0 = pick_y(rng);
+        rects[4 * q] = x0;
+        rects[4 * q + 1] = y0;
+        rects[4 * q + 2] = 1 + pick_x(rng) % (W - x0);
+        rects[4 * q + 3] = 1 + pick_y(rng) % (H - y0);
+    }
+
+    double checksum = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+        const size_t* r = &rects[4 * q];
+        checksum += index.sum(FIELD_MASS, r[0], r[1], r[2], r[3]) + index.max(FIELD_POTENTIAL, r[0], r[1], r[2], r[3]) +
+                    index.min(FIELD_POTENTIAL, r[0], r[1], r[2], r[3]);
+    }
+    double query_us = 1e6 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+                      double(queries);
+
+    // Chyba součtu je úměrná kumulované hodnotě, ne výsledku: měřítkem je celková hmotnost
+    const double total_mass = index.sum(FIELD_MASS, 0, 0, W, H);
+    double worst_sum = 0.0;
+    bool extrema_ok = true;
+    start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+        const size_t* r = &rects[4 * q];
+        double sum = 0.0, mn = grid.potential[r[1] * W + r[0]], mx = mn;
+        for (size_t y = r[1]; y < r[1] + r[3]; ++y) {
+            for (size_t x = r[0]; x < r[0] + r[2]; ++x) {
+                sum += grid.mass[y * W + x];
+                mn = std::min(mn, grid.potential[y * W + x]);
+                mx = std::max(mx, grid.potential[y * W + x]);
+            }
+        }
+        worst_sum = std::max(worst_sum, std::abs(sum - index.sum(FIELD_MASS, r[0], r[1], r[2], r[3])) / total_mass);
+        extrema_ok = extrema_ok && mn == index.min(FIELD_POTENTIAL, r[0], r[1], r[2], r[3]) &&
+                     mx == index.max(FIELD_POTENTIAL, r[0], r[1], r[2], r[3]);
+    }
+    double scan_us = 1e6 * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+                     double(queries);
+
+    std::cout << "--- OBLASTI: " << W << "x" << H << ", " << steps << " kroku RK4, obnova indexu kazdych "
+              << observer.interval << " kroku (" << index.build_count() << "x) ---" << std::endl;
+    std::cout << "Obnova indexu: " << build_ms << " ms (krok RK4 ~" << 1000.0 * run_seconds / double(steps)
+              << " ms), pamet " << index.memory_bytes() / (1024 * 1024) << " MiB" << std::endl;
+    std::cout << "Dotaz (soucet + min + max): " << query_us << " us, primy pruchod: " << scan_us << " us"
+              << " (kontrolni soucet " << checksum << ")" << std::endl;
+    std::cout << "Max. chyba souctu / celkova hmotnost: " << worst_sum << ", min/max presne: " << (extrema_ok ? "OK" : "CHYBA")
+              << std::endl;
+    return extrema_ok && worst_sum < 1e-12 ? 0 : 1;
+}
+
+/**
+ * REŽIM: Kontrola alokací (--alloc-check)
+ * Ustálený stav RK4Solver::step, tick() a PackedUniverse::tick_parallel() nesmí alokovat.
+ * Počty alokací vyžadují build s -DDIFP_ALLOC_TRACKING=ON (ctest: difp_alloc_check); bez něj
+ * se ověří jen zámek bufferů solveru. Návratový kód 1 = porušení, 77 = alokace nešlo změřit.
+ */
+int run_alloc_check() {
+    const size_t W = 256, H = 256;
+    const size_t steps = 20;
+    const double dt = 0.01;
+
+    AllocationProfile profile;
+
+    // RK4: první krok bez prepare() alokuje pět pomocných mřížek, další kroky nic
+    DIFPGrid<double> grid(W, H);
+    for (size_t i = 0; i < grid.active_size; ++i) grid.potential[i] = std::sin(0.01 * double(i));
+    RK4Solver lazy;
+    profile.measure("rk4.first_step", [&] { lazy.step(grid, dt); });
+
+    RK4Solver solver;
+    solver.prepare(grid);
+    solver.step(grid, dt); // Zahřátí (vlákna OpenMP, ...)
+    for (size_t s = 0; s < steps; ++s) profile.measure("rk4.step", [&] { solver.step(grid, dt); });
+
+    // Zamčené buffery: mřížka jiné velikosti je chyba, ne realokace
+    bool lock_ok = false;
+    DIFPGrid<double> other(W / 2, H);
+    try {
+        solver.step(other, dt);
+    } catch (const std::logic_error&) {
+        lock_ok = true;
+    }
+
+    // Informační vesmír: skalární a bitově pakovaný takt
+    std::vector<Node> nodes(W * 64, Node{0, 1.0f});
+    for (size_t i = 0; i < nodes.size(); i += 3) nodes[i].state = 1;
+    tick(nodes, static_cast<int>(W), 64);
+    for (size_t s = 0; s < steps; ++s) profile.measure("tick", [&] { tick(nodes, static_cast<int>(W), 64); });
+
+    PackedUniverse packed(W, 64);
+    packed.load(nodes);
+    packed.tick_parallel();
+    for (size_t s = 0; s < steps; ++s) profile.measure("tick_parallel", [&] { packed.tick_parallel(); });
+
+    std::cout << "--- ALOKACE: " << (alloc_tracking::available() ? "pocitani zapnuto" : "pocitani neni zkompilovano"
+              " (cmake -DDIFP_ALLOC_TRACKING=ON)") << " ---" << std::endl;
+    for (const AllocationProfile::Phase& p : profile.entries()) {
+        std::cout << p.name << ": " << p.runs << "x, alokaci " << p.counters.allocations << ", bajtu "
+                  << p.counters.bytes << std::endl;
+    }
+    std::cout << "Zamek bufferu RK4Solver: " << (lock_ok ? "OK" : "CHYBA") << std::endl;
+
+    // Nulové čítače bez instrumentace nic nedokazují: přeskočeno, ne "OK"
+    if (!alloc_tracking::available()) {
+        std::cout << "Ustaleny stav bez alokaci: NEOVERENO" << std::endl;
+        return lock_ok ? 77 : 1;
+    }
+
+    bool ok = lock_ok;
+    for (const char* phase : {"rk4.step", "tick", "tick_parallel"}) {
+        try {
+            require_no_allocations(profile.find(phase)->counters, phase);
+        } catch (const std::logic_error& e) {
+            std::cout << e.what() << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << "Ustaleny stav bez alokaci: " << (ok ? "OK" : "CHYBA") << std::endl;
+    return ok ? 0 : 1;
+}
+
+/**
+ * REŽIM: Účetnictví paměti (--memory [W H])
+ * Odhad z konfigurace (bez alokace), pak skutečná paměť složek a přírůstek RSS procesu.
+ */
+int run_memory(size_t W, size_t H) {
+    MemoryPlan plan;
+    plan.width = W;
+    plan.height = H;
+    plan.etdrk4_solvers = 1;
+    plan.region_sum_fields = FIELD_MASS | FIELD_POTENTIAL;
+    plan.region_extrema_fields = FIELD_POTENTIAL;
+    plan.universe_width = W;
+    plan.universe_height = H;
+    const MemoryReport estimate = estimate_memory(plan);
+
+    const ProcessMemory before = process_memory();
+    DIFPGrid<double> grid(W, H);
+    RK4Solver rk4;
+    rk4.prepare(grid);
+    ETDRK4Solver etd;
+    etd.prepare(grid, 0.01);
+    etd.step(grid, 0.01);
+    RegionIndex index(plan.region_sum_fields, plan.region_extrema_fields);
+    index.rebuild(grid);
+    PackedUniverse universe(W, H);
+    universe.tick_parallel();
+
+    // Prvním zápisem se stránky teprve namapují: RSS odpovídá až po doteku všech polí
+    rk4.step(grid, 0.01);
+    const ProcessMemory after = process_memory();
+
+    MemoryReport actual;
+    actual.add_grid("grid[0]", grid);
+    actual.add("rk4[0]", MemoryCategory::Scratch, rk4.memory_bytes());
+    actual.add("etdrk4[0]", MemoryCategory::Scratch, etd.memory_bytes());
+    actual.add("region_index", MemoryCategory::Index, index.memory_bytes());
+    actual.add("packed_universe", MemoryCategory::Bitset, universe.memory_bytes());
+
+    const double mib = 1024.0 * 1024.0;
+    std::cout << "--- PAMET: " << W << "x" << H << " (mrizka, RK4, ETDRK4, RegionIndex, PackedUniverse) ---"
+              << std::endl;
+    std::cout << "Odhad z konfigurace:" << std::endl;
+    estimate.print(std::cout);
+    std::cout << "Skutecnost:" << std::endl;
+    actual.print(std::cout);
+    std::cout << "RSS +" << double(after.rss - before.rss) / mib << " MiB, spicka RSS " << double(after.peak_rss) / mib
+              << " MiB" << std::endl;
+    std::cout << "Stranka " << after.page_size << " B, huge page " << after.huge_page_size / 1024
+              << " KiB, v transparentnich huge pages " << double(after.anon_huge_bytes) / mib << " MiB" << std::endl;
+
+    const double diff = std::abs(double(actual.total()) - double(estimate.total())) / double(estimate.total());
+    std::cout << "Odhad vs skutecnost: " << diff * 100.0 << " %" << std::endl;
+    return diff < 0.01 ? 0 : 1;
+}
+
+/**
+ * REŽIM: Práce vs. přesnost (--work-precision [csv])
+ * Úloha s přesným řešením, integrátory přes řadu dt; CSV s křivkami a nejlevnější
+ * integrátor pro zadané cíle přesnosti. Sloučené ExplicitRKSolver proti RK4Solver.
+ */
+int run_work_precision(const char* path) {
+    const size_t W = quick_run ? 64 : 256, H = W;
+    const double T = 2.0;
+    const ManufacturedProblem problem(W, H);
+
+    auto splitting = [](SplittingScheme scheme) {
+        return [scheme](DIFPGrid<double>& grid, double dt, size_t steps) {
+            SplittingStepper<DampingOperator, WaveOperator> stepper(scheme, DampingOperator{}, WaveOperator{});
+            for (size_t s = 0; s < steps; ++s) stepper.step(grid, dt);
+        };
+    };
+    auto explicit_rk = [](auto tableau) {
+        return [](DIFPGrid<double>& grid, double dt, size_t steps) {
+            ExplicitRKSolver<decltype(tableau)> solver;
+            solver.prepare(grid);
+            for (size_t s = 0; s < steps; ++s) solver.step(grid, dt);
+        };
+    };
+    const std::vector<IntegratorCase> cases = {
+        {"rk4", [](DIFPGrid<double>& grid, double dt, size_t steps) {
+             RK4Solver solver;
+             solver.prepare(grid);
+             for (size_t s = 0; s < steps; ++s) solver.step(grid, dt);
+         }},
+        {"rk4-fused", explicit_rk(ClassicRK4{})},
+        {"rk38", explicit_rk(RK38{})},
+        {"ssprk3", explicit_rk(SSPRK3{})},
+        {"heun", explicit_rk(Heun2{})},
+        {"etdrk4", [](DIFPGrid<double>& grid, double dt, size_t steps) {
+             ETDRK4Solver solver;
+             solver.prepare(grid, dt);
+             for (size_t s = 0; s < steps; ++s) solver.step(grid, dt);
+         }},
+        {"strang", splitting(SplittingScheme::Strang)},
+        {"lie", splitting(SplittingScheme::Lie)},
+    };
+    const std::vector<double> dts = {0.4, 0.2, 0.1, 0.05, 0.025, 0.0125, 0.00625};
+
+    const std::vector<WorkPrecisionPoint> points = run_work_precision(problem, cases, dts, T);
+    write_work_precision_csv(path, points);
+
+    std::cout << "--- PRACE VS PRESNOST: " << W << "x" << H << ", T = " << T << " -> " << path << " ---" << std::endl;
+    for (size_t k = 0; k < points.size(); ++k) {
+        const WorkPrecisionPoint& p = points[k];
+        std::cout << "  " << p.integrator << " dt = " << p.dt << ": chyba " << p.error_l2 << ", " << p.seconds << " s";
+        // Empirický řád z poměru chyb při polovičním dt
+        if (k > 0 && points[k - 1].integrator == p.integrator && p.error_l2 > 1e-13) {
+            std::cout << ", rad " << std::log2(points[k - 1].error_l2 / p.error_l2);
+        }
+        std::cout << std::endl;
+    }
+    // Sloučené stage počítají stejnou metodu jako RK4Solver, liší se jen zaokrouhlením
+    double fused_diff = 0.0;
+    for (size_t k = 0; k < points.size(); ++k) {
+        if (points[k].integrator != "rk4") continue;
+        for (const WorkPrecisionPoint& q : points) {
+            if (q.integrator == "rk4-fused" && q.steps == points[k].steps) {
+                fused_diff = std::max(fused_diff, std::fabs(q.error_l2 - points[k].error_l2));
+            }
+        }
+    }
+    std::cout << "ExplicitRKSolver<ClassicRK4> vs RK4Solver: rozdil chyb " << fused_diff << ", pruchody "
+              << ExplicitRKSolver<ClassicRK4>::passes() << " misto 8" << std::endl;
+    for (double target : {1e-3, 1e-6, 1e-9}) {
+        const WorkPrecisionPoint* best = cheapest_for(points, target);
+        std::cout << "Cil " << target << ": ";
+        if (best) {
+            std::cout << best->integrator << " dt = " << best->dt << " (" << best->seconds << " s)" << std::endl;
+        } else {
+            std::cout << "nedosazeno" << std::endl;
+        }
+    }
+    return fused_diff < 1e-12 ? 0 : 1;
+}
+
+/**
+ * REŽIM: Rozložení polí (--layout [N ...])
+ * Packed proti Staggered na mřížkách N x N (výchozí 2048 a 4096): explicitní Euler
+ * na jedné mřížce (8 proudů) a RK4Solver::step (6 mřížek, až 15 proudů). Velikost,
+ * která se nevejde do dostupné paměti, se přeskočí.
+ */
+int run_layout(const std::vector<size_t>& sizes) {
+    const double dt = 0.001;
+    const size_t steps = 3, repeats = 3;
+
+    auto euler = [dt](DIFPGrid<double>& g) {
+        const size_t N = g.get_compute_size();
+        double* __restrict pot = g.potential;
+        double* __restrict vx = g.vx;
+        double* __restrict vy = g.vy;
+        const double* __restrict mass = g.mass;
+        const double* __restrict fric = g.friction;
+        #pragma omp simd aligned(pot, vx, vy, mass, fric : 64)
+        for (size_t i = 0; i < N; ++i) {
+            double d_pot, d_vx, d_vy;
+            damped_wave_rhs(pot[i], vx[i], vy[i], mass[i], fric[i], d_pot, d_vx, d_vy);
+            pot[i] += dt * d_pot;
+            vx[i] += dt * d_vx;
+            vy[i] += dt * d_vy;
+        }
+    };
+
+    // Nejlepší čas na krok z repeats opakování (první krok namapuje stránky)
+    auto best_step = [&](DIFPGrid<double>& grid, auto&& one_step) {
+        one_step(grid);
+        double best = 1e300;
+        for (size_t r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t s = 0; s < steps; ++s) one_step(grid);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best / double(steps);
+    };
+
+    const double mib = 1024.0 * 1024.0;
+    std::cout << "--- ROZLOZENI POLI: Packed vs Staggered (posun " << FIELD_STAGGER_BYTES << " B mezi poli, "
+              << CACHE_LINE_BYTES << " B mezi mrizkami) ---" << std::endl;
+    for (size_t n : sizes) {
+        for (int workload = 0; workload < 2; ++workload) {
+            const char* name = workload == 0 ? "euler (1 mrizka)" : "rk4 (6 mrizek)";
+            const size_t need = DIFPGrid<double>::footprint_for(n, n).total() +
+                                (workload == 0 ? 0 : RK4Solver::memory_bytes_for(n, n));
+            const size_t available = process_memory().available;
+            if (available && need > available * 9 / 10) {
+                std::cout << n << "x" << n << " " << name << ": preskoceno (potreba " << double(need) / mib
+                          << " MiB, dostupne " << double(available) / mib << " MiB)" << std::endl;
+                continue;
+            }
+
+            double seconds[2];
+            for (FieldLayout mode : {FieldLayout::Packed, FieldLayout::Staggered}) {
+                DIFPGrid<double> grid(n, n, mode);
+                for (size_t i = 0; i < grid.active_size; ++i) grid.potential[i] = std::sin(0.01 * double(i));
+                RK4Solver solver;
+                if (workload == 1) solver.prepare(grid);
+                seconds[mode == FieldLayout::Staggered] =
+                    workload == 0 ? best_step(grid, euler)
+                                  : best_step(grid, [&](DIFPGrid<double>& g) { solver.step(g, dt); });
+            }
+            std::cout << n << "x" << n << " " << name << ": packed " << seconds[0] * 1e3 << " ms/krok, staggered "
+                      << seconds[1] * 1e3 << " ms/krok, zrychleni " << seconds[0] / seconds[1] << "x" << std::endl;
+        }
+    }
+    return 0;
+}
+
+/**
+ * REŽIM: Adjungovaný RK4 (--adjoint [checkpointy] [adresar])
+ * Gradient ztráty podle tření proti konečným diferencím, počet přepočtů proti odhadu
+ * Revolve, checkpointy v paměti i na disku a několik kroků fitování tření.
+ */
+int run_adjoint(size_t checkpoints, const char* directory) {
+    const size_t W = quick_run ? 64 : 128, H = W, steps = quick_run ? 400 : 1000;
+    const double dt = 0.002;
+
+    // Skutečné tření (dva materiály) a pozorování potenciálu v polovině a na konci
+    DIFPGrid<double> truth(W, H);
+    for (size_t i = 0; i < truth.active_size; ++i) {
+        truth.potential[i] = std::sin(0.01 * double(i));
+        truth.vx[i] = 0.1 * std::cos(0.02 * double(i));
+        truth.friction[i] = ((i / W) < H / 2) ? 0.2 : 0.8;
+    }
+    std::vector<AdjointObservation> observations;
+    {
+        DIFPGrid<double> run = truth;
+        RK4Solver rk4;
+        for (size_t s = 1; s <= steps; ++s) {
+            rk4.step(run, dt);
+            if (s == steps / 2 || s == steps) {
+                observations.push_back(
+                    {s, FIELD_POTENTIAL, std::vector<double>(run.potential, run.potential + run.active_size)});
+            }
+        }
+    }
+
+    // Odhad: tření 0.5 všude
+    DIFPGrid<double> guess = truth;
+    std::fill(guess.friction, guess.friction + guess.get_compute_size(), 0.5);
+
+    AdjointRK4 adjoint(checkpoints);
+    auto start = std::chrono::steady_clock::now();
+    AdjointResult r = adjoint.gradient(guess, dt, steps, observations);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double mib = 1024.0 * 1024.0;
+    std::cout << "--- ADJUNGOVANY RK4: " << W << "x" << H << ", " << steps << " kroku, " << checkpoints
+              << " checkpointu ---" << std::endl;
+    std::cout << "Ztrata " << r.loss << ", dopredne kroky " << r.forward_steps << " (Revolve "
+              << AdjointRK4::forward_steps_for(steps, checkpoints) << "), zpetne " << r.adjoint_steps << ", "
+              << seconds << " s" << std::endl;
+    std::cout << "Pamet " << double(AdjointRK4::memory_bytes_for(W, H, checkpoints)) / mib
+              << " MiB, ulozeni vsech stavu " << double(steps * 3 * guess.get_compute_size() * sizeof(double)) / mib
+              << " MiB" << std::endl;
+
+    // Směrová derivace podél náhodného směru: (L(f + e d) - L(f - e d)) / 2e = <grad, d>
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::vector<double> direction(guess.active_size);
+    for (double& d : direction) d = unit(rng);
+    auto loss_at = [&](double eps) {
+        DIFPGrid<double> g = guess;
+        for (size_t i = 0; i < g.active_size; ++i) g.friction[i] += eps * direction[i];
+        RK4Solver rk4;
+        double loss = 0.0;
+        for (size_t s = 1; s <= steps; ++s) {
+            rk4.step(g, dt);
+            for (const AdjointObservation& o : observations) {
+                if (o.step != s) continue;
+                for (size_t i = 0; i < g.active_size; ++i) {
+                    const double residual = g.potential[i] - o.values[i];
+                    loss += 0.5 * residual * residual;
+                }
+            }
+        }
+        return loss;
+    };
+    const double eps = 1e-5;
+    const double fd = (loss_at(eps) - loss_at(-eps)) / (2.0 * eps);
+    double dot = 0.0;
+    for (size_t i = 0; i < guess.active_size; ++i) dot += r.grad_friction[i] * direction[i];
+    const double rel = std::fabs(fd - dot) / std::fabs(fd);
+    std::cout << "Smerova derivace: adjungovana " << dot << ", diference " << fd << ", relativni chyba " << rel << std::endl;
+
+    // Checkpointy na disku dávají stejný gradient
+    AdjointRK4 on_disk(checkpoints, CheckpointStorage::Disk, directory);
+    start = std::chrono::steady_clock::now();
+    AdjointResult d = on_disk.gradient(guess, dt, steps, observations);
+    const double disk_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const bool same = d.grad_friction == r.grad_friction && d.grad_mass == r.grad_mass;
+    std::cout << "Disk (" << directory << "): " << d.checkpoint_writes << " zapisu, " << disk_seconds << " s, gradient "
+              << (same ? "shodny" : "ODLISNY") << std::endl;
+
+    // Několik kroků sestupu s polovením kroku
+    double step_size = 1.0;
+    for (int it = 0; it < 5; ++it) {
+        DIFPGrid<double> trial = guess;
+        AdjointResult next;
+        for (;;) {
+            for (size_t i = 0; i < trial.active_size; ++i) {
+                trial.friction[i] = guess.friction[i] - step_size * r.grad_friction[i];
+            }
+            next = adjoint.gradient(trial, dt, steps, observations);
+            if (next.loss < r.loss || step_size < 1e-6) break;
+            step_size *= 0.5;
+        }
+        guess = trial;
+        r = next;
+        double err = 0.0;
+        for (size_t i = 0; i < guess.active_size; ++i) {
+            err = std::max(err, std::fabs(guess.friction[i] - truth.friction[i]));
+        }
+        std::cout << "  iterace " << it + 1 << ": ztrata " << r.loss << ", max chyba treni " << err << std::endl;
+        step_size *= 2.0;
+    }
+    return (rel < 1e-5 && same) ? 0 : 1;
+}
+
+/**
+ * REŽIM: Parametrický sweep (--sweep [behy] [csv])
+ * Běhy nad jedním copy-on-write obrazem počátečního stavu ve vláknech i v procesech,
+ * proti načtení snapshotu do nové mřížky pro každý běh.
+ */
+int run_sweep(size_t runs, const char* csv_path) {
+    const size_t W = 512, H = 512, steps = 50;
+    const double dt = 0.01;
+    const char* image_path = "sweep_initial.difpimg";
+    const char* snapshot_path = "sweep_initial.difp";
+
+    DIFPGrid<double> initial(W, H);
+    for (size_t i = 0; i < initial.active_size; ++i) {
+        initial.potential[i] = std::sin(0.001 * double(i));
+        initial.vx[i] = 0.1 * std::cos(0.003 * double(i));
+        initial.friction[i] = ((i / W) < H / 2) ? 0.2 : 0.8;
+        initial.set_state(i, (i % W) < 16);
+    }
+    write_field_image(image_path, initial);
+    write_snapshot(snapshot_path, initial);
+
+    // Tření a amplituda škálované parametry, RK4 a dvě metriky na konci běhu; mass a
+    // pressure běh jen čte, ty zůstávají sdílené
+    auto body = [&](const std::vector<double>& p, DIFPGrid<double>& grid, double* metrics) {
+        const size_t N = grid.get_compute_size();
+        for (size_t i = 0; i < N; ++i) {
+            grid.friction[i] *= p[0];
+            grid.potential[i] *= p[1];
+        }
+        ExplicitRKSolver<ClassicRK4> rk4;
+        for (size_t s = 0; s < steps; ++s) rk4.step(grid, dt);
+        double energy = 0.0, peak = 0.0;
+        for (size_t i = 0; i < grid.active_size; ++i) {
+            energy += 0.5 * (grid.potential[i] * grid.potential[i] +
+                             grid.mass[i] * (grid.vx[i] * grid.vx[i] + grid.vy[i] * grid.vy[i]));
+            peak = std::max(peak, std::fabs(grid.potential[i]));
+        }
+        metrics[0] = energy;
+        metrics[1] = peak;
+    };
+
+    std::vector<double> friction_scale;
+    for (size_t k = 0; k < std::max<size_t>(runs / 2, 1); ++k) friction_scale.push_back(0.25 + 0.25 * double(k));
+    SweepConfig config;
+    config.initial_path = image_path;
+    config.parameter_names = {"friction_scale", "amplitude"};
+    config.points = sweep_grid({friction_scale, {0.5, 1.0}});
+    config.metric_names = {"energy", "max_potential"};
+    config.written_fields = FIELD_POTENTIAL | FIELD_VX | FIELD_VY | FIELD_FRICTION;
+
+    std::cout << "--- PARAMETRICKY SWEEP: " << W << "x" << H << ", " << config.points.size() << " behu po " << steps
+              << " krocich RK4 ---" << std::endl;
+
+    config.mode = SweepMode::Threads;
+    const SweepResult threads = run_parameter_sweep(config, body);
+    config.mode = SweepMode::Processes;
+    const SweepResult processes = run_parameter_sweep(config, body);
+
+    // Totéž bez sdíleného obrazu: každý běh si načte snapshot do vlastní mřížky
+    double load_seconds = 0.0, load_setup = 0.0;
+    {
+        double metrics[SWEEP_MAX_METRICS];
+        auto t0 = std::chrono::steady_clock::now();
+        for (const std::vector<double>& p : config.points) {
+            auto r0 = std::chrono::steady_clock::now();
+            SnapshotReader reader;
+            DIFPGrid<double> grid(W, H);
+            if (!reader.open(snapshot_path, MappedFile::Access::Sequential) || !reader.load(grid)) return 1;
+            load_setup += std::chrono::duration<double>(std::chrono::steady_clock::now() - r0).count();
+            body(p, grid, metrics);
+        }
+        load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    double map_setup = 0.0;
+    for (const SweepRecord& rec : threads.records) map_setup += rec.setup_seconds;
+    const double runs_done = double(config.points.size());
+
+    bool same = threads.failed == 0 && processes.failed == 0;
+    for (size_t r = 0; r < threads.records.size() && same; ++r) {
+        for (size_t m = 0; m < config.metric_names.size(); ++m) {
+            same = same && threads.records[r].metrics[m] == processes.records[r].metrics[m];
+        }
+    }
+    FieldImage image;
+    const bool untouched = image.open(image_path) && image.verify();
+    bool state_kept = false;
+    if (untouched) {
+        const DIFPGrid<double> mapped = image.map_private(0);
+        state_kept = std::equal(initial.state_data(), initial.state_data() + initial.state_word_count(),
+                                mapped.state_data());
+    }
+
+    std::cout << "Vlakna (" << threads.workers << "): " << threads.wall_seconds << " s, procesy (" << processes.workers
+              << "): " << processes.wall_seconds << " s, snapshot + load pro kazdy beh: " << load_seconds << " s"
+              << std::endl;
+    const double shared_mib = double((6 - field_count(config.written_fields)) * initial.get_compute_size() *
+                                     sizeof(double)) / (1024.0 * 1024.0);
+    std::cout << "Priprava behu: obraz (copy-on-write) " << map_setup / runs_done * 1e3 << " ms, snapshot + load "
+              << load_setup / runs_done * 1e3 << " ms; sdileno " << shared_mib << " MiB na beh" << std::endl;
+    std::cout << "Neuspesne behy " << threads.failed + processes.failed << ", vysledky vlaken a procesu "
+              << (same ? "shodne" : "ODLISNE") << ", obraz " << (untouched ? "beze zmeny" : "ZMENEN")
+              << ", stavove bity " << (state_kept ? "zachovany" : "ZTRACENY") << std::endl;
+    for (const SweepSummary& s : threads.summarize()) {
+        const std::vector<double>& best = config.points[s.argmin];
+        std::cout << "  " << s.metric << ": prumer " << s.mean << ", min " << s.min << " (treni x" << best[0]
+                  << ", amplituda x" << best[1] << "), max " << s.max << std::endl;
+    }
+    threads.write_csv(csv_path);
+    std::cout << "CSV: " << csv_path << std::endl;
+
+    std::remove(image_path);
+    std::remove(snapshot_path);
+    return (same && untouched && state_kept) ? 0 : 1;
+}
+
+/**
+ * REŽIM: Řízení za běhu (--steer [kroky] [jmeno])
+ * Bez jména posílá skriptované příkazy vlákno přes sdílenou paměť (stejně jako difp_steer),
+ * se jménem simulace čeká na příkazy z difp_steer. Měří cenu drain() s prázdnou frontou.
+ */
+int run_steer(size_t max_steps, const char* name) {
+    const size_t W = 256, H = 256;
+    const bool scripted = name == nullptr;
+    const std::string segment = scripted ? "difp_demo" : name;
+    const char* snapshot_path = "steer_snapshot.difp";
+
+    SteeringQueue steering(segment);
+    DIFPGrid<double> grid(W, H);
+    for (size_t i = 0; i < grid.active_size; ++i) grid.potential[i] = std::sin(0.01 * double(i));
+    RK4Solver rk4;
+    rk4.prepare(grid);
+    SteeringState state;
+    state.dt = 0.01;
+
+    // Cena kontroly prázdné fronty mezi kroky
+    const size_t probes = 1000000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t p = 0; p < probes; ++p) steering.drain(grid, state);
+    const double drain_ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / double(probes);
+
+    std::cout << "--- RIZENI ZA BEHU: " << W << "x" << H << ", segment '" << segment << "' ---" << std::endl;
+    std::thread tool;
+    if (scripted) {
+        tool = std::thread([&] {
+            SteeringClient client;
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!client.attach(segment) && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            client.send(SteeringCommand::set_parameter(SteeringParameter::TimeStep, 0.005));
+            client.send(SteeringCommand::paint_field(FIELD_POTENTIAL, 64, 64, 64, 64, 1.0, PaintMode::Add));
+            client.send(SteeringCommand::paint_field(FIELD_FRICTION, 0, 0, W, H / 2, 0.5));
+            client.send(SteeringCommand::paint_state(32, 32, 16, 8, true));
+            client.send(SteeringCommand::snapshot(snapshot_path));
+            client.send(SteeringCommand::paint_field(FIELD_MASS, W - 8, 0, 16, 16, 2.0)); // Mimo mřížku
+            client.send(SteeringCommand::paint_field(FIELD_MASS, 0, 0, 8, 8, 0.0));      // Nulová hmota
+            client.send(SteeringCommand::paint_field(FIELD_MASS, 0, 0, 8, 8, -1.0, PaintMode::Add));
+            client.send(SteeringCommand::paint_field(FIELD_VX, 0, 0, 8, 8, std::nan("")));
+            while (client.applied() + client.rejected() < 9 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            client.send(SteeringCommand::stop());
+        });
+    } else {
+        std::cout << "Cekam na prikazy: difp_steer " << segment
+                  << " dt 0.005 | pause | resume | paint potential 0 0 16 16 1 add | snapshot s.difp | stop"
+                  << std::endl;
+    }
+
+    double step_seconds = 0.0;
+    size_t drained = 0;
+    while (!state.stop && state.step < max_steps) {
+        drained += steering.drain(grid, state);
+        if (state.stop) break;
+        if (state.paused) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        auto s0 = std::chrono::steady_clock::now();
+        rk4.step(grid, state.dt);
+        step_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - s0).count();
+        ++state.step;
+        state.time += state.dt;
+        if (!scripted && state.step % 1000 == 0) {
+            std::cout << "  krok " << state.step << ", t = " << state.time << ", dt = " << state.dt << std::endl;
+        }
+    }
+    if (tool.joinable()) tool.join();
+
+    std::cout << "Kroku " << state.step << ", t = " << state.time << ", dt = " << state.dt << ", prikazu " << drained
+              << " (zpracovano " << steering.applied() << ", odmitnuto " << steering.rejected() << ")" << std::endl;
+    std::cout << "drain() s prazdnou frontou: " << drain_ns << " ns, krok RK4: "
+              << (state.step ? step_seconds / double(state.step) * 1e6 : 0.0) << " us" << std::endl;
+    if (!scripted) return 0;
+
+    size_t marked = 0;
+    for (size_t i = 0; i < grid.active_size; ++i) marked += grid.get_state(i);
+    SnapshotReader reader;
+    double friction = 0.0;
+    const bool snapshot_ok = state.snapshots == 1 && reader.open(snapshot_path) &&
+                             reader.read_region(SnapshotField::Friction, 10, 10, 1, 1, &friction) && friction == 0.5;
+    const bool ok = state.dt == 0.005 && marked == 16 * 8 && snapshot_ok && steering.applied() == 6 &&
+                    steering.rejected() == 4 && grid.mass[0] == 1.0 &&
+                    state.painted == (FIELD_POTENTIAL | FIELD_FRICTION);
+    std::cout << "Prikazy (dt, vstrik, treni, stav, snapshot, stop; odmitnuti mimo mrizku, mass <= 0, NaN): "
+              << (ok ? "OK" : "CHYBA") << std::endl;
+    reader.close();
+    std::remove(snapshot_path);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && std::strcmp(argv[argc - 1], "--quick") == 0) {
+        quick_run = true;
+        --argc;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--ensemble") == 0) return run_ensemble();
+    if (argc > 1 && std::strcmp(argv[1], "--strip") == 0) return run_strip();
+    if (argc > 1 && std::strcmp(argv[1], "--species") == 0) return run_species();
+    if (argc > 1 && std::strcmp(argv[1], "--cycles") == 0) return run_cycles();
+    if (argc > 1 && std::strcmp(argv[1], "--observe") == 0) return run_observe();
+    if (argc > 1 && std::strcmp(argv[1], "--parareal") == 0) return run_parareal();
+    if (argc > 1 && std::strcmp(argv[1], "--etdrk4") == 0) return run_etdrk4();
+    if (argc > 1 && std::strcmp(argv[1], "--splitting") == 0) return run_splitting();
+    if (argc > 1 && std::strcmp(argv[1], "--histogram") == 0) return run_histogram();
+    if (argc > 1 && std::strcmp(argv[1], "--spectrum") == 0) return run_spectrum();
+    if (argc > 1 && std::strcmp(argv[1], "--regions") == 0) return run_regions();
+    if (argc > 1 && std::strcmp(argv[1], "--alloc-check") == 0) return run_alloc_check();
+    if (argc > 1 && std::strcmp(argv[1], "--memory") == 0) {
+        return run_memory(argc > 3 ? std::strtoull(argv[2], nullptr, 10) : 1024,
+                          argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1024);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--work-precision") == 0) {
+        return run_work_precision(argc > 2 ? argv[2] : "work_precision.csv");
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--layout") == 0) {
+        std::vector<size_t> sizes;
+        for (int a = 2; a < argc; ++a) sizes.push_back(std::strtoull(argv[a], nullptr, 10));
+        if (sizes.empty()) sizes = {2048, 4096};
+        return run_layout(sizes);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--adjoint") == 0) {
+        return run_adjoint(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8, argc > 3 ? argv[3] : ".");
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--sweep") == 0) {
+        return run_sweep(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16, argc > 3 ? argv[3] : "sweep.csv");
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--steer") == 0) {
+        try {
+            return run_steer(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000, argc > 3 ? argv[3] : nullptr);
+        } catch (const std::runtime_error& e) {
+            // Segment se stejným jménem patří běžící simulaci, nebo sdílená paměť není k dispozici
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--snapshot") == 0) return run_snapshot(argc > 2 ? argv[2] : "snapshot.difp");
+    if (argc > 1 && std::strcmp(argv[1], "--events") == 0) return run_events(argc > 2 ? argv[2] : "events.bin");
+    if (argc > 1 && std::strcmp(argv[1], "--activity") == 0) return run_activity(argc > 2 ? argv[2] : "activity.csv");
+
     // 1. DEFINICE PROSTORU
     const int WIDTH = 20;  // Malá mřížka pro názornost v terminálu
     const int HEIGHT = 1;  // Jednorozměrný testovací "pruh" vesmíru
@@ -0,0 +1,265 @@
+#include "adjoint_rk4.hpp"
+#include "physics_kernel.hpp"
+#include "io/snapshot.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+// Binomické β(c, t) = C(c + t, c) (Griewank & Walther)
+size_t beta(size_t c, size_t t) {
+    size_t value = 1;
+    for (size_t r = 1; r <= t; ++r) value = value * (c + r) / r;
+    return value;
+}
+
+// Nejmenší počet opakování t s β(c, t) >= steps
+size_t repetitions(size_t steps, size_t c) {
+    size_t t = 0, range = 1;
+    while (range < steps) {
+        ++t;
+        range = range * (c + t) / t;
+    }
+    return t;
+}
+
+} // namespace
+
+AdjointRK4::AdjointRK4(size_t n_checkpoints, CheckpointStorage where, std::string dir)
+    : checkpoints(n_checkpoints), storage(where), directory(std::move(dir)), state(0, 0), lambda(0, 0),
+      terminal(0, 0) {
+    if (checkpoints == 0) throw std::invalid_argument("AdjointRK4: at least one checkpoint is required.");
+}
+
+AdjointRK4::~AdjointRK4() {
+    if (storage == CheckpointStorage::Disk) {
+        for (size_t s = 0; s < checkpoints; ++s) std::remove(slot_path(s).c_str());
+    }
+}
+
+size_t AdjointRK4::split(size_t steps, size_t c) {
+    // Revolve (akce "advance"): c = checkpointy úseku včetně jeho začátku
+    if (steps <= 1) return 1;
+    const size_t reps = repetitions(steps, c);
+    const size_t range = beta(c, reps);
+    const size_t bino1 = range * reps / (c + reps);
+    const size_t bino2 = c > 1 ? bino1 * c / (c + reps - 1) : 1;
+    const size_t bino3 = c == 1 ? 0 : (c > 2 ? bino2 * (c - 1) / (c + reps - 2) : 1);
+    const size_t bino4 = bino2 * (reps - 1) / c;
+    const size_t bino5 = c < 3 ? 0 : (c > 3 ? bino3 * (c - 2) / reps : 1);
+
+    size_t m;
+    if (steps <= bino1 + bino3) {
+        m = bino4;
+    } else if (steps >= range - bino5) {
+        m = bino1;
+    } else {
+        m = steps - bino2 - bino3;
+    }
+    return std::clamp<size_t>(m, 1, steps - 1);
+}
+
+size_t AdjointRK4::forward_steps_for(size_t steps, size_t c) {
+    if (steps == 0) return 0;
+    if (steps == 1) return 1;
+    const size_t t = repetitions(steps, c);
+    return t * steps - beta(c + 1, t - 1) + 1;
+}
+
+size_t AdjointRK4::memory_bytes_for(size_t w, size_t h, size_t c, CheckpointStorage storage) {
+    constexpr size_t SIMD_ELEMENTS = AVX_WIDTH_BYTES / sizeof(double);
+    const size_t padded = (w * h + SIMD_ELEMENTS - 1) & ~(SIMD_ELEMENTS - 1); // Jako DIFPGrid::padded_size
+    size_t bytes = 3 * DIFPGrid<double>::footprint_for(w, h).total() + RK4Solver::memory_bytes_for(w, h);
+    if (storage == CheckpointStorage::Memory) bytes += c * 3 * padded * sizeof(double);
+    return bytes;
+}
+
+std::string AdjointRK4::slot_path(size_t slot) const {
+    return directory + "/difp_checkpoint_" + std::to_string(slot) + ".difp";
+}
+
+void AdjointRK4::store(size_t slot, size_t step) {
+    ++result->checkpoint_writes;
+    if (storage == CheckpointStorage::Disk) {
+        write_snapshot(slot_path(slot), state, step, double(step) * dt);
+        return;
+    }
+    const size_t N = state.get_compute_size();
+    double* out = slots[slot].data();
+    std::copy(state.potential, state.potential + N, out);
+    std::copy(state.vx, state.vx + N, out + N);
+    std::copy(state.vy, state.vy + N, out + 2 * N);
+}
+
+void AdjointRK4::restore(size_t slot) {
+    if (storage == CheckpointStorage::Disk) {
+        SnapshotReader reader;
+        if (!reader.open(slot_path(slot)) || !reader.load(state)) {
+            throw std::runtime_error("AdjointRK4: cannot read checkpoint " + slot_path(slot));
+        }
+        return;
+    }
+    const size_t N = state.get_compute_size();
+    const double* in = slots[slot].data();
+    std::copy(in, in + N, state.potential);
+    std::copy(in + N, in + 2 * N, state.vx);
+    std::copy(in + 2 * N, in + 3 * N, state.vy);
+}
+
+void AdjointRK4::advance(size_t count) {
+    for (size_t s = 0; s < count; ++s) solver.step(state, dt);
+    result->forward_steps += count;
+}
+
+void AdjointRK4::inject(size_t step, const DIFPGrid<double>& y) {
+    for (const AdjointObservation& obs : *observations) {
+        if (obs.step != step) continue;
+        const double* __restrict field = obs.field == FIELD_POTENTIAL ? y.potential
+                                       : obs.field == FIELD_VX        ? y.vx
+                                                                      : y.vy;
+        double* __restrict adj = obs.field == FIELD_POTENTIAL ? lambda.potential
+                               : obs.field == FIELD_VX        ? lambda.vx
+                                                              : lambda.vy;
+        const double* __restrict target = obs.values.data();
+        const double w = obs.weight;
+        double sum = 0.0;
+        #pragma omp simd reduction(+ : sum)
+        for (size_t i = 0; i < y.active_size; ++i) {
+            const double r = field[i] - target[i];
+            sum += r * r;
+            adj[i] += w * r;
+        }
+        result->loss += 0.5 * w * sum;
+    }
+}
+
+void AdjointRK4::adjoint_step(size_t step) {
+    if (step + 1 == total_steps) {
+        // y_N existuje jen tady: pozorování na konci běhu
+        terminal = state;
+        solver.step(terminal, dt);
+        ++result->forward_steps;
+        inject(total_steps, terminal);
+    }
+
+    const size_t N = state.get_compute_size();
+    const double* __restrict pot = state.potential;
+    const double* __restrict vx = state.vx;
+    const double* __restrict vy = state.vy;
+    const double* __restrict mass = state.mass;
+    const double* __restrict fric = state.friction;
+    double* __restrict l_pot = lambda.potential;
+    double* __restrict l_vx = lambda.vx;
+    double* __restrict l_vy = lambda.vy;
+    double* __restrict g_mass = lambda.mass;
+    double* __restrict g_fric = lambda.friction;
+    const double h = dt, h2 = 0.5 * dt, h6 = dt / 6.0, h3 = dt / 3.0;
+
+    #pragma omp simd aligned(pot, vx, vy, mass, fric, l_pot, l_vx, l_vy, g_mass, g_fric : 64)
+    for (size_t i = 0; i < N; ++i) {
+        const double m = mass[i], f = fric[i], inv_m = 1.0 / m;
+
+        // Dopředné stage (jako RK4Solver::step)
+        const double p1 = pot[i], x1 = vx[i], y1 = vy[i];
+        double kp1, kx1, ky1, kp2, kx2, ky2, kp3, kx3, ky3;
+        damped_wave_rhs(p1, x1, y1, m, f, kp1, kx1, ky1);
+        const double p2 = p1 + h2 * kp1, x2 = x1 + h2 * kx1, y2 = y1 + h2 * ky1;
+        damped_wave_rhs(p2, x2, y2, m, f, kp2, kx2, ky2);
+        const double p3 = p1 + h2 * kp2, x3 = x1 + h2 * kx2, y3 = y1 + h2 * ky2;
+        damped_wave_rhs(p3, x3, y3, m, f, kp3, kx3, ky3);
+        const double p4 = p1 + h * kp3, x4 = x1 + h * kx3, y4 = y1 + h * ky3;
+
+        const double lp = l_pot[i], lx = l_vx[i], ly = l_vy[i];
+        double gm = 0.0, gf = 0.0;
+
+        // Ȳ = J^T k̄ (J nezávisí na stavu) a příspěvek k̄ · ∂f/∂(m, f) ve stavu stage
+        auto back = [&](double bp, double bx, double by, double p, double x, double y,
+                        double& yp, double& yx, double& yy) {
+            yp = -(bx + by) * inv_m;
+            yx = -bp - f * bx;
+            yy = -bp - f * by;
+            gm += (bx + by) * p * inv_m * inv_m;
+            gf -= bx * x + by * y;
+        };
+
+        double yp4, yx4, yy4, yp3, yx3, yy3, yp2, yx2, yy2, yp1, yx1, yy1;
+        back(h6 * lp, h6 * lx, h6 * ly, p4, x4, y4, yp4, yx4, yy4);
+        back(h3 * lp + h * yp4, h3 * lx + h * yx4, h3 * ly + h * yy4, p3, x3, y3, yp3, yx3, yy3);
+        back(h3 * lp + h2 * yp3, h3 * lx + h2 * yx3, h3 * ly + h2 * yy3, p2, x2, y2, yp2, yx2, yy2);
+        back(h6 * lp + h2 * yp2, h6 * lx + h2 * yx2, h6 * ly + h2 * yy2, p1, x1, y1, yp1, yx1, yy1);
+
+        l_pot[i] = lp + yp1 + yp2 + yp3 + yp4;
+        l_vx[i] = lx + yx1 + yx2 + yx3 + yx4;
+        l_vy[i] = ly + yy1 + yy2 + yy3 + yy4;
+        g_mass[i] += gm;
+        g_fric[i] += gf;
+    }
+    ++result->adjoint_steps;
+
+    inject(step, state);
+}
+
+void AdjointRK4::reverse(size_t from, size_t to, size_t slot, size_t free) {
+    while (to - from > 1 && free > 0) {
+        // Další checkpoint do slotu slot + 1, nejdřív se obrátí úsek za ním
+        const size_t m = split(to - from, free + 1);
+        restore(slot);
+        advance(m);
+        store(slot + 1, from + m);
+        reverse(from + m, to, slot + 1, free - 1);
+        to = from + m;
+    }
+    // Bez volných checkpointů: každý krok znovu od y_from (C(l, 2) kroků)
+    for (size_t n = to; n-- > from;) {
+        restore(slot);
+        advance(n - from);
+        adjoint_step(n);
+    }
+}
+
+AdjointResult AdjointRK4::gradient(const DIFPGrid<double>& initial, double step_dt, size_t steps,
+                                   const std::vector<AdjointObservation>& obs) {
+    for (const AdjointObservation& o : obs) {
+        if (o.step > steps) throw std::invalid_argument("AdjointRK4: observation after the last step.");
+        if (o.values.size() != initial.active_size) {
+            throw std::invalid_argument("AdjointRK4: observation size differs from the grid.");
+        }
+        if (o.field != FIELD_POTENTIAL && o.field != FIELD_VX && o.field != FIELD_VY) {
+            throw std::invalid_argument("AdjointRK4: only potential, vx and vy can be observed.");
+        }
+    }
+
+    AdjointResult out;
+    result = &out;
+    observations = &obs;
+    dt = step_dt;
+    total_steps = steps;
+
+    state = initial;
+    if (lambda.active_size != initial.active_size) lambda = DIFPGrid<double>(initial.width, initial.height);
+    const size_t N = lambda.get_compute_size();
+    for (double* field : {lambda.potential, lambda.vx, lambda.vy, lambda.mass, lambda.friction}) {
+        std::fill(field, field + N, 0.0);
+    }
+    solver.prepare(state, false);
+    // Víc checkpointů než kroků nic neušetří
+    const size_t usable = std::min(checkpoints, std::max<size_t>(steps, 1));
+    if (storage == CheckpointStorage::Memory) {
+        slots.resize(usable);
+        for (std::vector<double>& s : slots) s.resize(3 * N);
+    }
+
+    if (steps == 0) {
+        inject(0, state);
+    } else {
+        store(0, 0);
+        reverse(0, steps, 0, usable - 1);
+    }
+
+    out.grad_mass.assign(lambda.mass, lambda.mass + initial.active_size);
+    out.grad_friction.assign(lambda.friction, lambda.friction + initial.active_size);
+    result = nullptr;
+    observations = nullptr;
+    return out;
+}
@@ -0,0 +1,112 @@
+#ifndef DIFP_ADJOINT_RK4_HPP
+#define DIFP_ADJOINT_RK4_HPP
+
+#include "DIFP_Core.hpp"
+#include "rk4_solver.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Diskrétní adjungovaný RK4 pro gradient ztráty podle polí mass a friction.
+ *
+ * Krok RK4 (viz RK4Solver) y1 = y0 + dt/6 (k1 + 2 k2 + 2 k3 + k4) se zpětně derivuje
+ * přesně (diskrétní adjungace, ne adjungovaná spojitá rovnice): gradient je tedy gradient
+ * toho, co skutečně počítá RK4Solver. Fyzika je po buňkách, adjungovaný krok proto
+ * přepočítá stage z y0 v registrech a celý krok zvládne jedním průchodem.
+ *
+ * Stavy y_n pro zpětný průchod dodává binomiální checkpointing (Revolve, Griewank &
+ * Walther): s c checkpointy a N kroky je počet přepočtených dopředných kroků optimální,
+ * t N - C(c + t, c + 1), kde t je nejmenší s C(c + t, c) >= N. Paměť roste s c,
+ * přepočet jen s t ~ N^(1/c) – místo N uložených stavů stačí několik desítek.
+ */
+
+struct AdjointObservation {
+    size_t step;                      // Po kolika krocích se pozoruje (0..steps)
+    uint32_t field = FIELD_POTENTIAL; // FIELD_POTENTIAL, FIELD_VX nebo FIELD_VY
+    std::vector<double> values;       // active_size hodnot
+    double weight = 1.0;
+};
+
+struct AdjointResult {
+    double loss = 0.0;                // Σ 0.5 w Σ (pole - pozorování)²
+    std::vector<double> grad_mass;    // dL/dmass po buňkách
+    std::vector<double> grad_friction;
+    size_t forward_steps = 0;         // Všechny dopředné kroky RK4 (včetně přepočtů)
+    size_t adjoint_steps = 0;
+    size_t checkpoint_writes = 0;
+};
+
+enum class CheckpointStorage {
+    Memory, // potential, vx, vy v RAM
+    Disk,   // Snapshot (snapshot.hpp) v adresáři na lokálním disku
+};
+
+/**
+ * @class AdjointRK4
+ * @brief Gradient ztráty přes steps kroků RK4 s omezeným počtem checkpointů.
+ */
+class AdjointRK4 {
+private:
+    size_t checkpoints;
+    CheckpointStorage storage;
+    std::string directory;
+
+    // Pracovní stav běhu gradient()
+    RK4Solver solver;
+    DIFPGrid<double> state;    // Aktuální y_n
+    DIFPGrid<double> lambda;   // potential, vx, vy = adjungovaný stav; mass, friction = gradient
+    DIFPGrid<double> terminal; // y_N pro pozorování na konci
+    std::vector<std::vector<double>> slots; // Checkpointy v paměti (3 pole × padded_size)
+    const std::vector<AdjointObservation>* observations = nullptr;
+    double dt = 0.0;
+    size_t total_steps = 0;
+    AdjointResult* result = nullptr;
+
+    std::string slot_path(size_t slot) const;
+    void store(size_t slot, size_t step);
+    void restore(size_t slot);
+    void advance(size_t count);
+
+    // λ += ∂L/∂y_n pro pozorování v kroku n (a přičte jejich příspěvek ke ztrátě)
+    void inject(size_t step, const DIFPGrid<double>& y);
+
+    // λ_n z λ_{n+1}, state = y_n (jeden průchod, stage se přepočítají v registrech)
+    void adjoint_step(size_t step);
+
+    // Zpětný průchod kroky [from, to); y_from je v checkpointu slot, volných je free dalších
+    void reverse(size_t from, size_t to, size_t slot, size_t free);
+
+public:
+    /**
+     * @param checkpoints Počet checkpointů včetně počátečního stavu (>= 1).
+     * @param directory   Adresář pro CheckpointStorage::Disk.
+     */
+    explicit AdjointRK4(size_t checkpoints, CheckpointStorage storage = CheckpointStorage::Memory,
+                        std::string directory = ".");
+    ~AdjointRK4();
+
+    AdjointRK4(const AdjointRK4&) = delete;
+    AdjointRK4& operator=(const AdjointRK4&) = delete;
+
+    /**
+     * @brief Ztráta a její gradient podle mass a friction pro steps kroků délky dt z initial.
+     * @details Při neplatném pozorování vyhodí std::invalid_argument, při chybě
+     *          checkpointu na disku std::runtime_error.
+     */
+    AdjointResult gradient(const DIFPGrid<double>& initial, double dt, size_t steps,
+                           const std::vector<AdjointObservation>& observations);
+
+    // Dopředné kroky gradient() pro daný počet kroků a checkpointů (Revolve + krok na y_N)
+    [[nodiscard]] static size_t forward_steps_for(size_t steps, size_t checkpoints);
+
+    // Revolve: o kolik kroků posunout další checkpoint v úseku steps kroků s checkpoints checkpointy
+    [[nodiscard]] static size_t split(size_t steps, size_t checkpoints);
+
+    // Paměť pro mřížku w x h (pracovní mřížky, RK4Solver, checkpointy v RAM)
+    [[nodiscard]] static size_t memory_bytes_for(size_t w, size_t h, size_t checkpoints,
+                                                 CheckpointStorage storage = CheckpointStorage::Memory);
+};
+
+#endif // DIFP_ADJOINT_RK4_HPP
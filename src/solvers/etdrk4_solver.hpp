@@ -0,0 +1,117 @@
+#ifndef DIFP_ETDRK4_SOLVER_HPP
+#define DIFP_ETDRK4_SOLVER_HPP
+
+#include "DIFP_Core.hpp"
+#include "DIFP_Observers.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class ETDRK4Solver
+ * @brief Exponenciální integrátor ETDRK4 (Cox–Matthews): lineární část přesně, zbytek RK4.
+ * @details Rovnici du/dt = F(u) pro u = (potential, vx, vy) rozdělíme na F(u) = L u + N(u),
+ *          kde L je lineární operátor tlumené vlny v buňce (viz physics_kernel.hpp):
+ *
+ *              L = [  0    -1    -1 ]
+ *                  [ -1/m  -f     0 ]
+ *                  [ -1/m   0    -f ]
+ *
+ *          Maticové exponenciály e^{hL}, e^{hL/2} a funkce phi_k se předpočítají jednou
+ *          pro každou unikátní dvojici (mass, friction) – buňka drží jen index do tabulky.
+ *          Tuhost lineární části (silné tření = rychle tlumené módy) tak neomezuje krok;
+ *          stabilitu určuje jen nelineární zbytek N(u) = F(u) - L u.
+ *
+ *          Koeficienty se přepočítají při změně dt nebo velikosti mřížky. Po změně
+ *          mass/friction je nutné zavolat invalidate().
+ */
+class ETDRK4Solver {
+public:
+    // Koeficienty jedné dvojice (mass, friction), matice 3x3 po řádcích
+    struct Coefficients {
+        double E[9];  // e^{hL}
+        double E2[9]; // e^{hL/2}
+        double Q[9];  // (h/2) phi1(hL/2)
+        double f1[9]; // h (phi1 - 3 phi2 + 4 phi3)
+        double f2[9]; // h (phi2 - 2 phi3)
+        double f3[9]; // h (4 phi3 - phi2)
+    };
+
+private:
+    std::vector<Coefficients> table;
+    std::vector<uint32_t> cell_operator; // Index do table pro každou buňku
+    double prepared_dt = 0.0;
+    size_t prepared_size = 0;
+    bool valid = false;
+
+    // Nelineární zbytky ve stavech u, a, b, c a mezistavy a, b (b později drží c);
+    // mezistavy nesou jen potential/vx/vy, mass a friction se čtou z mřížky kroku
+    DIFPGrid<double> nu, na, nb, nc, a, b;
+
+    void ensure_buffers(const DIFPGrid<double>& grid);
+
+    // out = F(in) - L in s parametry (mass, friction) z params
+    void compute_remainder(const DIFPGrid<double>& in, const DIFPGrid<double>& params, DIFPGrid<double>& out);
+
+    // out = E2 * base + Q * (w1 * n1 + w2 * n2)
+    void half_stage(const DIFPGrid<double>& base, const DIFPGrid<double>& n1, double w1,
+                    const DIFPGrid<double>* n2, double w2, DIFPGrid<double>& out);
+
+    // grid = E u + f1 Nu + 2 f2 (Na + Nb) + f3 Nc
+    void final_update(DIFPGrid<double>& grid);
+
+public:
+    ETDRK4Solver() : nu(0,0), na(0,0), nb(0,0), nc(0,0), a(0,0), b(0,0) {}
+
+    /**
+     * @brief Předpočítá koeficienty pro krok dt (jinak se to stane v prvním step()).
+     */
+    void prepare(const DIFPGrid<double>& grid, double dt);
+
+    // Vynutí přepočet koeficientů v příštím kroku (po změně mass/friction)
+    void invalidate() { valid = false; }
+
+    // Počet unikátních operátorů (dvojic mass, friction) v tabulce
+    [[nodiscard]] size_t unique_operators() const { return table.size(); }
+
+    // Paměť mezistavů, tabulky koeficientů a indexů buněk; odhad pro mřížku w x h
+    [[nodiscard]] size_t memory_bytes() const;
+    [[nodiscard]] static size_t memory_bytes_for(size_t w, size_t h, size_t operators = 1,
+                                                 FieldLayout mode = FieldLayout::Staggered);
+
+    void step(DIFPGrid<double>& grid, double dt);
+
+    // Totéž s pozorovatelem (stage 1..4 = stavy u, a, b, c a jejich nelineární zbytky)
+    template <typename Observer>
+    void step(DIFPGrid<double>& grid, double dt, Observer& observer);
+};
+
+template <typename Observer>
+void ETDRK4Solver::step(DIFPGrid<double>& grid, double dt, Observer& observer) {
+    ensure_buffers(grid);
+    if (!valid || dt != prepared_dt || grid.active_size != prepared_size) prepare(grid, dt);
+    observer.on_step_begin(grid, dt);
+
+    compute_remainder(grid, grid, nu);
+    observer.on_stage(1, grid, nu);
+
+    // a = E2 u + Q Nu
+    half_stage(grid, nu, 1.0, nullptr, 0.0, a);
+    compute_remainder(a, grid, na);
+    observer.on_stage(2, a, na);
+
+    // b = E2 u + Q Na
+    half_stage(grid, na, 1.0, nullptr, 0.0, b);
+    compute_remainder(b, grid, nb);
+    observer.on_stage(3, b, nb);
+
+    // c = E2 a + Q (2 Nb - Nu); stav b už není potřeba, c se zapíše do něj
+    half_stage(a, nb, 2.0, &nu, -1.0, b);
+    compute_remainder(b, grid, nc);
+    observer.on_stage(4, b, nc);
+
+    final_update(grid);
+    observer.on_step_end(grid, dt);
+}
+
+#endif // DIFP_ETDRK4_SOLVER_HPP
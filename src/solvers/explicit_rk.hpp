@@ -0,0 +1,284 @@
+#ifndef DIFP_EXPLICIT_RK_HPP
+#define DIFP_EXPLICIT_RK_HPP
+
+#include "DIFP_Core.hpp"
+#include "DIFP_Observers.hpp"
+#include "physics_kernel.hpp"
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * Explicitní Runge-Kutta řízený Butcherovou tabulkou v době překladu.
+ *
+ * Tabulka je typ se statickými constexpr koeficienty:
+ *
+ *     static constexpr const char* name;
+ *     static constexpr int order;
+ *     static constexpr size_t stages;
+ *     static constexpr double a[stages][stages]; // Striktně dolní trojúhelník
+ *     static constexpr double b[stages];
+ *     static constexpr double c[stages];
+ *
+ * Stage i se počítá jedním průchodem: stav y + dt * Σ a[i][j] k_j se sestaví v registrech
+ * (nulové koeficienty se vynechají už při překladu) a rovnou se z něj vyhodnotí k_i,
+ * mezistav se do paměti nezapisuje. Poslední stage je sloučená s finální integrací
+ * y += dt * Σ b[j] k_j, takže krok má přesně stages průchodů a stages - 1 pomocných mřížek.
+ */
+
+struct Heun2 {
+    static constexpr const char* name = "heun";
+    static constexpr int order = 2;
+    static constexpr size_t stages = 2;
+    static constexpr double a[2][2] = {{0.0, 0.0}, {1.0, 0.0}};
+    static constexpr double b[2] = {0.5, 0.5};
+    static constexpr double c[2] = {0.0, 1.0};
+};
+
+// Shu-Osher SSP-RK3 (silně stabilní, CFL 1)
+struct SSPRK3 {
+    static constexpr const char* name = "ssprk3";
+    static constexpr int order = 3;
+    static constexpr size_t stages = 3;
+    static constexpr double a[3][3] = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.25, 0.25, 0.0}};
+    static constexpr double b[3] = {1.0 / 6.0, 1.0 / 6.0, 2.0 / 3.0};
+    static constexpr double c[3] = {0.0, 1.0, 0.5};
+};
+
+struct ClassicRK4 {
+    static constexpr const char* name = "rk4";
+    static constexpr int order = 4;
+    static constexpr size_t stages = 4;
+    static constexpr double a[4][4] = {{0.0, 0.0, 0.0, 0.0}, {0.5, 0.0, 0.0, 0.0}, {0.0, 0.5, 0.0, 0.0},
+                                       {0.0, 0.0, 1.0, 0.0}};
+    static constexpr double b[4] = {1.0 / 6.0, 1.0 / 3.0, 1.0 / 3.0, 1.0 / 6.0};
+    static constexpr double c[4] = {0.0, 0.5, 0.5, 1.0};
+};
+
+// Pravidlo 3/8 (Kutta)
+struct RK38 {
+    static constexpr const char* name = "rk38";
+    static constexpr int order = 4;
+    static constexpr size_t stages = 4;
+    static constexpr double a[4][4] = {{0.0, 0.0, 0.0, 0.0}, {1.0 / 3.0, 0.0, 0.0, 0.0}, {-1.0 / 3.0, 1.0, 0.0, 0.0},
+                                       {1.0, -1.0, 1.0, 0.0}};
+    static constexpr double b[4] = {0.125, 0.375, 0.375, 0.125};
+    static constexpr double c[4] = {0.0, 1.0 / 3.0, 2.0 / 3.0, 1.0};
+};
+
+namespace rk_detail {
+
+constexpr bool near(double x, double y) {
+    return (x > y ? x - y : y - x) < 1e-14;
+}
+
+// Explicitní (a[i][j] = 0 pro j >= i), konzistentní (Σ b = 1) a Σ_j a[i][j] = c[i]
+template <typename T>
+constexpr bool valid_tableau() {
+    double sum_b = 0.0;
+    for (size_t i = 0; i < T::stages; ++i) {
+        double row = 0.0;
+        for (size_t j = 0; j < T::stages; ++j) {
+            if (j >= i && T::a[i][j] != 0.0) return false;
+            row += T::a[i][j];
+        }
+        if (!near(row, T::c[i])) return false;
+        sum_b += T::b[i];
+    }
+    return near(sum_b, 1.0);
+}
+
+} // namespace rk_detail
+
+/**
+ * @class ExplicitRKSolver
+ * @brief Explicitní RK podle tabulky Tableau se sloučenými stage (API jako RK4Solver).
+ */
+template <typename Tableau>
+class ExplicitRKSolver {
+    static_assert(Tableau::stages >= 1, "ExplicitRKSolver: tabulka bez stage.");
+    static_assert(rk_detail::valid_tableau<Tableau>(), "ExplicitRKSolver: neplatna Butcherova tabulka.");
+
+    static constexpr size_t S = Tableau::stages;
+
+    // k_0 .. k_{S-2}; poslední stage se neukládá (viz finální průchod)
+    std::vector<DIFPGrid<double>> k;
+    size_t buffer_cells = 0;
+    FieldLayout buffer_layout = FieldLayout::Staggered;
+    bool have_buffers = false;
+
+    // Zamčené buffery: realokace v step() je chyba, ne tichá alokace (viz prepare())
+    bool buffers_locked = false;
+
+    void ensure_buffers(const DIFPGrid<double>& grid) {
+        if (have_buffers && buffer_cells == grid.active_size && buffer_layout == grid.field_layout()) return;
+        if (buffers_locked) {
+            throw std::logic_error("ExplicitRKSolver: grid size differs from prepare(); step() would reallocate.");
+        }
+        k.clear();
+        k.reserve(S - 1);
+        // Sloty 1..S-1: buffery posunuté vůči hlavní mřížce i mezi sebou (viz FieldLayout)
+        for (size_t j = 0; j + 1 < S; ++j) {
+            k.emplace_back(grid.width, grid.height, grid.field_layout(), static_cast<unsigned>(j + 1));
+        }
+        buffer_cells = grid.active_size;
+        buffer_layout = grid.field_layout();
+        have_buffers = true;
+    }
+
+    // p, x, y += h * Σ_{j<I} a[I][j] k_j (nulové koeficienty vypadnou při překladu)
+    template <size_t I, size_t J>
+    static inline void add_term(double& p, double& x, double& y, double dt, size_t i,
+                                double* const* kp, double* const* kx, double* const* ky) {
+        if constexpr (Tableau::a[I][J] != 0.0) {
+            const double h = dt * Tableau::a[I][J];
+            p += h * kp[J][i];
+            x += h * kx[J][i];
+            y += h * ky[J][i];
+        }
+    }
+
+    template <size_t J>
+    static inline void add_final(double& p, double& x, double& y, double dt, size_t i,
+                                 double* const* kp, double* const* kx, double* const* ky) {
+        if constexpr (Tableau::b[J] != 0.0) {
+            const double h = dt * Tableau::b[J];
+            p += h * kp[J][i];
+            x += h * kx[J][i];
+            y += h * ky[J][i];
+        }
+    }
+
+    // k_I = f(y + dt * Σ a[I][j] k_j) jedním průchodem
+    template <size_t I, size_t... J>
+    void stage(const DIFPGrid<double>& grid, [[maybe_unused]] double dt, double* const* kp, double* const* kx,
+               double* const* ky, std::index_sequence<J...>) {
+        const size_t N = grid.get_compute_size();
+        const double* __restrict pot = grid.potential;
+        const double* __restrict vx = grid.vx;
+        const double* __restrict vy = grid.vy;
+        const double* __restrict mass = grid.mass;
+        const double* __restrict fric = grid.friction;
+        double* __restrict d_pot = kp[I];
+        double* __restrict d_vx = kx[I];
+        double* __restrict d_vy = ky[I];
+
+        #pragma omp simd aligned(pot, vx, vy, mass, fric, d_pot, d_vx, d_vy : 64)
+        for (size_t i = 0; i < N; ++i) {
+            double p = pot[i], x = vx[i], y = vy[i];
+            (add_term<I, J>(p, x, y, dt, i, kp, kx, ky), ...);
+            damped_wave_rhs(p, x, y, mass[i], fric[i], d_pot[i], d_vx[i], d_vy[i]);
+        }
+    }
+
+    // Poslední stage + y += dt * Σ b[j] k_j v jednom průchodu
+    template <typename Observer, size_t... J>
+    void final_stage(DIFPGrid<double>& grid, double dt, double* const* kp, double* const* kx, double* const* ky,
+                     Observer& observer, std::index_sequence<J...>) {
+        constexpr size_t L = S - 1;
+        const size_t N = grid.get_compute_size();
+        double* __restrict pot = grid.potential;
+        double* __restrict vx = grid.vx;
+        double* __restrict vy = grid.vy;
+        const double* __restrict mass = grid.mass;
+        const double* __restrict fric = grid.friction;
+        const double h_last = dt * Tableau::b[L];
+
+        auto update = [&](size_t i) {
+            double p = pot[i], x = vx[i], y = vy[i];
+            (add_term<L, J>(p, x, y, dt, i, kp, kx, ky), ...);
+            double k_pot, k_vx, k_vy;
+            damped_wave_rhs(p, x, y, mass[i], fric[i], k_pot, k_vx, k_vy);
+
+            double np = pot[i], nx = vx[i], ny = vy[i];
+            (add_final<J>(np, nx, ny, dt, i, kp, kx, ky), ...);
+            pot[i] = np + h_last * k_pot;
+            vx[i] = nx + h_last * k_vx;
+            vy[i] = ny + h_last * k_vy;
+        };
+
+        if constexpr (!observes_cells<Observer>) {
+            #pragma omp simd aligned(pot, vx, vy, mass, fric : 64)
+            for (size_t i = 0; i < N; ++i) update(i);
+        } else {
+            // Pozorovatel se stavem nesmí běžet uvnitř omp simd (viz RK4Solver::step)
+            for (size_t i = 0; i < N; ++i) {
+                update(i);
+                observer.on_cell_update(i, pot[i], vx[i], vy[i]);
+            }
+        }
+    }
+
+    template <typename Observer, size_t... I>
+    void run_stages(DIFPGrid<double>& grid, double dt, double* const* kp, double* const* kx, double* const* ky,
+                    Observer& observer, std::index_sequence<I...>) {
+        ((stage<I>(grid, dt, kp, kx, ky, std::make_index_sequence<I>{}), observer.on_stage(int(I + 1), grid, k[I])),
+         ...);
+    }
+
+public:
+    using tableau = Tableau;
+
+    /**
+     * @brief Předem alokuje pomocné mřížky (stages - 1) pro mřížku dané velikosti.
+     * @details S lock = true vyhodí krok na mřížce jiné velikosti std::logic_error místo realokace.
+     */
+    void prepare(const DIFPGrid<double>& grid, bool lock = true) {
+        buffers_locked = false;
+        ensure_buffers(grid);
+        buffers_locked = lock;
+    }
+
+    // Povolí znovu automatickou realokaci v step()
+    void unlock_buffers() { buffers_locked = false; }
+
+    [[nodiscard]] size_t memory_bytes() const {
+        size_t bytes = 0;
+        for (const DIFPGrid<double>& g : k) bytes += g.footprint().total();
+        return bytes;
+    }
+
+    [[nodiscard]] static size_t memory_bytes_for(size_t w, size_t h, FieldLayout mode = FieldLayout::Staggered) {
+        size_t bytes = 0;
+        for (unsigned slot = 1; slot < S; ++slot) bytes += DIFPGrid<double>::footprint_for(w, h, mode, slot).total();
+        return bytes;
+    }
+
+    // Průchody mřížkou za krok (čtení + zápis celé mřížky = 1)
+    [[nodiscard]] static constexpr size_t passes() { return S; }
+
+    void step(DIFPGrid<double>& grid, double dt) {
+        NullObserver none;
+        step(grid, dt, none);
+    }
+
+    /**
+     * @brief Krok s pozorovatelem.
+     * @details Mezistavy se neukládají: on_stage(i, grid, k_i) dostane výchozí stav kroku
+     *          a hlásí se jen stage 1..stages-1, poslední je sloučená s integrací
+     *          (její výsledek hlásí on_cell_update).
+     */
+    template <typename Observer>
+    void step(DIFPGrid<double>& grid, double dt, Observer& observer) {
+        ensure_buffers(grid);
+        observer.on_step_begin(grid, dt);
+
+        double* kp[S];
+        double* kx[S];
+        double* ky[S];
+        for (size_t j = 0; j + 1 < S; ++j) {
+            kp[j] = k[j].potential;
+            kx[j] = k[j].vx;
+            ky[j] = k[j].vy;
+        }
+        kp[S - 1] = kx[S - 1] = ky[S - 1] = nullptr;
+
+        run_stages(grid, dt, kp, kx, ky, observer, std::make_index_sequence<S - 1>{});
+        final_stage(grid, dt, kp, kx, ky, observer, std::make_index_sequence<S - 1>{});
+
+        observer.on_step_end(grid, dt);
+    }
+};
+
+#endif // DIFP_EXPLICIT_RK_HPP
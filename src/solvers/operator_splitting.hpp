@@ -0,0 +1,176 @@
+#ifndef DIFP_OPERATOR_SPLITTING_HPP
+#define DIFP_OPERATOR_SPLITTING_HPP
+
+#include "DIFP_Core.hpp"
+#include <tuple>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+
+/**
+ * Rozklad kroku na dílčí operátory (operator splitting): du/dt = (A + B + ...) u.
+ *
+ * Každý dílčí operátor je typ (žádná dědičnost, volání se inlinují) s popisem:
+ *
+ *     static constexpr uint32_t reads  = FIELD_...;   // Čtená pole DIFPGrid (FieldMask)
+ *     static constexpr uint32_t writes = FIELD_...;   // Zapisovaná pole
+ *     static constexpr bool tile_local = true/false;
+ *
+ *     // tile_local == true: buňky [begin, end) závisí jen na buňkách [begin, end)
+ *     void apply_tile(DIFPGrid<double>& grid, size_t begin, size_t end, double dt);
+ *
+ *     // tile_local == false: globální operátor (sousedé, řešič soustavy, ...)
+ *     void apply(DIFPGrid<double>& grid, double dt);
+ *
+ * Po sobě jdoucí lokální operátory se sloučí do jednoho průchodu po dlaždicích:
+ * dlaždice projde celou sekvencí, dokud je v cache, místo jednoho průchodu mřížkou
+ * na každý operátor. Globální operátor sekvenci přeruší a běží samostatně.
+ */
+
+enum class SplittingScheme {
+    Lie,    // A(dt) B(dt) C(dt): 1. řád
+    Strang, // A(dt/2) B(dt/2) C(dt) B(dt/2) A(dt/2): 2. řád
+};
+
+/**
+ * @class SplittingStepper
+ * @brief Sestaví plán průchodů ze sekvence dílčích operátorů a provádí kroky.
+ */
+template <typename... Ops>
+class SplittingStepper {
+    static_assert(sizeof...(Ops) > 0, "SplittingStepper potrebuje alespon jeden operator.");
+
+public:
+    struct Stage {
+        size_t op;       // Index operátoru v Ops...
+        double fraction; // Podíl kroku dt
+    };
+
+    struct Pass {
+        bool fused;                // Průchod po dlaždicích (jen lokální operátory)
+        std::vector<Stage> stages;
+    };
+
+private:
+    std::tuple<Ops...> ops;
+    std::vector<Pass> plan;
+    size_t tile_cells;
+
+    static constexpr bool local_flags[] = {Ops::tile_local...};
+    static constexpr uint32_t read_masks[] = {Ops::reads...};
+    static constexpr uint32_t write_masks[] = {Ops::writes...};
+
+    // Zavolá f(std::get<I>(ops)) pro I == index
+    template <typename F, size_t... Is>
+    void visit(size_t index, F&& f, std::index_sequence<Is...>) {
+        ((index == Is ? (void)f(std::get<Is>(ops)) : (void)0), ...);
+    }
+
+    template <typename F>
+    void visit(size_t index, F&& f) {
+        visit(index, std::forward<F>(f), std::index_sequence_for<Ops...>{});
+    }
+
+    void build_plan(SplittingScheme scheme, bool fuse) {
+        const size_t n = sizeof...(Ops);
+        std::vector<Stage> sequence;
+        if (scheme == SplittingScheme::Lie || n == 1) {
+            for (size_t i = 0; i < n; ++i) sequence.push_back({i, 1.0});
+        } else {
+            for (size_t i = 0; i + 1 < n; ++i) sequence.push_back({i, 0.5});
+            sequence.push_back({n - 1, 1.0});
+            for (size_t i = n - 1; i-- > 0;) sequence.push_back({i, 0.5});
+        }
+
+        for (const Stage& stage : sequence) {
+            const bool local = fuse && local_flags[stage.op];
+            if (local && !plan.empty() && plan.back().fused) {
+                plan.back().stages.push_back(stage);
+            } else {
+                plan.push_back({local, {stage}});
+            }
+        }
+    }
+
+public:
+    /**
+     * @param scheme Lie nebo Strang.
+     * @param tile Počet buněk dlaždice sloučeného průchodu (násobek 8 kvůli zarovnání).
+     * @param fuse false = každý operátor samostatným průchodem (pro srovnání).
+     */
+    explicit SplittingStepper(SplittingScheme scheme, Ops... operators, size_t tile = 4096, bool fuse = true)
+        : ops(std::move(operators)...), tile_cells(tile) {
+        if (tile_cells == 0 || tile_cells % 8 != 0) {
+            throw std::invalid_argument("SplittingStepper: tile size must be a positive multiple of 8.");
+        }
+        build_plan(scheme, fuse);
+    }
+
+    [[nodiscard]] const std::vector<Pass>& passes() const { return plan; }
+
+    template <size_t I>
+    auto& op() { return std::get<I>(ops); }
+
+    /**
+     * @brief Odhad paměťového provozu jednoho kroku (bajty).
+     * @details Sloučený průchod čte sjednocení čtených polí a zapisuje sjednocení
+     *          zapisovaných polí jednou; samostatný průchod za každý operátor zvlášť.
+     */
+    [[nodiscard]] size_t traffic_bytes(const DIFPGrid<double>& grid) const {
+        size_t fields = 0;
+        for (const Pass& pass : plan) {
+            if (pass.fused) {
+                uint32_t r = 0, w = 0;
+                for (const Stage& s : pass.stages) {
+                    r |= read_masks[s.op];
+                    w |= write_masks[s.op];
+                }
+                fields += field_count(r | w) + field_count(w);
+            } else {
+                for (const Stage& s : pass.stages) {
+                    fields += field_count(read_masks[s.op] | write_masks[s.op]) + field_count(write_masks[s.op]);
+                }
+            }
+        }
+        return fields * grid.get_compute_size() * sizeof(double);
+    }
+
+    void step(DIFPGrid<double>& grid, double dt) {
+        const size_t N = grid.get_compute_size();
+        const size_t n_tiles = (N + tile_cells - 1) / tile_cells;
+
+        for (const Pass& pass : plan) {
+            if (!pass.fused) {
+                for (const Stage& s : pass.stages) {
+                    visit(s.op, [&](auto& op) {
+                        if constexpr (std::decay_t<decltype(op)>::tile_local) {
+                            op.apply_tile(grid, 0, N, dt * s.fraction);
+                        } else {
+                            op.apply(grid, dt * s.fraction);
+                        }
+                    });
+                }
+                continue;
+            }
+
+            #pragma omp parallel for schedule(static)
+            for (size_t t = 0; t < n_tiles; ++t) {
+                const size_t begin = t * tile_cells;
+                const size_t end = std::min(N, begin + tile_cells);
+                for (const Stage& s : pass.stages) {
+                    visit(s.op, [&](auto& op) {
+                        if constexpr (std::decay_t<decltype(op)>::tile_local) {
+                            op.apply_tile(grid, begin, end, dt * s.fraction);
+                        }
+                    });
+                }
+            }
+        }
+    }
+};
+
+#endif // DIFP_OPERATOR_SPLITTING_HPP
@@ -0,0 +1,209 @@
+#include "parameter_sweep.hpp"
+#include "io/field_image.hpp"
+#include <atomic>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Čítač běhů leží i ve sdílené paměti mezi procesy: musí být lock-free, ne mutex v procesu
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Sweep potrebuje lock-free 64bit atomiku.");
+
+void execute(const SweepConfig& config, const FieldImage& image, const SweepBody& body, size_t run,
+             uint32_t worker, SweepRecord& record) {
+    record.worker = worker;
+    auto t0 = std::chrono::steady_clock::now();
+    try {
+        DIFPGrid<double> grid = image.map_private(config.written_fields);
+        record.setup_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        body(config.points[run], grid, record.metrics);
+        record.ok = 1;
+    } catch (...) {
+        record.ok = 0;
+    }
+    record.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void run_threads(const SweepConfig& config, const FieldImage& image, const SweepBody& body,
+                 std::vector<SweepRecord>& records, size_t workers) {
+    std::atomic<uint64_t> next{0};
+    const size_t runs = records.size();
+    #pragma omp parallel num_threads(static_cast<int>(workers))
+    {
+        uint32_t worker = 0;
+#ifdef _OPENMP
+        worker = static_cast<uint32_t>(omp_get_thread_num());
+#endif
+        for (uint64_t r; (r = next.fetch_add(1, std::memory_order_relaxed)) < runs;) {
+            execute(config, image, body, r, worker, records[r]);
+        }
+    }
+}
+
+#ifndef _WIN32
+// Vrací počet procesů, které se podařilo spustit
+size_t run_processes(const SweepConfig& config, const FieldImage& image, const SweepBody& body,
+                     std::vector<SweepRecord>& records, size_t workers) {
+    // [čítač, doplněno na řádek cache] [records]
+    const size_t runs = records.size();
+    const size_t bytes = CACHE_LINE_BYTES + runs * sizeof(SweepRecord);
+    void* shared = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) throw std::runtime_error("run_parameter_sweep: cannot map shared memory.");
+    auto* next = new (shared) std::atomic<uint64_t>(0);
+    auto* shared_records = reinterpret_cast<SweepRecord*>(static_cast<uint8_t*>(shared) + CACHE_LINE_BYTES);
+    std::copy(records.begin(), records.end(), shared_records);
+
+    // Jinak by každý potomek zdědil a znovu vypsal nevyprázdněné buffery stdio
+    std::fflush(nullptr);
+    std::vector<pid_t> children;
+    for (size_t w = 0; w < workers; ++w) {
+        const pid_t pid = fork();
+        if (pid < 0) break;
+        if (pid == 0) {
+            for (uint64_t r; (r = next->fetch_add(1, std::memory_order_relaxed)) < runs;) {
+                execute(config, image, body, r, static_cast<uint32_t>(w), shared_records[r]);
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    }
+
+    // Běh rozpracovaný v procesu, který spadl, zůstane ok = 0
+    std::copy(shared_records, shared_records + runs, records.begin());
+    munmap(shared, bytes);
+    if (children.empty()) throw std::runtime_error("run_parameter_sweep: fork() failed.");
+    return children.size();
+}
+#endif
+
+} // namespace
+
+SweepResult run_parameter_sweep(const SweepConfig& config, const SweepBody& body) {
+    if (config.metric_names.size() > SWEEP_MAX_METRICS) {
+        throw std::invalid_argument("run_parameter_sweep: too many metrics.");
+    }
+    for (const std::vector<double>& p : config.points) {
+        if (!config.parameter_names.empty() && p.size() != config.parameter_names.size()) {
+            throw std::invalid_argument("run_parameter_sweep: point size differs from parameter_names.");
+        }
+    }
+    FieldImage image;
+    if (!image.open(config.initial_path)) {
+        throw std::invalid_argument("run_parameter_sweep: cannot open field image " + config.initial_path);
+    }
+
+    SweepResult result;
+    result.parameter_names = config.parameter_names;
+    result.points = config.points;
+    result.metric_names = config.metric_names;
+
+    const size_t runs = config.points.size();
+    result.records.resize(runs);
+    for (size_t r = 0; r < runs; ++r) {
+        SweepRecord& rec = result.records[r];
+        rec = SweepRecord{};
+        rec.run = r;
+        for (double& m : rec.metrics) m = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    size_t workers = config.workers;
+#ifdef _OPENMP
+    if (workers == 0) workers = static_cast<size_t>(omp_get_max_threads());
+#endif
+    workers = std::max<size_t>(1, std::min(workers, std::max<size_t>(runs, 1)));
+
+    auto t0 = std::chrono::steady_clock::now();
+#ifndef _WIN32
+    if (config.mode == SweepMode::Processes && runs > 0) {
+        workers = run_processes(config, image, body, result.records, workers);
+    } else {
+        run_threads(config, image, body, result.records, workers);
+    }
+#else
+    run_threads(config, image, body, result.records, workers);
+#endif
+    result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    result.workers = workers;
+    for (const SweepRecord& rec : result.records) result.failed += rec.ok ? 0 : 1;
+    return result;
+}
+
+std::vector<SweepSummary> SweepResult::summarize() const {
+    std::vector<SweepSummary> out(metric_names.size());
+    for (size_t m = 0; m < metric_names.size(); ++m) {
+        SweepSummary& s = out[m];
+        s.metric = metric_names[m];
+        size_t count = 0;
+        for (const SweepRecord& rec : records) {
+            if (!rec.ok) continue;
+            const double v = rec.metrics[m];
+            if (count == 0 || v < s.min) s.min = v, s.argmin = rec.run;
+            if (count == 0 || v > s.max) s.max = v, s.argmax = rec.run;
+            s.mean += v;
+            ++count;
+        }
+        if (count) s.mean /= double(count);
+    }
+    return out;
+}
+
+void SweepResult::write_csv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("SweepResult: cannot open " + path);
+    out << "run,worker,ok,setup_seconds,seconds";
+    const size_t params = points.empty() ? 0 : points.front().size();
+    for (size_t p = 0; p < params; ++p) {
+        if (p < parameter_names.size()) {
+            out << ',' << parameter_names[p];
+        } else {
+            out << ",p" << p;
+        }
+    }
+    for (const std::string& m : metric_names) out << ',' << m;
+    out << '\n' << std::setprecision(10);
+    for (const SweepRecord& rec : records) {
+        out << rec.run << ',' << rec.worker << ',' << rec.ok << ',' << rec.setup_seconds << ',' << rec.seconds;
+        for (double v : points[rec.run]) out << ',' << v;
+        for (size_t m = 0; m < metric_names.size(); ++m) out << ',' << rec.metrics[m];
+        out << '\n';
+    }
+    if (!out) throw std::runtime_error("SweepResult: write failed for " + path);
+}
+
+std::vector<std::vector<double>> sweep_grid(const std::vector<std::vector<double>>& axes) {
+    std::vector<std::vector<double>> points(1);
+    for (const std::vector<double>& axis : axes) {
+        std::vector<std::vector<double>> next;
+        next.reserve(points.size() * axis.size());
+        for (const std::vector<double>& p : points) {
+            for (double v : axis) {
+                next.push_back(p);
+                next.back().push_back(v);
+            }
+        }
+        points = std::move(next);
+    }
+    return axes.empty() ? std::vector<std::vector<double>>{} : points;
+}
@@ -0,0 +1,96 @@
+#ifndef DIFP_PARAMETER_SWEEP_HPP
+#define DIFP_PARAMETER_SWEEP_HPP
+
+#include "DIFP_Core.hpp"
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Parametrický sweep: stejný počáteční stav, mnoho běhů s různými parametry.
+ *
+ * Počáteční stav se jednou zapíše jako obraz paměti (write_field_image) a každý běh
+ * dostane vlastní copy-on-write mapování (FieldImage::map_private): nic se nenačítá
+ * ani nekopíruje předem, stránky, které běh jen čte, sdílí všechny běhy v page cache
+ * a jádro zkopíruje jen ty, do kterých běh zapíše. Běhy si berou pracovníci dynamicky
+ * (atomický čítač), takže nestejně dlouhé běhy nevadí. Pracovníci jsou vlákna, nebo
+ * procesy (fork) s čítačem a výsledky ve sdílené anonymní paměti – pád jednoho běhu
+ * pak nesmaže ostatní.
+ */
+
+constexpr size_t SWEEP_MAX_METRICS = 8;
+
+enum class SweepMode {
+    Threads,   // OpenMP vlákna v tomto procesu
+    Processes, // Procesy přes fork() (bez POSIX se použijí vlákna)
+};
+
+/**
+ * @struct SweepRecord
+ * @brief Výsledek jednoho běhu (POD, zapisuje ho i proces pracovníka do sdílené paměti).
+ */
+struct SweepRecord {
+    uint64_t run;
+    uint32_t worker;
+    uint32_t ok;                         // 0 = běh vyhodil výjimku nebo proces spadl
+    double setup_seconds;                // Namapování počátečního stavu
+    double seconds;                      // Namapování + tělo běhu
+    double metrics[SWEEP_MAX_METRICS];
+};
+
+struct SweepConfig {
+    std::string initial_path;                // Obraz počátečního stavu (write_field_image)
+    std::vector<std::string> parameter_names;
+    std::vector<std::vector<double>> points; // Parametry běhů (viz sweep_grid)
+    std::vector<std::string> metric_names;   // Nejvýše SWEEP_MAX_METRICS
+    uint32_t written_fields = FIELD_POTENTIAL | FIELD_VX | FIELD_VY; // Viz FieldImage::map_private
+    size_t workers = 0;                      // 0 = omp_get_max_threads()
+    SweepMode mode = SweepMode::Threads;
+};
+
+/**
+ * @brief Tělo běhu: grid je soukromá kopie počátečního stavu (lze ji libovolně měnit),
+ *        do metrics zapíše metric_names.size() hodnot. Výjimka označí běh jako neúspěšný.
+ * @details V režimu Processes běží v procesu po fork(): nesmí spoléhat na stav sdílený
+ *          s rodičem (vše kromě návratových metrik zůstane v procesu pracovníka) a nemá
+ *          otevírat OpenMP paralelní oblasti.
+ */
+using SweepBody = std::function<void(const std::vector<double>& parameters, DIFPGrid<double>& grid, double* metrics)>;
+
+struct SweepSummary {
+    std::string metric;
+    double mean = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    size_t argmin = 0; // Index běhu
+    size_t argmax = 0;
+};
+
+struct SweepResult {
+    std::vector<std::string> parameter_names;
+    std::vector<std::vector<double>> points;
+    std::vector<std::string> metric_names;
+    std::vector<SweepRecord> records; // V pořadí běhů
+    double wall_seconds = 0.0;
+    size_t workers = 0;
+    size_t failed = 0;
+
+    // Statistika metrik přes úspěšné běhy
+    [[nodiscard]] std::vector<SweepSummary> summarize() const;
+
+    // CSV: run,worker,ok,setup_seconds,seconds,<parametry>,<metriky> (throws při chybě zápisu)
+    void write_csv(const std::string& path) const;
+};
+
+/**
+ * @brief Spustí všechny běhy. Neplatná konfigurace nebo obraz -> std::invalid_argument,
+ *        selhání fork()/sdílené paměti -> std::runtime_error.
+ */
+SweepResult run_parameter_sweep(const SweepConfig& config, const SweepBody& body);
+
+// Kartézský součin os (první osa se mění nejpomaleji)
+std::vector<std::vector<double>> sweep_grid(const std::vector<std::vector<double>>& axes);
+
+#endif // DIFP_PARAMETER_SWEEP_HPP
@@ -0,0 +1,117 @@
+#include "parareal.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+// result = f + (g - g_old) pro vyvíjená pole; vrací max |result - previous|.
+// Závorky nejsou náhoda: v přesném okně je g == g_old a výsledek je bitově f.
+double parareal_update(const DIFPGrid<double>& g, const DIFPGrid<double>& f, const DIFPGrid<double>& g_old,
+                       DIFPGrid<double>& result) {
+    const size_t N = result.get_compute_size();
+    double residual = 0.0;
+
+    const double* const g_fields[3] = {g.potential, g.vx, g.vy};
+    const double* const f_fields[3] = {f.potential, f.vx, f.vy};
+    const double* const o_fields[3] = {g_old.potential, g_old.vx, g_old.vy};
+    double* const r_fields[3] = {result.potential, result.vx, result.vy};
+
+    for (int field = 0; field < 3; ++field) {
+        const double* __restrict gp = g_fields[field];
+        const double* __restrict fp = f_fields[field];
+        const double* __restrict op = o_fields[field];
+        double* __restrict rp = r_fields[field];
+
+        #pragma omp simd aligned(gp, fp, op, rp : 64) reduction(max : residual)
+        for (size_t i = 0; i < N; ++i) {
+            double updated = fp[i] + (gp[i] - op[i]);
+            residual = std::max(residual, std::fabs(updated - rp[i]));
+            rp[i] = updated;
+        }
+    }
+    return residual;
+}
+
+} // namespace
+
+PararealDriver::PararealDriver(const PararealConfig& cfg) : config(cfg) {
+    if (config.slices == 0 || config.fine_steps_per_slice == 0 || config.coarse_steps_per_slice == 0) {
+        throw std::invalid_argument("PararealDriver: slices and step counts must be positive.");
+    }
+    if (config.max_iterations == 0 || config.max_iterations > config.slices) {
+        config.max_iterations = config.slices;
+    }
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    solvers.resize(static_cast<size_t>(threads));
+}
+
+void PararealDriver::propagate(RK4Solver& solver, DIFPGrid<double>& state, size_t steps, double dt) {
+    for (size_t s = 0; s < steps; ++s) solver.step(state, dt);
+}
+
+PararealReport PararealDriver::run(DIFPGrid<double>& grid, double t_span) {
+    const size_t N = config.slices;
+    const double slice_span = t_span / static_cast<double>(N);
+    const double dt_fine = slice_span / static_cast<double>(config.fine_steps_per_slice);
+    const double dt_coarse = slice_span / static_cast<double>(config.coarse_steps_per_slice);
+
+    PararealReport report;
+
+    // Buffery se alokují jen při první úloze nebo změně velikosti mřížky
+    if (boundary.size() != N + 1 || boundary[0].active_size != grid.active_size) {
+        boundary.assign(N + 1, grid);
+        fine.assign(N, grid);
+        coarse.assign(N, grid);
+    }
+
+    // Počáteční odhad: sériový hrubý průchod
+    boundary[0] = grid;
+    for (size_t n = 0; n < N; ++n) {
+        coarse[n] = boundary[n];
+        propagate(coarse_solver, coarse[n], config.coarse_steps_per_slice, dt_coarse);
+        boundary[n + 1] = coarse[n];
+    }
+
+    DIFPGrid<double> g_new = grid;
+    for (size_t k = 0; k < config.max_iterations; ++k) {
+        // 1) Jemný propagátor ve všech nepřesných oknech současně
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t n = k; n < N; ++n) {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            fine[n] = boundary[n];
+            propagate(solvers[static_cast<size_t>(tid)], fine[n], config.fine_steps_per_slice, dt_fine);
+        }
+
+        // 2) Sériová oprava hrubým propagátorem
+        //    Okno k je po této iteraci přesné: U[k+1] = F(U[k])
+        double residual = 0.0;
+        for (size_t n = k; n < N; ++n) {
+            g_new = boundary[n];
+            propagate(coarse_solver, g_new, config.coarse_steps_per_slice, dt_coarse);
+            residual = std::max(residual, parareal_update(g_new, fine[n], coarse[n], boundary[n + 1]));
+            std::swap(coarse[n], g_new);
+        }
+
+        report.iterations = k + 1;
+        report.residuals.push_back(residual);
+        if (residual <= config.tolerance) {
+            report.converged = true;
+            break;
+        }
+    }
+    if (report.iterations == N) report.converged = true; // Všechna okna přesná
+
+    grid = boundary[N];
+    return report;
+}
@@ -0,0 +1,64 @@
+#ifndef DIFP_PARAREAL_HPP
+#define DIFP_PARAREAL_HPP
+
+#include "DIFP_Core.hpp"
+#include "rk4_solver.hpp"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @struct PararealConfig
+ * @brief Nastavení paralelní integrace v čase.
+ */
+struct PararealConfig {
+    size_t slices = 8;                  // Počet časových oken (typicky = počet jader)
+    size_t fine_steps_per_slice = 100;  // Jemný propagátor F: kroků RK4 na okno
+    size_t coarse_steps_per_slice = 1;  // Hrubý propagátor G: kroků RK4 na okno
+    size_t max_iterations = 0;          // 0 = nejvýše slices (pak je výsledek přesný)
+    double tolerance = 1e-10;           // Max-norma změny stavu mezi iteracemi
+};
+
+/**
+ * @struct PararealReport
+ * @brief Průběh konvergence.
+ */
+struct PararealReport {
+    size_t iterations = 0;
+    bool converged = false;
+    std::vector<double> residuals; // Max-norma opravy po každé iteraci
+};
+
+/**
+ * @class PararealDriver
+ * @brief Parareal: jemné RK4 běží ve všech časových oknech současně.
+ * @details Iterace k:  U[n+1] = G(U_new[n]) + F(U_old[n]) - G(U_old[n]).
+ *          Drahé F(U[n]) se počítá paralelně přes okna (OpenMP), levné G sériově.
+ *          Po k iteracích je prvních k oken přesných, F se pro ně už nepočítá znovu.
+ *          Po 'slices' iteracích je výsledek bitově shodný se sériovým jemným během.
+ *          Vyvíjená pole jsou potential, vx, vy; mass a friction jsou parametry.
+ */
+class PararealDriver {
+private:
+    PararealConfig config;
+
+    // Stav v hranicích oken U[0..N], hodnoty F(U[n]) a G(U[n]) z minulé iterace
+    std::vector<DIFPGrid<double>> boundary;
+    std::vector<DIFPGrid<double>> fine;
+    std::vector<DIFPGrid<double>> coarse;
+
+    // Jeden solver (se scratch buffery) na vlákno
+    std::vector<RK4Solver> solvers;
+    RK4Solver coarse_solver;
+
+    void propagate(RK4Solver& solver, DIFPGrid<double>& state, size_t steps, double dt);
+
+public:
+    explicit PararealDriver(const PararealConfig& cfg);
+
+    /**
+     * @brief Integruje grid přes časový interval t_span (na místě).
+     */
+    PararealReport run(DIFPGrid<double>& grid, double t_span);
+};
+
+#endif // DIFP_PARAREAL_HPP
@@ -0,0 +1,29 @@
+#ifndef DIFP_PHYSICS_KERNEL_HPP
+#define DIFP_PHYSICS_KERNEL_HPP
+
+/**
+ * Fyzikální jádro po buňkách: vlnová rovnice s tlumením.
+ * Sdílí ho všechny integrátory (RK4Solver, ETDRK4Solver, ...), aby se fyzika
+ * definovala na jediném místě. Inline funkce -> volající smyčky zůstávají vektorizované.
+ *
+ *   d pot / dt = -(vx + vy)
+ *   d vx  / dt = -pot / m - f * vx
+ *   d vy  / dt = -pot / m - f * vy
+ */
+inline void damped_wave_rhs(double pot, double vx, double vy, double mass, double fric,
+                            double& d_pot, double& d_vx, double& d_vy) {
+    // 1. Změna potenciálu (např. div(v))
+    // Poznámka: Pro skutečnou derivaci (gradient) by zde byl přístup k sousedům (i-1, i+1).
+    // Pro demonstraci vektorizace děláme lokální operaci.
+    d_pot = -(vx + vy);
+
+    // 2. Změna hybnosti (Newtonův zákon: F = ma -> a = F/m)
+    // Síla je gradient potenciálu (zde zjednodušeno) - tření
+    double force_x = -pot;
+    double force_y = -pot;
+
+    d_vx = (force_x / mass) - (fric * vx);
+    d_vy = (force_y / mass) - (fric * vy);
+}
+
+#endif // DIFP_PHYSICS_KERNEL_HPP
@@ -1,31 +1,58 @@
 #include "../include/DIFP_Core.hpp"
 #include "rk4_solver.hpp"
+#include "physics_kernel.hpp"
 #include <omp.h> // Pro #pragma omp simd
 #include <cmath>
+#include <algorithm>
+#include <stdexcept>
 
 // Inicializace bufferů, pokud se změnila velikost simulace
 void RK4Solver::ensure_buffers(const DIFPGrid<double>& grid) {
-    if (k1.active_size!= grid.active_size) {
-        // Využíváme move sémantiku pro efektivní realokaci
-        k1 = DIFPGrid<double>(grid.width, grid.height);
-        k2 = DIFPGrid<double>(grid.width, grid.height);
-        k3 = DIFPGrid<double>(grid.width, grid.height);
-        k4 = DIFPGrid<double>(grid.width, grid.height);
-        temp_state = DIFPGrid<double>(grid.width, grid.height);
+    if (k1.active_size!= grid.active_size || k1.field_layout() != grid.field_layout()) {
+        if (buffers_locked) {
+            throw std::logic_error("RK4Solver: grid size differs from prepare(); step() would reallocate.");
+        }
+        // Využíváme move sémantiku pro efektivní realokaci.
+        // Sloty 1..5 posunou buffery vůči hlavní mřížce (slot 0) i mezi sebou (viz FieldLayout).
+        const FieldLayout mode = grid.field_layout();
+        k1 = DIFPGrid<double>(grid.width, grid.height, mode, 1);
+        k2 = DIFPGrid<double>(grid.width, grid.height, mode, 2);
+        k3 = DIFPGrid<double>(grid.width, grid.height, mode, 3);
+        k4 = DIFPGrid<double>(grid.width, grid.height, mode, 4);
+        temp_state = DIFPGrid<double>(grid.width, grid.height, mode, 5);
     }
 }
 
+void RK4Solver::prepare(const DIFPGrid<double>& grid, bool lock) {
+    buffers_locked = false;
+    ensure_buffers(grid);
+    buffers_locked = lock;
+}
+
+size_t RK4Solver::memory_bytes() const {
+    return k1.footprint().total() + k2.footprint().total() + k3.footprint().total() + k4.footprint().total() +
+           temp_state.footprint().total();
+}
+
+size_t RK4Solver::memory_bytes_for(size_t w, size_t h, FieldLayout mode) {
+    size_t bytes = 0;
+    for (unsigned slot = 1; slot <= 5; ++slot) bytes += DIFPGrid<double>::footprint_for(w, h, mode, slot).total();
+    return bytes;
+}
+
 // Fyzikální jádro (Kernel)
 // Příklad: Jednoduchá vlnová rovnice s tlumením
-void RK4Solver::compute_physics_derivatives(const DIFPGrid<double>& in, DIFPGrid<double>& out) {
+void RK4Solver::compute_physics_derivatives(const DIFPGrid<double>& in, const DIFPGrid<double>& params,
+                                            DIFPGrid<double>& out) {
     size_t N = in.get_compute_size(); // Zarovnaná velikost pro AVX
 
     // Načtení pointerů pro kompilátor (zaručujeme, že se nepřekrývají)
     const double* __restrict pot = in.potential;
     const double* __restrict vx  = in.vx;
     const double* __restrict vy  = in.vy;
-    const double* __restrict mass = in.mass;
-    const double* __restrict fric = in.friction;
+    // Parametry z mřížky kroku: mezistav je nenese (žádná kopie mass/friction v každém kroku)
+    const double* __restrict mass = params.mass;
+    const double* __restrict fric = params.friction;
 
     double* __restrict d_pot = out.potential;
     double* __restrict d_vx  = out.vx;
@@ -35,18 +62,7 @@ void RK4Solver::compute_physics_derivatives(const DIFPGrid<double>& in, DIFPGrid
     // aligned: Říkáme kompilátoru, že všechny pointery začínají na 64-byte hranici
     #pragma omp simd aligned(pot, vx, vy, mass, fric, d_pot, d_vx, d_vy : 64)
     for (size_t i = 0; i < N; ++i) {
-        // 1. Změna potenciálu (např. div(v))
-        // Poznámka: Pro skutečnou derivaci (gradient) by zde byl přístup k sousedům (i-1, i+1).
-        // Pro demonstraci vektorizace děláme lokální operaci.
-        d_pot[i] = -(vx[i] + vy[i]); 
-
-        // 2. Změna hybnosti (Newtonův zákon: F = ma -> a = F/m)
-        // Síla je gradient potenciálu (zde zjednodušeno) - tření
-        double force_x = -pot[i]; 
-        double force_y = -pot[i];
-
-        d_vx[i] = (force_x / mass[i]) - (fric[i] * vx[i]);
-        d_vy[i] = (force_y / mass[i]) - (fric[i] * vy[i]);
+        damped_wave_rhs(pot[i], vx[i], vy[i], mass[i], fric[i], d_pot[i], d_vx[i], d_vy[i]);
     }
 }
 
@@ -65,49 +81,22 @@ void RK4Solver::accumulate_step(const DIFPGrid<double>& state, const DIFPGrid<do
     const double* __restrict k_vx = k.vx;
     double* __restrict r_vx = result.vx;
 
-    //... a tak dále pro všechna pole...
+    const double* __restrict s_vy = state.vy;
+    const double* __restrict k_vy = k.vy;
+    double* __restrict r_vy = result.vy;
 
-    #pragma omp simd aligned(s_pot, k_pot, r_pot, s_vx, k_vx, r_vx : 64)
+    // mass, friction a pressure se nevyvíjejí (čtou se z hlavní mřížky kroku)
+
+    #pragma omp simd aligned(s_pot, k_pot, r_pot, s_vx, k_vx, r_vx, s_vy, k_vy, r_vy : 64)
     for (size_t i = 0; i < N; ++i) {
         r_pot[i] = s_pot[i] + scale * k_pot[i];
         r_vx[i]  = s_vx[i]  + scale * k_vx[i];
-        //...
+        r_vy[i]  = s_vy[i]  + scale * k_vy[i];
     }
 }
 
-// Hlavní krok RK4
+// Hlavní krok RK4 bez instrumentace (tělo viz šablona v rk4_solver.hpp)
 void RK4Solver::step(DIFPGrid<double>& grid, double dt) {
-    ensure_buffers(grid);
-
-    // K1 = f(t, y)
-    compute_physics_derivatives(grid, k1);
-
-    // K2 = f(t + dt/2, y + dt/2 * k1)
-    accumulate_step(grid, k1, dt * 0.5, temp_state); // temp = y + k1*dt/2
-    compute_physics_derivatives(temp_state, k2);
-
-    // K3 = f(t + dt/2, y + dt/2 * k2)
-    accumulate_step(grid, k2, dt * 0.5, temp_state); // temp = y + k2*dt/2
-    compute_physics_derivatives(temp_state, k3);
-
-    // K4 = f(t + dt, y + dt * k3)
-    accumulate_step(grid, k3, dt, temp_state);       // temp = y + k3*dt
-    compute_physics_derivatives(temp_state, k4);
-
-    // Finální integrace: y = y + (dt/6) * (k1 + 2*k2 + 2*k3 + k4)
-    size_t N = grid.get_compute_size();
-    double* __restrict pot = grid.potential;
-    double* __restrict vx  = grid.vx;
-    //... pointery pro k1..k4...
-    
-    double dt_6 = dt / 6.0;
-
-    // Finální smyčka - kompilátor zde vygeneruje FMA instrukce (Fused Multiply-Add)
-    #pragma omp simd aligned(pot, vx : 64) 
-    for (size_t i = 0; i < N; ++i) {
-        // Přímý přístup do pre-alokovaných mřížek k1..k4
-        pot[i] += dt_6 * (k1.potential[i] + 2*k2.potential[i] + 2*k3.potential[i] + k4.potential[i]);
-        vx[i]  += dt_6 * (k1.vx[i]        + 2*k2.vx[i]        + 2*k3.vx[i]        + k4.vx[i]);
-        //... analogicky pro ostatní pole
-    }
-}
\ No newline at end of file
+    NullObserver none;
+    step(grid, dt, none);
+}
@@ -2,6 +2,7 @@
 #define DIFP_RK4_SOLVER_HPP
 
 #include "DIFP_Core.hpp"
+#include "DIFP_Observers.hpp"
 #include <vector>
 
 class RK4Solver {
@@ -10,15 +11,20 @@ private:
     // k1..k4 ukládají derivace (dx/dt)
     DIFPGrid<double> k1, k2, k3, k4;
     
-    // Mřížka pro průběžný stav (state + dt*k)
+    // Mřížka pro průběžný stav (state + dt*k); nese jen potential, vx, vy –
+    // parametry (mass, friction) se čtou z hlavní mřížky kroku
     DIFPGrid<double> temp_state;
 
+    // Zamčené buffery: realokace v step() je chyba, ne tichá alokace (viz prepare())
+    bool buffers_locked = false;
+
     // Zjistí, zda je potřeba realokovat buffery
     void ensure_buffers(const DIFPGrid<double>& main_grid);
 
-    // Jádro fyzikálního výpočtu: d_out = f(t, state_in)
+    // Jádro fyzikálního výpočtu: d_out = f(t, state_in) s parametry (mass, friction) z params
     // Toto je "stencil" operace, která počítá síly a toky
-    void compute_physics_derivatives(const DIFPGrid<double>& state_in, DIFPGrid<double>& d_out);
+    void compute_physics_derivatives(const DIFPGrid<double>& state_in, const DIFPGrid<double>& params,
+                                     DIFPGrid<double>& d_out);
 
     // Pomocná metoda pro akumulaci: result = state + scale * k
     void accumulate_step(const DIFPGrid<double>& state, const DIFPGrid<double>& k, 
@@ -27,8 +33,81 @@ private:
 public:
     RK4Solver() : k1(0,0), k2(0,0), k3(0,0), k4(0,0), temp_state(0,0) {}
 
+    /**
+     * @brief Předem alokuje pomocné mřížky pro mřížku dané velikosti.
+     * @details S lock = true je ustálený stav step() bez alokací vynucený: krok na mřížce
+     *          jiné velikosti vyhodí std::logic_error místo realokace pěti mřížek uprostřed běhu.
+     */
+    void prepare(const DIFPGrid<double>& grid, bool lock = true);
+
+    // Povolí znovu automatickou realokaci v step()
+    void unlock_buffers() { buffers_locked = false; }
+
+    // Paměť pomocných mřížek (k1..k4, temp_state) a odhad pro mřížku w x h
+    [[nodiscard]] size_t memory_bytes() const;
+    [[nodiscard]] static size_t memory_bytes_for(size_t w, size_t h, FieldLayout mode = FieldLayout::Staggered);
+
     // Hlavní metoda, kterou volá smyčka simulace
     void step(DIFPGrid<double>& grid, double dt);
+
+    // Totéž s pozorovatelem vloženým do kroku (viz DIFP_Observers.hpp)
+    template <typename Observer>
+    void step(DIFPGrid<double>& grid, double dt, Observer& observer);
 };
 
+// Hlavní krok RK4
+template <typename Observer>
+void RK4Solver::step(DIFPGrid<double>& grid, double dt, Observer& observer) {
+    ensure_buffers(grid);
+    observer.on_step_begin(grid, dt);
+
+    // K1 = f(t, y)
+    compute_physics_derivatives(grid, grid, k1);
+    observer.on_stage(1, grid, k1);
+
+    // K2 = f(t + dt/2, y + dt/2 * k1)
+    accumulate_step(grid, k1, dt * 0.5, temp_state); // temp = y + k1*dt/2
+    compute_physics_derivatives(temp_state, grid, k2);
+    observer.on_stage(2, temp_state, k2);
+
+    // K3 = f(t + dt/2, y + dt/2 * k2)
+    accumulate_step(grid, k2, dt * 0.5, temp_state); // temp = y + k2*dt/2
+    compute_physics_derivatives(temp_state, grid, k3);
+    observer.on_stage(3, temp_state, k3);
+
+    // K4 = f(t + dt, y + dt * k3)
+    accumulate_step(grid, k3, dt, temp_state);       // temp = y + k3*dt
+    compute_physics_derivatives(temp_state, grid, k4);
+    observer.on_stage(4, temp_state, k4);
+
+    // Finální integrace: y = y + (dt/6) * (k1 + 2*k2 + 2*k3 + k4)
+    size_t N = grid.get_compute_size();
+    double* __restrict pot = grid.potential;
+    double* __restrict vx  = grid.vx;
+    double* __restrict vy  = grid.vy;
+
+    double dt_6 = dt / 6.0;
+
+    // Přímý přístup do pre-alokovaných mřížek k1..k4
+    auto update = [&](size_t i) {
+        pot[i] += dt_6 * (k1.potential[i] + 2*k2.potential[i] + 2*k3.potential[i] + k4.potential[i]);
+        vx[i]  += dt_6 * (k1.vx[i]        + 2*k2.vx[i]        + 2*k3.vx[i]        + k4.vx[i]);
+        vy[i]  += dt_6 * (k1.vy[i]        + 2*k2.vy[i]        + 2*k3.vy[i]        + k4.vy[i]);
+    };
+
+    if constexpr (!observes_cells<Observer>) {
+        // Finální smyčka - kompilátor zde vygeneruje FMA instrukce (Fused Multiply-Add)
+        #pragma omp simd aligned(pot, vx, vy : 64)
+        for (size_t i = 0; i < N; ++i) update(i);
+    } else {
+        // Pozorovatel se stavem: omp simd by slibovalo, že mezi iteracemi není závislost
+        for (size_t i = 0; i < N; ++i) {
+            update(i);
+            observer.on_cell_update(i, pot[i], vx[i], vy[i]);
+        }
+    }
+
+    observer.on_step_end(grid, dt);
+}
+
 #endif // DIFP_RK4_SOLVER_HPP
\ No newline at end of file
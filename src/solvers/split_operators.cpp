@@ -0,0 +1,26 @@
+#include "split_operators.hpp"
+#include <algorithm>
+
+void AdvectionOperator::apply(DIFPGrid<double>& grid, double dt) {
+    const size_t W = grid.width;
+    const size_t H = grid.height;
+    if (W < 2) return;
+    previous.assign(grid.potential, grid.potential + grid.active_size);
+
+    const double* __restrict old = previous.data();
+    const double* __restrict vx = grid.vx;
+    double* __restrict pot = grid.potential;
+
+    // Okraje řádku: nulový gradient (hodnota za okrajem = hodnota na okraji)
+    #pragma omp parallel for schedule(static)
+    for (size_t y = 0; y < H; ++y) {
+        const size_t row = y * W;
+        for (size_t x = 0; x < W; ++x) {
+            const size_t i = row + x;
+            const double left = old[x > 0 ? i - 1 : i];
+            const double right = old[x + 1 < W ? i + 1 : i];
+            const double c = vx[i] * dt;
+            pot[i] = old[i] - (c > 0.0 ? c * (old[i] - left) : c * (right - old[i]));
+        }
+    }
+}
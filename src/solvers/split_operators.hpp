@@ -0,0 +1,89 @@
+#ifndef DIFP_SPLIT_OPERATORS_HPP
+#define DIFP_SPLIT_OPERATORS_HPP
+
+#include "DIFP_Core.hpp"
+#include "operator_splitting.hpp"
+#include "physics_kernel.hpp"
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * Dílčí operátory pro SplittingStepper (viz operator_splitting.hpp).
+ * Součet DampingOperator + WaveOperator je přesně pravá strana RK4Solveru.
+ */
+
+/**
+ * @struct DampingOperator
+ * @brief Tření: dv/dt = -f v, řešeno přesně (v *= e^{-f dt}).
+ */
+struct DampingOperator {
+    static constexpr uint32_t reads = FIELD_VX | FIELD_VY | FIELD_FRICTION;
+    static constexpr uint32_t writes = FIELD_VX | FIELD_VY;
+    static constexpr bool tile_local = true;
+
+    inline void apply_tile(DIFPGrid<double>& grid, size_t begin, size_t end, double dt) {
+        double* __restrict vx = grid.vx + begin;
+        double* __restrict vy = grid.vy + begin;
+        const double* __restrict fric = grid.friction + begin;
+        const size_t n = end - begin;
+
+        #pragma omp simd aligned(vx, vy, fric : 64)
+        for (size_t i = 0; i < n; ++i) {
+            double decay = std::exp(-fric[i] * dt);
+            vx[i] *= decay;
+            vy[i] *= decay;
+        }
+    }
+};
+
+/**
+ * @struct WaveOperator
+ * @brief Netlumená část vlnové rovnice, RK4 v registrech (bez bufferů k1..k4).
+ */
+struct WaveOperator {
+    static constexpr uint32_t reads = FIELD_POTENTIAL | FIELD_VX | FIELD_VY | FIELD_MASS;
+    static constexpr uint32_t writes = FIELD_POTENTIAL | FIELD_VX | FIELD_VY;
+    static constexpr bool tile_local = true;
+
+    inline void apply_tile(DIFPGrid<double>& grid, size_t begin, size_t end, double dt) {
+        double* __restrict pot = grid.potential + begin;
+        double* __restrict vx = grid.vx + begin;
+        double* __restrict vy = grid.vy + begin;
+        const double* __restrict mass = grid.mass + begin;
+        const size_t n = end - begin;
+        const double h2 = 0.5 * dt, h6 = dt / 6.0;
+
+        #pragma omp simd aligned(pot, vx, vy, mass : 64)
+        for (size_t i = 0; i < n; ++i) {
+            const double p = pot[i], x = vx[i], y = vy[i], m = mass[i];
+            double p1, x1, y1, p2, x2, y2, p3, x3, y3, p4, x4, y4;
+            damped_wave_rhs(p, x, y, m, 0.0, p1, x1, y1);
+            damped_wave_rhs(p + h2 * p1, x + h2 * x1, y + h2 * y1, m, 0.0, p2, x2, y2);
+            damped_wave_rhs(p + h2 * p2, x + h2 * x2, y + h2 * y2, m, 0.0, p3, x3, y3);
+            damped_wave_rhs(p + dt * p3, x + dt * x3, y + dt * y3, m, 0.0, p4, x4, y4);
+            pot[i] = p + h6 * (p1 + 2 * p2 + 2 * p3 + p4);
+            vx[i]  = x + h6 * (x1 + 2 * x2 + 2 * x3 + x4);
+            vy[i]  = y + h6 * (y1 + 2 * y2 + 2 * y3 + y4);
+        }
+    }
+};
+
+/**
+ * @class AdvectionOperator
+ * @brief Unášení potenciálu rychlostí vx podél x (upwind 1. řádu, CFL |vx| dt <= 1).
+ * @details Čte sousedy přes hranice dlaždic – globální operátor, běží samostatným průchodem.
+ */
+class AdvectionOperator {
+private:
+    std::vector<double> previous; // Kopie potenciálu před krokem
+
+public:
+    static constexpr uint32_t reads = FIELD_POTENTIAL | FIELD_VX;
+    static constexpr uint32_t writes = FIELD_POTENTIAL;
+    static constexpr bool tile_local = false;
+
+    void apply(DIFPGrid<double>& grid, double dt);
+};
+
+#endif // DIFP_SPLIT_OPERATORS_HPP
@@ -0,0 +1,405 @@
+/**
+ * @file difp_analyze.cpp
+ * @brief Dávková analýza snapshotů (io/snapshot.hpp): statistiky v prostoru i čase.
+ * @details Snapshoty se zpracují po jednom přes mmap, bloky (dlaždice) paralelně
+ *          (OpenMP) a vnitřní smyčky vektorizovaně. Paměť procesu je omezená
+ *          velikostí jedné mřížky (jen s --mean), nezávisle na počtu snapshotů.
+ *
+ *   difp_analyze [--fields a,b,...] [--region x0 y0 w h] [--corr a b] [--mean out.difp] soubory...
+ *
+ * Výstup (CSV na stdout): statistiky každého pole v každém snapshotu, korelace dvou
+ * polí v prostoru a souhrnné řádky "ALL" přes všechny snapshoty.
+ */
+
+#include "DIFP_Core.hpp"
+#include "io/snapshot.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+/**
+ * Momenty jako (počet, průměr, M2 = Σ (x - průměr)²) místo Σx a Σx²: vzorec
+ * Σx²/n - průměr² se pro pole s velkým průměrem a malým rozptylem (mass ~ 1 ± 1e-8)
+ * vyruší na nulu. Dlaždice se počítají dvěma průchody (průměr, pak odchylky, data jsou
+ * v cache), dlaždice a snapshoty se slučují Chanovým vzorcem.
+ */
+struct Moments {
+    double count = 0.0;
+    double mean_value = 0.0;
+    double m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void merge(const Moments& o) {
+        if (!o.count) return;
+        const double n = count + o.count;
+        const double delta = o.mean_value - mean_value;
+        mean_value += delta * (o.count / n);
+        m2 += o.m2 + delta * delta * (count * o.count / n);
+        count = n;
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+    }
+
+    [[nodiscard]] double mean() const { return mean_value; }
+    [[nodiscard]] double stddev() const { return count ? std::sqrt(m2 / count) : 0.0; }
+};
+
+// Smíšené momenty dvou polí pro Pearsonovu korelaci (C_ab = Σ (a - ā)(b - b̄))
+struct CrossMoments {
+    double count = 0.0, mean_a = 0.0, mean_b = 0.0, m2_a = 0.0, m2_b = 0.0, c_ab = 0.0;
+
+    void merge(const CrossMoments& o) {
+        if (!o.count) return;
+        const double n = count + o.count;
+        const double da = o.mean_a - mean_a, db = o.mean_b - mean_b;
+        const double w = count * o.count / n;
+        mean_a += da * (o.count / n);
+        mean_b += db * (o.count / n);
+        m2_a += o.m2_a + da * da * w;
+        m2_b += o.m2_b + db * db * w;
+        c_ab += o.c_ab + da * db * w;
+        count = n;
+    }
+
+    [[nodiscard]] double correlation() const {
+        return (m2_a > 0.0 && m2_b > 0.0) ? c_ab / std::sqrt(m2_a * m2_b) : 0.0;
+    }
+};
+
+struct Region {
+    size_t x0 = 0, y0 = 0, w = 0, h = 0; // w == 0: celá mřížka
+};
+
+struct Options {
+    std::vector<SnapshotField> fields;
+    Region region;
+    bool correlate = false;
+    SnapshotField corr_a = SnapshotField::Potential, corr_b = SnapshotField::VX;
+    std::string mean_path;
+    std::vector<std::string> files;
+};
+
+bool parse_field(const std::string& name, SnapshotField& out) {
+    for (uint32_t f = 0; f < SNAPSHOT_FIELD_COUNT; ++f) {
+        if (name == snapshot_field_name(static_cast<SnapshotField>(f))) {
+            out = static_cast<SnapshotField>(f);
+            return true;
+        }
+    }
+    std::cerr << "Nezname pole: " << name << std::endl;
+    return false;
+}
+
+// Celé nezáporné číslo bez zbytku (std::stoul by při chybě vyhodil výjimku z main)
+bool parse_size(const char* text, size_t& out) {
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long v = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || text[0] == '-') {
+        std::cerr << "Neplatne cislo: " << text << std::endl;
+        return false;
+    }
+    out = static_cast<size_t>(v);
+    return true;
+}
+
+bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fields" && i + 1 < argc) {
+            std::string list = argv[++i];
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t comma = list.find(',', start);
+                if (comma == std::string::npos) comma = list.size();
+                SnapshotField f;
+                if (!parse_field(list.substr(start, comma - start), f)) return false;
+                opt.fields.push_back(f);
+                start = comma + 1;
+            }
+        } else if (arg == "--region" && i + 4 < argc) {
+            size_t v[4];
+            for (int k = 0; k < 4; ++k) {
+                if (!parse_size(argv[i + 1 + k], v[k])) return false;
+            }
+            opt.region = {v[0], v[1], v[2], v[3]};
+            i += 4;
+        } else if (arg == "--corr" && i + 2 < argc) {
+            if (!parse_field(argv[i + 1], opt.corr_a) || !parse_field(argv[i + 2], opt.corr_b)) return false;
+            opt.correlate = true;
+            i += 2;
+        } else if (arg == "--mean" && i + 1 < argc) {
+            opt.mean_path = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Neznamy prepinac: " << arg << std::endl;
+            return false;
+        } else {
+            opt.files.push_back(arg);
+        }
+    }
+    if (opt.fields.empty()) {
+        for (uint32_t f = 0; f < SNAPSHOT_FIELD_COUNT; ++f) opt.fields.push_back(static_cast<SnapshotField>(f));
+    }
+    return !opt.files.empty();
+}
+
+double* grid_field(DIFPGrid<double>& grid, SnapshotField field) {
+    double* const fields[SNAPSHOT_FIELD_COUNT] = {grid.potential, grid.mass, grid.vx, grid.vy, grid.friction, grid.pressure};
+    return fields[static_cast<uint32_t>(field)];
+}
+
+// Průnik dlaždice (tx, ty) s oblastí: rozsahy v souřadnicích dlaždice
+struct TileWindow {
+    size_t col0, col1, row0, row1;
+};
+
+bool tile_window(const SnapshotReader& r, const Region& reg, size_t tx, size_t ty, size_t tw, size_t th, TileWindow& out) {
+    const size_t gx = tx * r.header().tile_width, gy = ty * r.header().tile_height;
+    const size_t rx1 = reg.x0 + reg.w, ry1 = reg.y0 + reg.h;
+    const size_t c0 = std::max(gx, reg.x0), c1 = std::min(gx + tw, rx1);
+    const size_t r0 = std::max(gy, reg.y0), r1 = std::min(gy + th, ry1);
+    if (c0 >= c1 || r0 >= r1) return false;
+    out = {c0 - gx, c1 - gx, r0 - gy, r1 - gy};
+    return true;
+}
+
+/**
+ * @brief Statistiky jednoho pole v oblasti (paralelně přes dlaždice).
+ * @param accumulate Volitelně přičte hodnoty pole do mřížky (časový průměr).
+ */
+bool field_moments(const SnapshotReader& r, SnapshotField field, const Region& reg, Moments& out, double* accumulate) {
+    const size_t nx = r.tile_columns(), ny = r.tile_rows();
+    const size_t n_tiles = nx * ny;
+    std::vector<Moments> partial(n_tiles);
+    bool ok = true;
+
+    #pragma omp parallel for schedule(dynamic) reduction(&& : ok)
+    for (size_t t = 0; t < n_tiles; ++t) {
+        const size_t tx = t % nx, ty = t / nx;
+        size_t tw, th;
+        const double* data = r.chunk_data(field, tx, ty, tw, th);
+        if (!data) {
+            ok = false;
+            continue;
+        }
+
+        // Časový průměr zahrnuje celou dlaždici bez ohledu na oblast
+        if (accumulate) {
+            const size_t gx = tx * r.header().tile_width, gy = ty * r.header().tile_height;
+            for (size_t row = 0; row < th; ++row) {
+                const double* __restrict src = data + row * tw;
+                double* __restrict dst = accumulate + (gy + row) * r.width() + gx;
+                #pragma omp simd
+                for (size_t c = 0; c < tw; ++c) dst[c] += src[c];
+            }
+        }
+
+        TileWindow win;
+        if (!tile_window(r, reg, tx, ty, tw, th, win)) continue;
+        const double n = double((win.row1 - win.row0) * (win.col1 - win.col0));
+        double sum = 0.0;
+        double mn = std::numeric_limits<double>::infinity(), mx = -mn;
+        for (size_t row = win.row0; row < win.row1; ++row) {
+            const double* __restrict src = data + row * tw;
+            #pragma omp simd reduction(+ : sum) reduction(min : mn) reduction(max : mx)
+            for (size_t c = win.col0; c < win.col1; ++c) {
+                const double v = src[c];
+                sum += v;
+                mn = std::min(mn, v);
+                mx = std::max(mx, v);
+            }
+        }
+        const double mean = sum / n;
+        double m2 = 0.0, drift = 0.0;
+        for (size_t row = win.row0; row < win.row1; ++row) {
+            const double* __restrict src = data + row * tw;
+            #pragma omp simd reduction(+ : m2, drift)
+            for (size_t c = win.col0; c < win.col1; ++c) {
+                const double d = src[c] - mean;
+                m2 += d * d;
+                drift += d;
+            }
+        }
+        partial[t].count = n;
+        // Oprava zaokrouhlení průměru (Σ d by přesně byla 0)
+        partial[t].mean_value = mean + drift / n;
+        partial[t].m2 = m2 - drift * drift / n;
+        partial[t].min = mn;
+        partial[t].max = mx;
+    }
+
+    // Slučování v pevném pořadí: výsledek nezávisí na počtu vláken
+    out = Moments{};
+    for (const Moments& m : partial) out.merge(m);
+    return ok;
+}
+
+bool cross_moments(const SnapshotReader& r, SnapshotField a, SnapshotField b, const Region& reg, CrossMoments& out) {
+    const size_t nx = r.tile_columns(), ny = r.tile_rows();
+    const size_t n_tiles = nx * ny;
+    std::vector<CrossMoments> partial(n_tiles);
+    bool ok = true;
+
+    #pragma omp parallel for schedule(dynamic) reduction(&& : ok)
+    for (size_t t = 0; t < n_tiles; ++t) {
+        const size_t tx = t % nx, ty = t / nx;
+        size_t tw, th;
+        const double* da = r.chunk_data(a, tx, ty, tw, th);
+        const double* db = r.chunk_data(b, tx, ty, tw, th);
+        if (!da || !db) {
+            ok = false;
+            continue;
+        }
+        TileWindow win;
+        if (!tile_window(r, reg, tx, ty, tw, th, win)) continue;
+        const double n = double((win.row1 - win.row0) * (win.col1 - win.col0));
+        double sa = 0.0, sb = 0.0;
+        for (size_t row = win.row0; row < win.row1; ++row) {
+            const double* __restrict pa = da + row * tw;
+            const double* __restrict pb = db + row * tw;
+            #pragma omp simd reduction(+ : sa, sb)
+            for (size_t c = win.col0; c < win.col1; ++c) {
+                sa += pa[c];
+                sb += pb[c];
+            }
+        }
+        const double ma = sa / n, mb = sb / n;
+        double m2a = 0.0, m2b = 0.0, cab = 0.0;
+        for (size_t row = win.row0; row < win.row1; ++row) {
+            const double* __restrict pa = da + row * tw;
+            const double* __restrict pb = db + row * tw;
+            #pragma omp simd reduction(+ : m2a, m2b, cab)
+            for (size_t c = win.col0; c < win.col1; ++c) {
+                const double xa = pa[c] - ma, xb = pb[c] - mb;
+                m2a += xa * xa;
+                m2b += xb * xb;
+                cab += xa * xb;
+            }
+        }
+        partial[t] = {n, ma, mb, m2a, m2b, cab};
+    }
+
+    out = CrossMoments{};
+    for (const CrossMoments& m : partial) out.merge(m);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::cerr << "Pouziti: difp_analyze [--fields a,b,...] [--region x0 y0 w h] [--corr a b] "
+                     "[--mean out.difp] soubory..." << std::endl;
+        return 2;
+    }
+
+    std::vector<Moments> totals(SNAPSHOT_FIELD_COUNT);
+    CrossMoments cross_total;
+    DIFPGrid<double> mean_grid(0, 0);
+    size_t width = 0, height = 0, processed = 0;
+    uint64_t last_step = 0;
+    double time_sum = 0.0;
+    int status = 0;
+
+    std::cout << std::setprecision(10);
+    std::cout << "file,step,time,field,min,max,mean,std" << std::endl;
+
+    for (const std::string& path : opt.files) {
+        SnapshotReader reader;
+        if (!reader.open(path, MappedFile::Access::Sequential)) {
+            std::cerr << "Preskakuji (neplatny snapshot): " << path << std::endl;
+            status = 1;
+            continue;
+        }
+        if (processed == 0) {
+            width = reader.width();
+            height = reader.height();
+            if (!opt.mean_path.empty()) {
+                mean_grid = DIFPGrid<double>(width, height);
+                for (uint32_t f = 0; f < SNAPSHOT_FIELD_COUNT; ++f) {
+                    double* p = grid_field(mean_grid, static_cast<SnapshotField>(f));
+                    std::fill(p, p + mean_grid.get_compute_size(), 0.0);
+                }
+            }
+        } else if (reader.width() != width || reader.height() != height) {
+            std::cerr << "Preskakuji (jine rozmery): " << path << std::endl;
+            status = 1;
+            continue;
+        }
+
+        Region reg = opt.region;
+        if (reg.w == 0 || reg.h == 0) reg = {0, 0, width, height};
+        // Bez součtu x0 + w: obrovské x0 by přeteklo přes nulu a prošlo
+        if (reg.w > width || reg.x0 > width - reg.w || reg.h > height || reg.y0 > height - reg.h) {
+            std::cerr << "Oblast je mimo mrizku: " << path << std::endl;
+            return 2;
+        }
+
+        const SnapshotHeader& head = reader.header();
+        bool ok = true;
+
+        // Průměr v čase potřebuje všechna pole, statistiky jen vybraná
+        for (uint32_t f = 0; f < SNAPSHOT_FIELD_COUNT && ok; ++f) {
+            const SnapshotField field = static_cast<SnapshotField>(f);
+            const bool reported = std::find(opt.fields.begin(), opt.fields.end(), field) != opt.fields.end();
+            double* acc = opt.mean_path.empty() ? nullptr : grid_field(mean_grid, field);
+            if (!reported && !acc) continue;
+
+            Moments m;
+            ok = field_moments(reader, field, reg, m, acc);
+            if (ok && reported) {
+                totals[f].merge(m);
+                std::cout << path << "," << head.step << "," << head.time << "," << snapshot_field_name(field) << ","
+                          << m.min << "," << m.max << "," << m.mean() << "," << m.stddev() << std::endl;
+            }
+        }
+        if (ok && opt.correlate) {
+            CrossMoments c;
+            ok = cross_moments(reader, opt.corr_a, opt.corr_b, reg, c);
+            cross_total.merge(c);
+            std::cout << path << "," << head.step << "," << head.time << ",corr(" << snapshot_field_name(opt.corr_a)
+                      << ";" << snapshot_field_name(opt.corr_b) << "),,," << c.correlation() << "," << std::endl;
+        }
+        if (!ok) {
+            // Částečně přičtený průměr by byl zkreslený
+            std::cerr << "Poskozeny blok v " << path << std::endl;
+            return 1;
+        }
+        last_step = head.step;
+        time_sum += head.time;
+        ++processed;
+    }
+
+    for (SnapshotField field : opt.fields) {
+        const Moments& m = totals[static_cast<uint32_t>(field)];
+        if (!m.count) continue;
+        std::cout << "ALL,,," << snapshot_field_name(field) << "," << m.min << "," << m.max << "," << m.mean()
+                  << "," << m.stddev() << std::endl;
+    }
+    if (opt.correlate && cross_total.count) {
+        std::cout << "ALL,,,corr(" << snapshot_field_name(opt.corr_a) << ";" << snapshot_field_name(opt.corr_b)
+                  << "),,," << cross_total.correlation() << "," << std::endl;
+    }
+
+    if (!opt.mean_path.empty() && processed) {
+        const double scale = 1.0 / double(processed);
+        for (uint32_t f = 0; f < SNAPSHOT_FIELD_COUNT; ++f) {
+            double* p = grid_field(mean_grid, static_cast<SnapshotField>(f));
+            for (size_t i = 0; i < mean_grid.active_size; ++i) p[i] *= scale;
+        }
+        write_snapshot(opt.mean_path, mean_grid, last_step, time_sum * scale);
+        std::cerr << "Casovy prumer " << processed << " snapshotu: " << opt.mean_path << std::endl;
+    }
+    return status;
+}
@@ -0,0 +1,369 @@
+/**
+ * @file difp_perf.cpp
+ * @brief Výkonnostní regresní testy: pevné zátěže proti uloženému baseline.
+ * @details Každá zátěž se změří v několika vzorcích (mezi vzorky se stav vrátí na
+ *          výchozí, aby všechny vzorky dělaly stejnou práci). Výsledkem je medián času
+ *          jedné iterace a MAD (medián absolutních odchylek) jako míra šumu.
+ *
+ *          Práh regrese je šumový: max(min_rel, min(max_rel, 3 · (MAD/medián teď + MAD/medián
+ *          v baseline))). Hlučná zátěž tak má širší toleranci a tichá zátěž odhalí i malé
+ *          zpomalení; strop max_rel (výchozí 25 %) brání tomu, aby šum práh roztáhl tak, že
+ *          by regresi nešlo ohlásit vůbec.
+ *          Šum mezi běhy (frekvence CPU, sousední procesy) bývá větší než uvnitř běhu:
+ *          --update proto měří v několika kolech a šum baseline je větší z MAD uvnitř
+ *          kola a MAD mediánů kol. Zátěž nad prahem se před ohlášením regrese změří
+ *          znovu (až RETRIES krát) a počítá se nejlepší pokus.
+ *
+ *          Baseline je JSON v repozitáři (perf/baseline.json) se jménem CPU a počtem
+ *          vláken. Na jiném stroji se rozdíly jen vypíší (bez selhání), pokud není --strict.
+ *
+ *   difp_perf [--baseline soubor] [--update] [--rounds n] [--filter text] [--samples n] [--min-rel r]
+ *             [--max-rel r] [--strict]
+ *
+ * Návratový kód: 0 = v toleranci, 1 = regrese, 2 = chyba použití nebo chybí baseline.
+ */
+
+#include "DIFP_Core.hpp"
+#include "solvers/rk4_solver.hpp"
+#include "solvers/physics_kernel.hpp"
+#include "universe/rewrite_rule.hpp"
+#include "universe/packed_universe.hpp"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+constexpr int RETRIES = 2; // Opakovaná měření zátěže nad prahem
+
+struct Benchmark {
+    std::string name;
+    size_t iterations;           // Opakování těla v jednom vzorku (vzorek aspoň ~5 ms, kratší měří hlavně šum)
+    std::function<void()> reset; // Před každým vzorkem (neměří se)
+    std::function<void()> body;
+};
+
+struct Measurement {
+    double median_ns = 0.0; // Medián času jedné iterace
+    double mad_ns = 0.0;    // Medián absolutních odchylek
+};
+
+struct Baseline {
+    std::string host;
+    std::vector<std::pair<std::string, Measurement>> entries;
+
+    [[nodiscard]] const Measurement* find(const std::string& name) const {
+        for (const auto& e : entries) {
+            if (e.first == name) return &e.second;
+        }
+        return nullptr;
+    }
+};
+
+struct Options {
+    std::string baseline_path = "perf/baseline.json";
+    std::string filter;
+    size_t samples = 15;
+    size_t rounds = 3; // Kola měření pro --update
+    double min_rel = 0.05;
+    double max_rel = 0.25; // Strop šumové části prahu
+    bool update = false;
+    bool strict = false;
+};
+
+double median_of(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    const size_t n = v.size();
+    return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+Measurement measure(const Benchmark& b, size_t samples) {
+    // Zahřátí: stránky, vlákna OpenMP, prediktory
+    b.reset();
+    b.body();
+
+    std::vector<double> per_iteration(samples);
+    for (size_t s = 0; s < samples; ++s) {
+        b.reset();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < b.iterations; ++i) b.body();
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        per_iteration[s] = ns / double(b.iterations);
+    }
+    Measurement m;
+    m.median_ns = median_of(per_iteration);
+    for (double& v : per_iteration) v = std::fabs(v - m.median_ns);
+    m.mad_ns = median_of(per_iteration);
+    return m;
+}
+
+// Baseline z několika kol: medián mediánů, šum = větší z MAD uvnitř kol a mezi koly
+Measurement combine_rounds(const std::vector<Measurement>& rounds) {
+    std::vector<double> medians, mads;
+    for (const Measurement& m : rounds) {
+        medians.push_back(m.median_ns);
+        mads.push_back(m.mad_ns);
+    }
+    Measurement out;
+    out.median_ns = median_of(medians);
+    for (double& v : medians) v = std::fabs(v - out.median_ns);
+    out.mad_ns = std::max(median_of(mads), median_of(medians));
+    return out;
+}
+
+std::string host_id() {
+    std::string model = "unknown";
+    std::ifstream cpu("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpu, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            const size_t colon = line.find(':');
+            if (colon != std::string::npos) model = line.substr(line.find_first_not_of(' ', colon + 1));
+            break;
+        }
+    }
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    // Uvozovky by rozbily JSON
+    std::replace(model.begin(), model.end(), '"', '\'');
+    return model + ", " + std::to_string(threads) + " vlaken";
+}
+
+/**
+ * Baseline: JSON, který zapisuje a čte tento nástroj (jedna zátěž na řádek):
+ *
+ *   {
+ *     "host": "...",
+ *     "benchmarks": {
+ *       "rk4.step": {"median_ns": 1.2e+06, "mad_ns": 3.4e+03},
+ *       ...
+ *     }
+ *   }
+ */
+bool read_baseline(const std::string& path, Baseline& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t q0 = line.find('"');
+        if (q0 == std::string::npos) continue;
+        const size_t q1 = line.find('"', q0 + 1);
+        if (q1 == std::string::npos) continue;
+        const std::string key = line.substr(q0 + 1, q1 - q0 - 1);
+        if (key == "host") {
+            const size_t v0 = line.find('"', q1 + 1);
+            const size_t v1 = line.rfind('"');
+            if (v0 != std::string::npos && v1 > v0) out.host = line.substr(v0 + 1, v1 - v0 - 1);
+            continue;
+        }
+        const size_t med = line.find("\"median_ns\":");
+        const size_t mad = line.find("\"mad_ns\":");
+        if (med == std::string::npos || mad == std::string::npos) continue;
+        Measurement m;
+        m.median_ns = std::strtod(line.c_str() + med + 12, nullptr);
+        m.mad_ns = std::strtod(line.c_str() + mad + 9, nullptr);
+        out.entries.emplace_back(key, m);
+    }
+    return !out.entries.empty();
+}
+
+bool write_baseline(const std::string& path, const Baseline& b) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\n  \"host\": \"" << b.host << "\",\n  \"benchmarks\": {\n";
+    out << std::setprecision(6);
+    for (size_t i = 0; i < b.entries.size(); ++i) {
+        out << "    \"" << b.entries[i].first << "\": {\"median_ns\": " << b.entries[i].second.median_ns
+            << ", \"mad_ns\": " << b.entries[i].second.mad_ns << "}" << (i + 1 < b.entries.size() ? "," : "")
+            << "\n";
+    }
+    out << "  }\n}\n";
+    return static_cast<bool>(out);
+}
+
+bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--baseline" && i + 1 < argc) {
+            opt.baseline_path = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            opt.samples = std::max<size_t>(3, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            opt.rounds = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--min-rel" && i + 1 < argc) {
+            opt.min_rel = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--max-rel" && i + 1 < argc) {
+            opt.max_rel = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--update") {
+            opt.update = true;
+        } else if (arg == "--strict") {
+            opt.strict = true;
+        } else {
+            std::cerr << "Neznamy prepinac: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::cerr << "Pouziti: difp_perf [--baseline soubor] [--update] [--rounds n] [--filter text] [--samples n] "
+                     "[--min-rel r] [--max-rel r] [--strict]" << std::endl;
+        return 2;
+    }
+
+    // --- Pevné zátěže (velikosti se nesmí měnit bez přegenerování baseline) ---
+
+    // Fyzikální jádro po buňkách nad 1M buněk (bez režie solveru)
+    const size_t KERNEL_N = size_t(1) << 20;
+    DIFPGrid<double> kernel_in(1024, 1024), kernel_out(1024, 1024);
+    for (size_t i = 0; i < KERNEL_N; ++i) {
+        kernel_in.potential[i] = std::sin(0.001 * double(i));
+        kernel_in.vx[i] = std::cos(0.002 * double(i));
+    }
+
+    // Kopie mřížky (copy_fields_from, bez realokace)
+    DIFPGrid<double> copy_src = kernel_in, copy_dst(1024, 1024);
+
+    // Celý krok RK4 (512 x 512)
+    DIFPGrid<double> rk4_initial(512, 512);
+    for (size_t i = 0; i < rk4_initial.active_size; ++i) rk4_initial.potential[i] = std::sin(0.01 * double(i));
+    DIFPGrid<double> rk4_grid = rk4_initial;
+    RK4Solver solver;
+    solver.prepare(rk4_grid);
+
+    // Informační vesmír: stav se před vzorkem obnoví (kvanta se jinak zaseknou u okraje);
+    // 128 řádků, aby vzorek tick.scalar trval přes 5 ms
+    const int TICK_W = 4096, TICK_H = 128;
+    std::vector<Node> tick_initial(size_t(TICK_W) * TICK_H, Node{0, 1.0f});
+    for (size_t i = 0; i < tick_initial.size(); i += 3) tick_initial[i].state = 1;
+    std::vector<Node> tick_nodes = tick_initial;
+
+    PackedUniverse packed_initial(4096, 1024);
+    for (size_t i = 0; i < packed_initial.cells; i += 3) packed_initial.set_state(i, true);
+    PackedUniverse packed = packed_initial;
+
+    const std::vector<Benchmark> benchmarks = {
+        {"kernel.damped_wave", 20, [] {},
+         [&] {
+             const double* __restrict pot = kernel_in.potential;
+             const double* __restrict vx = kernel_in.vx;
+             const double* __restrict vy = kernel_in.vy;
+             const double* __restrict mass = kernel_in.mass;
+             const double* __restrict fric = kernel_in.friction;
+             double* __restrict d_pot = kernel_out.potential;
+             double* __restrict d_vx = kernel_out.vx;
+             double* __restrict d_vy = kernel_out.vy;
+             #pragma omp simd aligned(pot, vx, vy, mass, fric, d_pot, d_vx, d_vy : 64)
+             for (size_t i = 0; i < KERNEL_N; ++i) {
+                 damped_wave_rhs(pot[i], vx[i], vy[i], mass[i], fric[i], d_pot[i], d_vx[i], d_vy[i]);
+             }
+         }},
+        {"grid.copy", 20, [] {}, [&] { copy_dst = copy_src; }},
+        {"rk4.step", 10, [&] { rk4_grid = rk4_initial; }, [&] { solver.step(rk4_grid, 0.01); }},
+        {"tick.scalar", 20, [&] { tick_nodes = tick_initial; }, [&] { tick(tick_nodes, TICK_W, TICK_H); }},
+        {"tick.packed", 50, [&] { packed = packed_initial; }, [&] { packed.tick_parallel(); }},
+    };
+
+    std::vector<const Benchmark*> selected;
+    for (const Benchmark& b : benchmarks) {
+        if (opt.filter.empty() || b.name.find(opt.filter) != std::string::npos) selected.push_back(&b);
+    }
+
+    // Kola se prokládají přes zátěže, aby pomalá fáze stroje nepostihla jen jednu zátěž
+    const size_t rounds = opt.update ? opt.rounds : 1;
+    std::vector<std::vector<Measurement>> measured(selected.size());
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t k = 0; k < selected.size(); ++k) measured[k].push_back(measure(*selected[k], opt.samples));
+    }
+
+    Baseline current;
+    current.host = host_id();
+    for (size_t k = 0; k < selected.size(); ++k) {
+        current.entries.emplace_back(selected[k]->name, combine_rounds(measured[k]));
+    }
+
+    if (opt.update) {
+        if (!write_baseline(opt.baseline_path, current)) {
+            std::cerr << "Baseline nelze zapsat: " << opt.baseline_path << std::endl;
+            return 2;
+        }
+        for (const auto& e : current.entries) {
+            std::cout << std::left << std::setw(22) << e.first << std::right << std::setw(12)
+                      << e.second.median_ns / 1e3 << " us  (MAD " << e.second.mad_ns / 1e3 << " us)" << std::endl;
+        }
+        std::cout << "Baseline ulozen: " << opt.baseline_path << " (" << current.host << ")" << std::endl;
+        return 0;
+    }
+
+    Baseline base;
+    if (!read_baseline(opt.baseline_path, base)) {
+        std::cerr << "Baseline nelze precist: " << opt.baseline_path << " (vytvorit: --update)" << std::endl;
+        return 2;
+    }
+    const bool same_host = base.host == current.host;
+    const bool enforce = same_host || opt.strict;
+
+    std::cout << "Baseline: " << base.host << std::endl;
+    std::cout << "Tento stroj: " << current.host << (enforce ? "" : " (jiny stroj: jen informace)") << std::endl;
+    std::cout << std::left << std::setw(22) << "zatez" << std::right << std::setw(14) << "baseline us" << std::setw(14)
+              << "ted us" << std::setw(10) << "zmena %" << std::setw(10) << "prah %" << "  stav" << std::endl;
+
+    size_t regressions = 0;
+    std::cout << std::fixed;
+    for (size_t k = 0; k < current.entries.size(); ++k) {
+        const std::string& name = current.entries[k].first;
+        Measurement& now = current.entries[k].second;
+        const Measurement* before = base.find(name);
+        std::cout << std::left << std::setw(22) << name << std::right << std::setprecision(1);
+        if (!before || before->median_ns <= 0.0) {
+            std::cout << std::setw(14) << "-" << std::setw(14) << now.median_ns / 1e3 << "  NOVA (chybi v baseline)"
+                      << std::endl;
+            continue;
+        }
+        auto threshold = [&](const Measurement& m) {
+            const double noise = 3.0 * (m.mad_ns / m.median_ns + before->mad_ns / before->median_ns);
+            return std::max(opt.min_rel, std::min(opt.max_rel, noise));
+        };
+        // Potvrzení: nad prahem se měří znovu, platí nejlepší pokus
+        for (int retry = 0; retry < RETRIES && now.median_ns / before->median_ns - 1.0 > threshold(now); ++retry) {
+            const Measurement again = measure(*selected[k], opt.samples);
+            if (again.median_ns < now.median_ns) now = again;
+        }
+        const double limit = threshold(now);
+        const double delta = now.median_ns / before->median_ns - 1.0;
+        const char* status = "OK";
+        if (delta > limit) {
+            status = "REGRESE";
+            if (enforce) ++regressions;
+        } else if (delta < -limit) {
+            status = "ZLEPSENI";
+        }
+        std::cout << std::setw(14) << before->median_ns / 1e3 << std::setw(14) << now.median_ns / 1e3 << std::setw(10)
+                  << 100.0 * delta << std::setw(10) << 100.0 * limit << "  " << status << std::endl;
+    }
+
+    if (regressions) {
+        std::cout << "Regrese: " << regressions << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file difp_steer.cpp
+ * @brief Řízení běžící simulace (io/steering.hpp): jeden příkaz na spuštění.
+ * @details Připojí se ke sdílené frontě simulace, vloží příkaz a počká, až ho simulace
+ *          mezi kroky zpracuje (nejvýše --timeout sekund).
+ *
+ *   difp_steer [--timeout s] jmeno dt <hodnota>
+ *   difp_steer [--timeout s] jmeno pause | resume | stop
+ *   difp_steer [--timeout s] jmeno paint <pole[,pole...]> x0 y0 w h <hodnota> [add]
+ *   difp_steer [--timeout s] jmeno state x0 y0 w h 0|1
+ *   difp_steer [--timeout s] jmeno snapshot <soubor>
+ *
+ * Návratový kód: 0 = zpracováno, 1 = simulace příkaz odmítla nebo nestihla, 2 = chybné použití.
+ */
+
+#include "DIFP_Core.hpp"
+#include "io/steering.hpp"
+#include "io/snapshot.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+bool parse_fields(const std::string& list, uint32_t& mask) {
+    mask = 0;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        const std::string name = list.substr(pos, comma - pos);
+        bool found = false;
+        // Pořadí SnapshotField odpovídá bitům FieldMask
+        for (uint32_t f = 0; f < SNAPSHOT_FIELD_COUNT; ++f) {
+            if (name == snapshot_field_name(static_cast<SnapshotField>(f))) {
+                mask |= 1u << f;
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "Nezname pole: " << name << std::endl;
+            return false;
+        }
+        pos = comma + 1;
+    }
+    return mask != 0;
+}
+
+uint32_t parse_u32(const char* s) { return static_cast<uint32_t>(std::strtoul(s, nullptr, 10)); }
+
+bool parse_command(const std::vector<std::string>& a, SteeringCommand& out) {
+    if (a.empty()) return false;
+    const std::string& op = a[0];
+    if (op == "dt" && a.size() == 2) {
+        out = SteeringCommand::set_parameter(SteeringParameter::TimeStep, std::strtod(a[1].c_str(), nullptr));
+    } else if (op == "pause" && a.size() == 1) {
+        out = SteeringCommand::set_parameter(SteeringParameter::Paused, 1.0);
+    } else if (op == "resume" && a.size() == 1) {
+        out = SteeringCommand::set_parameter(SteeringParameter::Paused, 0.0);
+    } else if (op == "stop" && a.size() == 1) {
+        out = SteeringCommand::stop();
+    } else if (op == "paint" && (a.size() == 7 || (a.size() == 8 && a[7] == "add"))) {
+        uint32_t mask;
+        if (!parse_fields(a[1], mask)) return false;
+        out = SteeringCommand::paint_field(mask, parse_u32(a[2].c_str()), parse_u32(a[3].c_str()),
+                                           parse_u32(a[4].c_str()), parse_u32(a[5].c_str()),
+                                           std::strtod(a[6].c_str(), nullptr),
+                                           a.size() == 8 ? PaintMode::Add : PaintMode::Set);
+    } else if (op == "state" && a.size() == 6) {
+        out = SteeringCommand::paint_state(parse_u32(a[1].c_str()), parse_u32(a[2].c_str()), parse_u32(a[3].c_str()),
+                                           parse_u32(a[4].c_str()), a[5] != "0");
+    } else if (op == "snapshot" && a.size() == 2) {
+        out = SteeringCommand::snapshot(a[1]);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double timeout = 10.0;
+    int first = 1;
+    if (argc > 2 && std::string(argv[1]) == "--timeout") {
+        timeout = std::strtod(argv[2], nullptr);
+        first = 3;
+    }
+    SteeringCommand command{};
+    bool ok = argc > first + 1;
+    if (ok) {
+        try {
+            ok = parse_command(std::vector<std::string>(argv + first + 1, argv + argc), command);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << e.what() << std::endl;
+            ok = false;
+        }
+    }
+    if (!ok) {
+        std::cerr << "Pouziti: difp_steer [--timeout s] jmeno dt <hodnota> | pause | resume | stop |\n"
+                     "         paint <pole[,pole...]> x0 y0 w h <hodnota> [add] | state x0 y0 w h 0|1 |\n"
+                     "         snapshot <soubor>" << std::endl;
+        return 2;
+    }
+
+    SteeringClient client;
+    if (!client.attach(argv[first])) {
+        std::cerr << "Nelze se pripojit k simulaci '" << argv[first]
+                  << "' (nebezi, nebo uz je pripojen jiny nastroj)" << std::endl;
+        return 1;
+    }
+
+    const uint64_t done_before = client.applied() + client.rejected();
+    const uint64_t rejected_before = client.rejected();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+    while (!client.send(command)) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Fronta je plna, simulace neodebira prikazy" << std::endl;
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Nástroj je jediný producent: zpracování poznáme podle součtu čítačů
+    while (client.applied() + client.rejected() == done_before) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Prikaz odeslan, simulace ho zatim nezpracovala" << std::endl;
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (client.rejected() != rejected_before) {
+        std::cerr << "Simulace prikaz odmitla" << std::endl;
+        return 1;
+    }
+    std::cout << "Zpracovano" << std::endl;
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef DIFP_ACTIVITY_HPP
+#define DIFP_ACTIVITY_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+/**
+ * @struct TickCounters
+ * @brief Levné čítače jednoho taktu (popcount masky přesunutých bitů, bez průchodu navíc).
+ */
+struct TickCounters {
+    uint64_t rewrites = 0;     // Počet provedených přepisů (přesunutých kvant)
+    uint64_t active_words = 0; // Slova (64 uzlů), ve kterých se něco změnilo
+    uint64_t active_tiles = 0; // Dlaždice s alespoň jedním přepisem (jen s ActivityMap)
+};
+
+/**
+ * @class ActivityMap
+ * @brief Akumulovaná tepelná mapa přepisů v rozlišení dlaždic.
+ * @details Dlaždice = tile_words po sobě jdoucích slov (tile_words * 64 uzlů, mocnina dvou).
+ *          Pro 2D mřížku se šířkou dělitelnou 64 je dlaždice úsek řádku.
+ *          Paralelní takt zarovná bloky vláken na hranice dlaždic, takže každou
+ *          dlaždici zapisuje jediné vlákno (bez atomik).
+ */
+class ActivityMap {
+private:
+    std::vector<uint64_t> tile_rewrites;
+    size_t tile_words;
+    uint64_t tick_count = 0;
+
+public:
+    ActivityMap(size_t n_words, size_t words_per_tile = 64) : tile_words(words_per_tile) {
+        if (tile_words == 0 || (tile_words & (tile_words - 1)) != 0) {
+            throw std::invalid_argument("ActivityMap: tile_words must be a power of two.");
+        }
+        tile_rewrites.assign((n_words + tile_words - 1) / tile_words, 0);
+    }
+
+    [[nodiscard]] size_t words_per_tile() const { return tile_words; }
+    [[nodiscard]] size_t cells_per_tile() const { return tile_words * 64; }
+    [[nodiscard]] size_t tile_count() const { return tile_rewrites.size(); }
+    [[nodiscard]] uint64_t ticks() const { return tick_count; }
+    [[nodiscard]] const std::vector<uint64_t>& rewrites() const { return tile_rewrites; }
+
+    // Zápis z paralelního taktu (dlaždice patří jedinému vláknu)
+    inline void add(size_t tile, uint64_t rewrites) { tile_rewrites[tile] += rewrites; }
+    inline void end_tick() { ++tick_count; }
+
+    void reset() {
+        std::fill(tile_rewrites.begin(), tile_rewrites.end(), 0);
+        tick_count = 0;
+    }
+
+    // CSV: tile, first_cell, rewrites, rewrites_per_tick
+    void write_csv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("ActivityMap: cannot open " + path);
+        out << "tile,first_cell,rewrites,rewrites_per_tick\n";
+        for (size_t t = 0; t < tile_rewrites.size(); ++t) {
+            double per_tick = tick_count ? double(tile_rewrites[t]) / double(tick_count) : 0.0;
+            out << t << ',' << t * cells_per_tile() << ',' << tile_rewrites[t] << ',' << per_tick << '\n';
+        }
+    }
+};
+
+#endif // DIFP_ACTIVITY_HPP
@@ -0,0 +1,14 @@
+#include "bitsliced_ensemble.hpp"
+
+// Transpozice 64x64 bitů: v každém kroku se prohodí mimodiagonální bloky velikosti j.
+// Maska m vybírá "dolní" polovinu každého bloku (32 -> 16 -> ... -> 1 bit).
+void transpose64(uint64_t a[64]) {
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
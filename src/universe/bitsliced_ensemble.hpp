@@ -0,0 +1,167 @@
+#ifndef DIFP_BITSLICED_ENSEMBLE_HPP
+#define DIFP_BITSLICED_ENSEMBLE_HPP
+
+#include "rewrite_rule.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * @brief Transpozice bitové matice 64x64 na místě.
+ * @details Po volání platí: bit i slova a[u] == původní bit u slova a[i].
+ *          Rekurzivní výměna bloků 32/16/8/4/2/1 (Hacker's Delight), 6 * 32 operací.
+ */
+void transpose64(uint64_t a[64]);
+
+/**
+ * @struct LaneWord
+ * @brief Svazek W 64-bitových slov, se kterým se zachází jako s jedním širokým registrem.
+ * @details W = 1 -> 64 vesmírů (GPR), W = 8 -> 512 vesmírů (jeden zmm registr AVX-512).
+ *          Smyčky přes W mají pevnou délku, kompilátor je s -march=native
+ *          přeloží na jedinou vektorovou instrukci.
+ */
+template <size_t W>
+struct alignas(W * sizeof(uint64_t)) LaneWord {
+    uint64_t w[W];
+};
+
+/**
+ * @struct UniverseStats
+ * @brief Souhrnné statistiky jednoho vesmíru souboru.
+ */
+struct UniverseStats {
+    uint64_t particles = 0; // Počet jedniček (zachovává se)
+    double mean_x = 0.0;    // Těžiště ve směru x (0 pro prázdný vesmír)
+    double mean_y = 0.0;    // Těžiště ve směru y
+};
+
+/**
+ * @class BitslicedEnsemble
+ * @brief Soubor (ensemble) nezávislých vesmírů v bitově řezané (bit-sliced) reprezentaci.
+ * @tparam W Počet 64-bitových slov na buňku (počet vesmírů = 64 * W).
+ * @details Buňka idx je uložena jako LaneWord<W>; bit k patří vesmíru k.
+ *          Jeden průchod tick() tak aplikuje pravidlo rewrite() na všechny vesmíry
+ *          současně: podmínka "current == 1 && neighbor == 0" je maska m = c & ~n,
+ *          výměna je n |= m, c ^= m. Pořadí průchodu (zprava doleva) je stejné jako
+ *          v referenčním tick(), výsledek je proto bitově identický.
+ */
+template <size_t W = 1>
+class BitslicedEnsemble {
+private:
+    std::vector<LaneWord<W>> cells;
+
+public:
+    static constexpr size_t UNIVERSES = 64 * W;
+
+    size_t width;
+    size_t height;
+
+    BitslicedEnsemble(size_t w, size_t h) : cells(w * h, LaneWord<W>{}), width(w), height(h) {}
+
+    [[nodiscard]] size_t size() const { return cells.size(); }
+
+    [[nodiscard]] inline bool get_cell(size_t universe, size_t idx) const {
+        return (cells[idx].w[universe >> 6] >> (universe & 63)) & 1ULL;
+    }
+
+    inline void set_cell(size_t universe, size_t idx, bool val) {
+        uint64_t bit = 1ULL << (universe & 63);
+        if (val) cells[idx].w[universe >> 6] |= bit;
+        else     cells[idx].w[universe >> 6] &= ~bit;
+    }
+
+    // Načte počáteční podmínku jednoho vesmíru z klasické mřížky uzlů
+    void load_universe(size_t universe, const std::vector<Node>& grid) {
+        if (grid.size() != cells.size()) {
+            throw std::invalid_argument("BitslicedEnsemble: grid size mismatch.");
+        }
+        for (size_t i = 0; i < grid.size(); ++i) set_cell(universe, i, grid[i].state == 1);
+    }
+
+    // Zpětný převod jednoho vesmíru na mřížku uzlů (hustota = 1.0)
+    void store_universe(size_t universe, std::vector<Node>& grid) const {
+        grid.assign(cells.size(), Node{0, 1.0f});
+        for (size_t i = 0; i < cells.size(); ++i) grid[i].state = get_cell(universe, i) ? 1 : 0;
+    }
+
+    /**
+     * @brief Jeden takt pro všech 64 * W vesmírů.
+     */
+    void tick() {
+        if (width < 2) return;
+        for (size_t y = 0; y < height; ++y) {
+            LaneWord<W>* __restrict row = cells.data() + y * width;
+            for (size_t x = width - 1; x-- > 0;) {
+                LaneWord<W>& cur = row[x];
+                LaneWord<W>& next = row[x + 1];
+                // Pevná délka W -> jedna vektorová operace na buňku
+                for (size_t j = 0; j < W; ++j) {
+                    uint64_t moved = cur.w[j] & ~next.w[j];
+                    next.w[j] |= moved;
+                    cur.w[j] ^= moved;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Transpozice souboru na bitová pole jednotlivých vesmírů.
+     * @return Pro každý vesmír bitově pakované pole (stejný formát jako DIFPGrid::state_bits),
+     *         uložené za sebou: vesmír u začíná na indexu u * ((size() + 63) / 64).
+     */
+    [[nodiscard]] std::vector<uint64_t> transpose_to_universes() const {
+        const size_t n = cells.size();
+        const size_t blocks = (n + 63) / 64;
+        std::vector<uint64_t> out(UNIVERSES * blocks, 0);
+
+        alignas(64) uint64_t block[64];
+        for (size_t b = 0; b < blocks; ++b) {
+            const size_t base = b * 64;
+            const size_t count = (n - base < 64) ? (n - base) : 64;
+            for (size_t j = 0; j < W; ++j) {
+                // Řádek i bloku = slovo j buňky base + i (bit u = vesmír 64j + u)
+                for (size_t i = 0; i < count; ++i) block[i] = cells[base + i].w[j];
+                for (size_t i = count; i < 64; ++i) block[i] = 0;
+                transpose64(block);
+                // Řádek u = 64 buněk vesmíru 64j + u
+                for (size_t u = 0; u < 64; ++u) out[(j * 64 + u) * blocks + b] = block[u];
+            }
+        }
+        return out;
+    }
+
+    /**
+     * @brief Statistiky všech vesmírů získané z transponované reprezentace.
+     * @details Počet částic přes popcount, těžiště průchodem nastavených bitů (ctz).
+     */
+    [[nodiscard]] std::vector<UniverseStats> statistics() const {
+        const size_t blocks = (cells.size() + 63) / 64;
+        const std::vector<uint64_t> planes = transpose_to_universes();
+        std::vector<UniverseStats> stats(UNIVERSES);
+
+        for (size_t u = 0; u < UNIVERSES; ++u) {
+            const uint64_t* plane = planes.data() + u * blocks;
+            uint64_t count = 0;
+            double sum_x = 0.0, sum_y = 0.0;
+            for (size_t b = 0; b < blocks; ++b) {
+                uint64_t bits = plane[b];
+                count += static_cast<uint64_t>(__builtin_popcountll(bits));
+                while (bits) {
+                    size_t idx = b * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+                    sum_x += static_cast<double>(idx % width);
+                    sum_y += static_cast<double>(idx / width);
+                    bits &= bits - 1;
+                }
+            }
+            stats[u].particles = count;
+            if (count) {
+                stats[u].mean_x = sum_x / static_cast<double>(count);
+                stats[u].mean_y = sum_y / static_cast<double>(count);
+            }
+        }
+        return stats;
+    }
+};
+
+#endif // DIFP_BITSLICED_ENSEMBLE_HPP
@@ -0,0 +1,59 @@
+#include "cycle_detector.hpp"
+
+bool CycleDetector::observe(uint64_t tick, uint64_t hash, CycleInfo& cycle) {
+    auto it = history.find(hash);
+    if (it != history.end()) {
+        cycle.start = it->second;
+        cycle.period = tick - it->second;
+        return true;
+    }
+    if (history.size() >= capacity) history.clear();
+    history.emplace(hash, tick);
+    return false;
+}
+
+RunSummary run_with_cycle_detection(PackedUniverse& universe, uint64_t ticks, CycleDetector& detector) {
+    RunSummary summary;
+    summary.ticks_requested = ticks;
+
+    uint64_t t = 0;
+    CycleInfo candidate;
+    detector.observe(t, universe.hash(), candidate);
+
+    while (t < ticks) {
+        universe.tick_parallel();
+        ++t;
+        ++summary.ticks_executed;
+
+        if (!detector.observe(t, universe.hash(), candidate)) continue;
+
+        // Ověření kandidáta: po jedné periodě se musí stav bitově zopakovat.
+        // Ověřovací takty jsou zároveň skutečné takty běhu (nic se nezahazuje).
+        const PackedUniverse snapshot = universe;
+        uint64_t verified = 0;
+        while (verified < candidate.period && t < ticks) {
+            universe.tick_parallel();
+            ++t;
+            ++verified;
+            ++summary.ticks_executed;
+        }
+        if (t >= ticks) break;
+
+        if (universe.words() != snapshot.words()) {
+            // Kolize hashe – pokračujeme s čistou historií
+            detector.reset();
+            detector.observe(t, universe.hash(), candidate);
+            continue;
+        }
+
+        summary.cycle_found = true;
+        summary.cycle = candidate;
+
+        // Zbytek běhu je periodický: stačí dopočítat zbytek po dělení periodou
+        uint64_t remaining = (ticks - t) % candidate.period;
+        for (uint64_t i = 0; i < remaining; ++i) universe.tick_parallel();
+        summary.ticks_executed += remaining;
+        break;
+    }
+    return summary;
+}
@@ -0,0 +1,61 @@
+#ifndef DIFP_CYCLE_DETECTOR_HPP
+#define DIFP_CYCLE_DETECTOR_HPP
+
+#include "packed_universe.hpp"
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @struct CycleInfo
+ * @brief Periodická orbita: stav v taktu start + period je shodný se stavem v taktu start.
+ */
+struct CycleInfo {
+    uint64_t start = 0;
+    uint64_t period = 0;
+};
+
+/**
+ * @class CycleDetector
+ * @brief Tabulka historie hashů stavu (hash -> takt prvního výskytu).
+ * @details Paměť je omezená kapacitou: při zaplnění se tabulka vyprázdní a sbírá znovu.
+ *          Orbita s periodou menší než kapacita se tak najde nejvýše o kapacitu taktů později.
+ */
+class CycleDetector {
+private:
+    std::unordered_map<uint64_t, uint64_t> history;
+    size_t capacity;
+
+public:
+    explicit CycleDetector(size_t max_entries = size_t(1) << 20) : capacity(max_entries) {
+        history.reserve(capacity);
+    }
+
+    // Zaznamená hash stavu v daném taktu. Vrací true, pokud se hash už vyskytl (kandidát orbity).
+    bool observe(uint64_t tick, uint64_t hash, CycleInfo& cycle);
+
+    // Zapomene kandidáta (kolize hashe) – další výskyt se bere jako nový
+    void reset() { history.clear(); }
+};
+
+/**
+ * @struct RunSummary
+ * @brief Výsledek běhu s detekcí cyklů.
+ */
+struct RunSummary {
+    uint64_t ticks_requested = 0;
+    uint64_t ticks_executed = 0; // Skutečně spočtené takty (včetně ověření orbity)
+    bool cycle_found = false;
+    CycleInfo cycle;
+};
+
+/**
+ * @brief Provede 'ticks' taktů, ale po nalezení orbity zbytek přeskočí.
+ * @details Kandidát z tabulky hashů se ověří porovnáním stavů po jedné periodě
+ *          (kolize 64-bitového hashe tak nemůže zkreslit výsledek). Potvrzená orbita
+ *          zkrátí zbytek běhu na (zbytek mod perioda) taktů – konečný stav je
+ *          bitově shodný s plným během. Pevný bod (perioda 1) běh rovnou ukončí.
+ */
+RunSummary run_with_cycle_detection(PackedUniverse& universe, uint64_t ticks, CycleDetector& detector);
+
+#endif // DIFP_CYCLE_DETECTOR_HPP
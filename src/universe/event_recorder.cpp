@@ -0,0 +1,215 @@
+#include "event_recorder.hpp"
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'D', 'I', 'F', 'P', 'E', 'V', 'T', '1'};
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+} // namespace
+
+EventRecorder::EventRecorder(const std::string& path, size_t max_producers, size_t events_per_batch)
+    : batch_events(events_per_batch ? events_per_batch : 1) {
+    if (max_producers == 0) {
+        max_producers = 1;
+#ifdef _OPENMP
+        max_producers = static_cast<size_t>(omp_get_max_threads());
+#endif
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) throw std::runtime_error("EventRecorder: cannot open " + path);
+    std::fwrite(FILE_MAGIC, 1, sizeof(FILE_MAGIC), file);
+
+    producers.reserve(max_producers);
+    for (size_t i = 0; i < max_producers; ++i) {
+        producers.push_back(std::make_unique<Producer>());
+        producers.back()->current = acquire(*producers.back());
+    }
+
+    writer = std::thread(&EventRecorder::writer_loop, this);
+}
+
+EventRecorder::~EventRecorder() {
+    flush();
+    running.store(false, std::memory_order_release);
+    writer.join();
+    std::fclose(file);
+}
+
+EventBatch* EventRecorder::acquire(Producer& p) {
+    EventBatch* batch = nullptr;
+    if (!p.spare.pop(batch)) {
+        p.owned.push_back(std::make_unique<EventBatch>());
+        batch = p.owned.back().get();
+        // Počáteční kapacita ~2 B/událost, aby se sloupec během dávky nerealokoval
+        batch->from_col.resize(batch_events * 2 + 64);
+        batch->to_col.resize(64);
+    }
+    batch->reset(tick_index);
+    return batch;
+}
+
+// Odešle aktuální dávku (volá vlákno, které vlastní producenta)
+void EventRecorder::submit(Producer& p) {
+    EventBatch* batch = p.current;
+    if (batch->count == 0) return;
+    batch->flush_run();
+    p.recorded += batch->count;
+    ++p.submitted;
+
+    // Nejdřív starší dávky, aby zůstalo pořadí v rámci producenta
+    size_t sent = 0;
+    while (sent < p.pending.size() && p.ready.push(p.pending[sent])) ++sent;
+    p.pending.erase(p.pending.begin(), p.pending.begin() + static_cast<std::ptrdiff_t>(sent));
+    if (!p.pending.empty() || !p.ready.push(batch)) p.pending.push_back(batch);
+
+    p.current = acquire(p);
+}
+
+void EventRecorder::on_tick_begin(size_t n_chunks) {
+    if (n_chunks > producers.size()) {
+        throw std::length_error("EventRecorder: more tick chunks than producers.");
+    }
+    for (auto& p : producers) p->current->tick = tick_index;
+}
+
+void EventRecorder::on_chunk_end(size_t chunk) {
+    submit(*producers[chunk]);
+}
+
+void EventRecorder::on_tick_end() {
+    ++tick_index;
+}
+
+uint64_t EventRecorder::events_recorded() const {
+    uint64_t total = 0;
+    for (const auto& p : producers) total += p->recorded;
+    return total;
+}
+
+size_t EventRecorder::pool_bytes() const {
+    size_t bytes = 0;
+    for (const auto& p : producers) {
+        for (const auto& batch : p->owned) {
+            bytes += sizeof(EventBatch) + batch->from_col.capacity() + batch->to_col.capacity();
+        }
+    }
+    return bytes;
+}
+
+void EventRecorder::flush() {
+    uint64_t expected = 0;
+    for (auto& p : producers) {
+        submit(*p);
+        // Mezi takty producent nepracuje – čekající dávky lze dotlačit z tohoto vlákna
+        for (EventBatch* batch : p->pending) {
+            while (!p->ready.push(batch)) std::this_thread::yield();
+        }
+        p->pending.clear();
+        expected += p->submitted;
+    }
+    while (written_batches.load(std::memory_order_acquire) < expected) std::this_thread::yield();
+    std::fflush(file);
+}
+
+void EventRecorder::writer_loop() {
+    for (;;) {
+        bool any = false;
+        for (auto& p : producers) {
+            EventBatch* batch = nullptr;
+            while (p->ready.pop(batch)) {
+                uint32_t header[3] = {batch->count, static_cast<uint32_t>(batch->from_used),
+                                      static_cast<uint32_t>(batch->to_used)};
+                std::fwrite(&batch->tick, sizeof(batch->tick), 1, file);
+                std::fwrite(header, sizeof(header), 1, file);
+                std::fwrite(batch->from_col.data(), 1, batch->from_used, file);
+                std::fwrite(batch->to_col.data(), 1, batch->to_used, file);
+                written_bytes.fetch_add(sizeof(batch->tick) + sizeof(header) + batch->from_used + batch->to_used,
+                                        std::memory_order_relaxed);
+
+                // Recyklace; pokud je vratná fronta plná, dávka zůstane nevyužitá v owned
+                p->spare.push(batch);
+                written_batches.fetch_add(1, std::memory_order_release);
+                any = true;
+            }
+        }
+        if (!any) {
+            if (!running.load(std::memory_order_acquire)) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+bool read_events(const std::string& path,
+                 const std::function<void(const RewriteEvent* events, size_t count)>& sink) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[8];
+    bool ok = std::fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+              std::memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0;
+
+    std::vector<uint8_t> buffer;
+    std::vector<RewriteEvent> decoded;
+    while (ok) {
+        uint64_t tick;
+        uint32_t header[3];
+        if (std::fread(&tick, sizeof(tick), 1, f) != 1) break; // Konec souboru
+        if (std::fread(header, sizeof(header), 1, f) != 1) { ok = false; break; }
+
+        buffer.resize(size_t(header[1]) + header[2]);
+        if (std::fread(buffer.data(), 1, buffer.size(), f) != buffer.size()) { ok = false; break; }
+
+        const uint8_t* fp = buffer.data();
+        const uint8_t* fend = fp + header[1];
+        const uint8_t* tp = fend;
+        const uint8_t* tend = tp + header[2];
+
+        decoded.clear();
+        uint64_t from = 0, run_left = 0;
+        int64_t offset = 0;
+        for (uint32_t i = 0; i < header[0] && ok; ++i) {
+            uint64_t v;
+            if (!get_varint(fp, fend, v)) { ok = false; break; }
+            from += static_cast<uint64_t>(unzigzag(v));
+            if (run_left == 0) {
+                uint64_t z;
+                if (!get_varint(tp, tend, z) || !get_varint(tp, tend, run_left) || run_left == 0) {
+                    ok = false;
+                    break;
+                }
+                offset = unzigzag(z);
+            }
+            --run_left;
+            decoded.push_back({tick, from, from + static_cast<uint64_t>(offset)});
+        }
+        if (ok) sink(decoded.data(), decoded.size());
+    }
+    std::fclose(f);
+    return ok;
+}
+
+bool read_events(const std::string& path, std::vector<RewriteEvent>& out) {
+    return read_events(path, [&out](const RewriteEvent* events, size_t count) {
+        out.insert(out.end(), events, events + count);
+    });
+}
@@ -0,0 +1,193 @@
+#ifndef DIFP_EVENT_RECORDER_HPP
+#define DIFP_EVENT_RECORDER_HPP
+
+#include "DIFP_Observers.hpp"
+#include "io/spsc_ring.hpp"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <functional>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @struct RewriteEvent
+ * @brief Jeden přepis: v taktu tick se kvantum přesunulo z uzlu from do uzlu to.
+ */
+struct RewriteEvent {
+    uint64_t tick;
+    uint64_t from;
+    uint64_t to;
+};
+
+/**
+ * @struct EventBatch
+ * @brief Sloupcová dávka událostí jednoho taktu z jednoho bloku (vlákna).
+ * @details Sloupec from: zigzag delta + varint (v bloku jdou indexy sestupně, delta je malá).
+ *          Sloupec to: run-length páry (zigzag(to - from), délka běhu) – pro pravidlo
+ *          rewrite() je to - from vždy 1, celý sloupec je tedy jediný pár.
+ */
+struct EventBatch {
+    uint64_t tick = 0;
+    uint32_t count = 0;
+    std::vector<uint8_t> from_col;
+    std::vector<uint8_t> to_col;
+    size_t from_used = 0;
+    size_t to_used = 0;
+
+    // Stav kodéru
+    uint64_t prev_from = 0;
+    int64_t run_value = 0;
+    uint64_t run_length = 0;
+
+    static inline uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    static inline size_t put_varint(uint8_t* dst, uint64_t v) {
+        size_t n = 0;
+        while (v >= 0x80) {
+            dst[n++] = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        dst[n++] = static_cast<uint8_t>(v);
+        return n;
+    }
+
+    inline void flush_run() {
+        if (!run_length) return;
+        if (to_used + 20 > to_col.size()) to_col.resize(to_col.size() * 2 + 64);
+        to_used += put_varint(to_col.data() + to_used, zigzag(run_value));
+        to_used += put_varint(to_col.data() + to_used, run_length);
+        run_length = 0;
+    }
+
+    inline void append(uint64_t from, uint64_t to) {
+        if (from_used + 10 > from_col.size()) from_col.resize(from_col.size() * 2 + 64);
+        from_used += put_varint(from_col.data() + from_used,
+                                zigzag(static_cast<int64_t>(from - prev_from)));
+        prev_from = from;
+
+        int64_t offset = static_cast<int64_t>(to - from);
+        if (run_length && offset == run_value) {
+            ++run_length;
+        } else {
+            flush_run();
+            run_value = offset;
+            run_length = 1;
+        }
+        ++count;
+    }
+
+    void reset(uint64_t t) {
+        tick = t;
+        count = 0;
+        from_used = to_used = 0;
+        prev_from = 0;
+        run_value = 0;
+        run_length = 0;
+    }
+};
+
+/**
+ * @class EventRecorder
+ * @brief Záznam každého přepisu (tick, from, to) do souboru na pozadí.
+ * @details Je to pozorovatel (DIFP_Observers.hpp): připojí se k tick() nebo
+ *          PackedUniverse::tick_parallel(). Každý blok taktu kóduje události do vlastní
+ *          dávky (bez zámků, ve vlákně, které blok počítá) a hotovou dávku předá
+ *          přes SPSC frontu zapisovacímu vláknu. Je-li fronta plná, dávka čeká v lokálním
+ *          seznamu producenta – takt se nikdy nezastaví, jen dočasně vzroste paměť.
+ *
+ *          Formát souboru: "DIFPEVT1", pak dávky
+ *          [u64 tick][u32 count][u32 from_bytes][u32 to_bytes][from sloupec][to sloupec].
+ */
+class EventRecorder : public NullObserver {
+private:
+    static constexpr size_t QUEUE_DEPTH = 64;
+
+    struct Producer {
+        SpscRing<EventBatch*, QUEUE_DEPTH> ready; // Producent -> zapisovač
+        SpscRing<EventBatch*, QUEUE_DEPTH> spare; // Zapisovač -> producent (recyklace)
+        std::vector<std::unique_ptr<EventBatch>> owned;
+        std::vector<EventBatch*> pending; // Dávky, které se nevešly do plné fronty
+        EventBatch* current = nullptr;
+        uint64_t submitted = 0; // Odeslané dávky
+        uint64_t recorded = 0;  // Odeslané události
+    };
+
+    std::vector<std::unique_ptr<Producer>> producers;
+    size_t batch_events;
+    uint64_t tick_index = 0;
+
+    std::FILE* file = nullptr;
+    std::thread writer;
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> written_batches{0};
+    std::atomic<uint64_t> written_bytes{0};
+
+    EventBatch* acquire(Producer& p);
+    void submit(Producer& p);
+    void writer_loop();
+
+public:
+    /**
+     * @param path Výstupní soubor.
+     * @param max_producers Maximální počet bloků taktu (0 = počet vláken OpenMP).
+     * @param events_per_batch Po kolika událostech se dávka odešle i uprostřed bloku.
+     */
+    explicit EventRecorder(const std::string& path, size_t max_producers = 0,
+                           size_t events_per_batch = size_t(1) << 16);
+    ~EventRecorder();
+
+    EventRecorder(const EventRecorder&) = delete;
+    EventRecorder& operator=(const EventRecorder&) = delete;
+
+    // --- Háčky pozorovatele ---
+    void on_tick_begin(size_t n_chunks);
+
+    inline void on_word(size_t chunk, size_t k, uint64_t /*before*/, uint64_t /*after*/, uint64_t moved) {
+        Producer& p = *producers[chunk];
+        // Bity sestupně: v rámci bloku tvoří indexy klesající posloupnost
+        while (moved) {
+            unsigned b = 63u - static_cast<unsigned>(__builtin_clzll(moved));
+            uint64_t from = k * 64 + b;
+            p.current->append(from, from + 1);
+            if (p.current->count >= batch_events) submit(p);
+            moved &= ~(1ULL << b);
+        }
+    }
+
+    inline void on_rewrite(size_t from, size_t to) {
+        Producer& p = *producers[0];
+        p.current->append(from, to);
+        if (p.current->count >= batch_events) submit(p);
+    }
+
+    void on_chunk_end(size_t chunk);
+    void on_tick_end();
+
+    // Počká, až zapisovač uloží vše odeslané (volat mezi takty)
+    void flush();
+
+    // Počet odeslaných událostí (volat mezi takty)
+    [[nodiscard]] uint64_t events_recorded() const;
+    [[nodiscard]] uint64_t bytes_written() const { return written_bytes.load(); }
+
+    // Paměť fondu dávek všech producentů (volat mezi takty)
+    [[nodiscard]] size_t pool_bytes() const;
+};
+
+/**
+ * @brief Proudové čtení souboru událostí po dávkách (paměť omezená velikostí dávky).
+ * @return false, pokud soubor nelze otevřít nebo je poškozený.
+ */
+bool read_events(const std::string& path,
+                 const std::function<void(const RewriteEvent* events, size_t count)>& sink);
+
+// Přečte celý soubor do paměti (jen pro menší záznamy)
+bool read_events(const std::string& path, std::vector<RewriteEvent>& out);
+
+#endif // DIFP_EVENT_RECORDER_HPP
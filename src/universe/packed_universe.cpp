@@ -0,0 +1,52 @@
+#include "packed_universe.hpp"
+#include "state_hash.hpp"
+#include <algorithm>
+
+PackedUniverse::PackedUniverse(size_t w, size_t h)
+    : bits((w * h + 63) / 64, 0), scratch((w * h + 63) / 64, 0), width(w), height(h), cells(w * h) {}
+
+size_t PackedUniverse::memory_bytes() const {
+    return (bits.capacity() + scratch.capacity()) * sizeof(uint64_t) + chunk_transfer.capacity() +
+           chunk_carry_in.capacity();
+}
+
+size_t PackedUniverse::memory_bytes_for(size_t w, size_t h) {
+    return 2 * ((w * h + 63) / 64) * sizeof(uint64_t);
+}
+
+uint64_t PackedUniverse::hash() const {
+    if (!hash_valid) {
+        state_hash = hash_words(bits);
+        hash_valid = true;
+    }
+    return state_hash;
+}
+
+void PackedUniverse::load(const std::vector<Node>& grid) {
+    std::fill(bits.begin(), bits.end(), 0);
+    hash_valid = false;
+    for (size_t i = 0; i < cells && i < grid.size(); ++i) set_state(i, grid[i].state == 1);
+}
+
+void PackedUniverse::store(std::vector<Node>& grid) const {
+    grid.assign(cells, Node{0, 1.0f});
+    for (size_t i = 0; i < cells; ++i) grid[i].state = get_state(i) ? 1 : 0;
+}
+
+void PackedUniverse::tick_serial() {
+    if (width < 2) return;
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = width - 1; x-- > 0;) {
+            size_t idx = y * width + x;
+            if (get_state(idx) && !get_state(idx + 1)) {
+                set_state(idx + 1, true);
+                set_state(idx, false);
+            }
+        }
+    }
+}
+
+void PackedUniverse::tick_parallel() {
+    NullObserver none;
+    tick_parallel(none);
+}
@@ -0,0 +1,199 @@
+#ifndef DIFP_PACKED_UNIVERSE_HPP
+#define DIFP_PACKED_UNIVERSE_HPP
+
+#include "rewrite_rule.hpp"
+#include "activity.hpp"
+#include "segmented_scan.hpp"
+#include "state_hash.hpp"
+#include "DIFP_Observers.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @class PackedUniverse
+ * @brief Informační vesmír s 1 bitem na uzel (stejný formát jako DIFPGrid::state_bits).
+ * @details Buňka idx = y * width + x leží v bitu (idx & 63) slova (idx >> 6).
+ *
+ *          Sekvenční průchod tick() zprava doleva je řetězec závislostí, ale jeho
+ *          výsledek má uzavřený tvar: každá jednička se posune o jeden uzel doprava,
+ *          kromě souvislého běhu jedniček, který končí na pravém okraji řádku
+ *          ("zaseknutý" běh nemá kam ustoupit a zůstává na místě):
+ *
+ *              new = (s << 1) & ~row_start  |  stuck
+ *
+ *          Posun je lokální (přenos jednoho bitu mezi sousedními slovy), zaseknutý běh
+ *          je segmentovaný sufixový AND v rámci řádku. Ten se počítá paralelním scanem:
+ *          každé slovo je přenosová funkce {const0, const1, identita} nad bitem
+ *          "vše vpravo až do konce řádku jsou jedničky", funkce se skládají asociativně.
+ */
+class PackedUniverse {
+private:
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> scratch; // Cílový buffer paralelního taktu (double buffering)
+
+    // Přenosové funkce a vstupní přenosy bloků taktu (znovupoužité mezi takty)
+    std::vector<uint8_t> chunk_transfer;
+    std::vector<uint8_t> chunk_carry_in;
+
+    // Hash stavu (viz state_hash.hpp). Přímé zápisy ho zneplatní, tick_parallel()
+    // ho udržuje inkrementálně jen přes slova, která se skutečně změnila.
+    mutable uint64_t state_hash = 0;
+    mutable bool hash_valid = false;
+
+    // Čítače posledního taktu a volitelná tepelná mapa (nevlastněná)
+    TickCounters counters;
+    ActivityMap* activity = nullptr;
+
+public:
+    size_t width;
+    size_t height;
+    size_t cells; // width * height
+
+    PackedUniverse(size_t w, size_t h);
+
+    [[nodiscard]] inline bool get_state(size_t idx) const {
+        return (bits[idx >> 6] >> (idx & 63)) & 1ULL;
+    }
+
+    inline void set_state(size_t idx, bool val) {
+        hash_valid = false;
+        if (val) bits[idx >> 6] |= (1ULL << (idx & 63));
+        else     bits[idx >> 6] &= ~(1ULL << (idx & 63));
+    }
+
+    [[nodiscard]] const std::vector<uint64_t>& words() const { return bits; }
+
+    // Paměť stavu, cílového bufferu a pomocných polí bloků; odhad pro vesmír w x h
+    [[nodiscard]] size_t memory_bytes() const;
+    [[nodiscard]] static size_t memory_bytes_for(size_t w, size_t h);
+
+    // Hash aktuálního stavu (po zneplatnění se jednou přepočítá celý)
+    [[nodiscard]] uint64_t hash() const;
+
+    // Čítače posledního tick_parallel()
+    [[nodiscard]] const TickCounters& last_tick() const { return counters; }
+
+    // Připojí tepelnou mapu (nullptr = odpojit); mapa musí přežít připojení
+    void attach_activity_map(ActivityMap* map) { activity = map; }
+
+    // Převod z/do klasické mřížky uzlů
+    void load(const std::vector<Node>& grid);
+    void store(std::vector<Node>& grid) const;
+
+    // Referenční takt: doslovný průchod zprava doleva, bit po bitu
+    void tick_serial();
+
+    // Paralelní takt: posun + segmentovaný scan, rozdělený přes vlákna (OpenMP)
+    void tick_parallel();
+
+    // Totéž s pozorovatelem vloženým do vnitřní smyčky (viz DIFP_Observers.hpp)
+    template <typename Observer>
+    void tick_parallel(Observer& observer);
+};
+
+template <typename Observer>
+void PackedUniverse::tick_parallel(Observer& observer) {
+    using namespace segscan;
+
+    const size_t n_words = bits.size();
+    if (n_words == 0 || width < 2) return;
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    // S tepelnou mapou se bloky zarovnají na celé dlaždice
+    const size_t tile_words = activity ? activity->words_per_tile() : 1;
+    size_t chunk = (n_words + static_cast<size_t>(threads) - 1) / static_cast<size_t>(threads);
+    chunk = (chunk + tile_words - 1) & ~(tile_words - 1);
+    const size_t n_chunks = (n_words + chunk - 1) / chunk;
+
+    const uint64_t* __restrict in = bits.data();
+    uint64_t* __restrict out = scratch.data();
+    // Pomocná pole bloků jsou členy: assign() se stejným počtem bloků nealokuje
+    chunk_transfer.assign(n_chunks, CARRY_IDENTITY);
+    chunk_carry_in.assign(n_chunks, 0);
+
+    observer.on_tick_begin(n_chunks);
+
+    // 1) Přenosová funkce každého bloku slov (paralelně)
+    #pragma omp parallel for schedule(static)
+    for (size_t c = 0; c < n_chunks; ++c) {
+        size_t k0 = c * chunk;
+        size_t k1 = std::min(n_words, k0 + chunk);
+        if (k0 >= k1) continue;
+        RowCursor cursor(width, cells, k1 - 1);
+        uint8_t f = CARRY_IDENTITY;
+        for (size_t k = k1; k-- > k0;) {
+            cursor.step_down(k);
+            f = compose_carry(word_transfer(in[k], cursor.end_mask(k)), f);
+        }
+        chunk_transfer[c] = f;
+    }
+
+    // 2) Exkluzivní scan přes bloky (sériově, jen n_chunks kroků)
+    bool carry = false; // Za posledním slovem už žádný řádek nepokračuje
+    for (size_t c = n_chunks; c-- > 0;) {
+        chunk_carry_in[c] = carry;
+        carry = apply_carry(chunk_transfer[c], carry);
+    }
+
+    // 3) Posun o jednu buňku + doplnění zaseknutých běhů (paralelně)
+    const bool track_hash = hash_valid;
+    ActivityMap* const heat = activity;
+    uint64_t hash_delta = 0;
+    uint64_t rewrites = 0, active_words = 0, active_tiles = 0;
+    #pragma omp parallel for schedule(static) reduction(^ : hash_delta) reduction(+ : rewrites, active_words, active_tiles)
+    for (size_t c = 0; c < n_chunks; ++c) {
+        size_t k0 = c * chunk;
+        size_t k1 = std::min(n_words, k0 + chunk);
+        if (k0 >= k1) continue;
+        RowCursor cursor(width, cells, k1 - 1);
+        bool carry_in = chunk_carry_in[c];
+        uint64_t tile_sum = 0;
+        for (size_t k = k1; k-- > k0;) {
+            cursor.step_down(k);
+            uint64_t x = in[k];
+            uint64_t ends = cursor.end_mask(k);
+            uint64_t row_start = (ends << 1) | (cursor.starts_row(k) ? 1ULL : 0ULL);
+            uint64_t shifted = (x << 1) | (k ? (in[k - 1] >> 63) : 0ULL);
+
+            uint64_t stuck = (ends || carry_in) ? word_stuck(x, ends, carry_in) : 0ULL;
+            uint64_t next = (shifted & ~row_start) | stuck;
+            out[k] = next;
+
+            // Každá jednička mimo zaseknutý běh je právě jeden přepis
+            uint64_t moved_mask = x & ~stuck;
+            uint64_t moved = static_cast<uint64_t>(__builtin_popcountll(moved_mask));
+            rewrites += moved;
+            if (next != x) {
+                ++active_words;
+                if (track_hash) hash_delta ^= word_key(k, x) ^ word_key(k, next);
+            }
+            if (heat) {
+                tile_sum += moved;
+                if ((k & (tile_words - 1)) == 0) {
+                    heat->add(k / tile_words, tile_sum);
+                    if (tile_sum) ++active_tiles;
+                    tile_sum = 0;
+                }
+            }
+            observer.on_word(c, k, x, next, moved_mask);
+            carry_in = apply_carry(word_transfer(x, ends), carry_in);
+        }
+        observer.on_chunk_end(c);
+    }
+
+    bits.swap(scratch);
+    state_hash ^= hash_delta;
+    counters = {rewrites, active_words, active_tiles};
+    if (activity) activity->end_tick();
+    observer.on_tick_end();
+}
+
+#endif // DIFP_PACKED_UNIVERSE_HPP
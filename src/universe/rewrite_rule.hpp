@@ -0,0 +1,71 @@
+#ifndef DIFP_REWRITE_RULE_HPP
+#define DIFP_REWRITE_RULE_HPP
+
+#include <vector>
+#include <cstdint> // Pro přesné datové typy jako uint8_t
+#include "DIFP_Observers.hpp"
+
+/**
+ * STRUKTURA: Node (Uzel mřížky)
+ * Reprezentuje nejmenší kvantum prostoru.
+ * V tvé teorii uzel nemá paměť, jen aktuální stav.
+ */
+struct Node {
+    // 0 = volný prostor (vakuum), 1 = aktivní informace (hmota)
+    uint8_t state;
+
+    // density reprezentuje "zahuštění" mřížky v tomto bodě.
+    // V budoucnu bude ovlivňovat, kolik taktů musí uzel "čekat", než provede přepis.
+    float density;
+};
+
+/**
+ * FUNKCE: rewrite (Informační přepis)
+ * Toto je srdce tvého vesmíru. Implementuje princip výměny 1:1.
+ * Informace se nepohybuje "skrze" prostor, ale body si vymění stavy.
+ */
+inline bool rewrite(Node& current, Node& neighbor) {
+    // Pokud je cílový uzel volný (stav 0), proběhne výměna.
+    // Hmota (1) se přesune vpřed, prázdnota (0) se vrátí dozadu.
+    if (current.state == 1 && neighbor.state == 0) {
+        neighbor.state = 1;
+        current.state = 0;
+        // Poznámka: Zde se zachovává zákon zachování informace.
+        // Počet jedniček v systému zůstává konstantní.
+        return true;
+    }
+    return false;
+}
+
+/**
+ * FUNKCE: tick (Planckův čas / Takt)
+ * Představuje jeden nejmenší časový úsek vesmíru.
+ * Během jednoho taktu proběhne v mřížce jedna vlna přepisů.
+ * Referenční (skalární) implementace – ostatní enginy se proti ní ověřují.
+ * Pozorovatel (viz DIFP_Observers.hpp) dostane každý provedený přepis.
+ */
+template <typename Observer>
+inline void tick(std::vector<Node>& grid, int width, int height, Observer& observer) {
+    observer.on_tick_begin(1);
+    // Procházíme mřížku odzadu (zprava doleva), aby se nám
+    // informace v jednom taktu neposunula o víc než jeden uzel.
+    // To simuluje rychlostní limit 'c'.
+    for (int y = 0; y < height; ++y) {
+        for (int x = width - 2; x >= 0; --x) {
+            int idx = y * width + x;
+            int nextIdx = y * width + (x + 1);
+
+            // Aplikujeme pravidlo přepisu pro každý bod a jeho pravého souseda
+            if (rewrite(grid[idx], grid[nextIdx])) observer.on_rewrite(idx, nextIdx);
+        }
+    }
+    observer.on_chunk_end(0);
+    observer.on_tick_end();
+}
+
+inline void tick(std::vector<Node>& grid, int width, int height) {
+    NullObserver none;
+    tick(grid, width, height, none);
+}
+
+#endif // DIFP_REWRITE_RULE_HPP
@@ -0,0 +1,111 @@
+#ifndef DIFP_SEGMENTED_SCAN_HPP
+#define DIFP_SEGMENTED_SCAN_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Společné stavební bloky paralelních taktů nad bitově pakovanými řádky.
+ * Přenos mezi slovy teče shora dolů (zprava doleva, stejně jako sekvenční průchod)
+ * a každé slovo je přenosová funkce {const0, const1, identita}. Skládání je asociativní,
+ * takže bloky slov lze vyhodnotit paralelně a spojit krátkým sériovým scanem.
+ */
+namespace segscan {
+
+constexpr uint8_t CARRY_ZERO = 0;     // Výstup je vždy 0
+constexpr uint8_t CARRY_ONE = 1;      // Výstup je vždy 1
+constexpr uint8_t CARRY_IDENTITY = 2; // Přenos slovem projde beze změny
+
+inline bool apply_carry(uint8_t f, bool carry_in) {
+    return f == CARRY_IDENTITY ? carry_in : (f == CARRY_ONE);
+}
+
+// Složení g ∘ f (nejdřív f, potom g)
+inline uint8_t compose_carry(uint8_t g, uint8_t f) {
+    return g == CARRY_IDENTITY ? f : g;
+}
+
+// Bity [lo..hi] včetně
+inline uint64_t bit_range(unsigned lo, unsigned hi) {
+    uint64_t upper = (hi == 63) ? ~0ULL : ((1ULL << (hi + 1)) - 1);
+    return upper & (~0ULL << lo);
+}
+
+inline unsigned highest_bit(uint64_t v) {
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+}
+
+/**
+ * Kurzor přes konce řádků při průchodu slovy odshora dolů.
+ * row_end = poslední buňka řádku, který obsahuje první bit aktuálního slova.
+ * Pro šířku >= 64 je posun na předchozí slovo O(1), bez dělení.
+ */
+struct RowCursor {
+    size_t width;
+    size_t cells;
+    size_t row_end;
+
+    RowCursor(size_t w, size_t n, size_t word) : width(w), cells(n) {
+        size_t p = word * 64;
+        row_end = (p / width + 1) * width - 1;
+    }
+
+    void step_down(size_t word) {
+        size_t p = word * 64;
+        while (row_end >= p + width) row_end -= width;
+    }
+
+    // Maska konců řádků uvnitř slova
+    [[nodiscard]] uint64_t end_mask(size_t word) const {
+        uint64_t mask = 0;
+        size_t base = word * 64;
+        for (size_t e = row_end; e < base + 64 && e < cells; e += width) mask |= 1ULL << (e - base);
+        return mask;
+    }
+
+    // Začíná první bit slova nový řádek? (tj. bit 63 předchozího slova je konec řádku)
+    [[nodiscard]] bool starts_row(size_t word) const {
+        return row_end == word * 64 + width - 1;
+    }
+};
+
+// --- Jednorovinný případ (PackedUniverse): zaseknutý běh jedniček u konce řádku ---
+
+// Souvislý běh jedniček v x od bitu hi směrem dolů (nejvýše po bit lo)
+inline uint64_t run_down(uint64_t x, unsigned lo, unsigned hi) {
+    uint64_t seg = bit_range(lo, hi);
+    uint64_t zeros = ~x & seg;
+    if (!zeros) return seg;
+    unsigned hb = highest_bit(zeros);
+    return (hb == 63) ? 0 : (seg & (~0ULL << (hb + 1)));
+}
+
+// Přenosová funkce slova x s maskou konců řádků ends
+inline uint8_t word_transfer(uint64_t x, uint64_t ends) {
+    if (!ends) return (x == ~0ULL) ? CARRY_IDENTITY : CARRY_ZERO;
+    unsigned lowest_end = static_cast<unsigned>(__builtin_ctzll(ends));
+    uint64_t seg = bit_range(0, lowest_end);
+    return ((x & seg) == seg) ? CARRY_ONE : CARRY_ZERO;
+}
+
+// Zaseknuté bity slova: segmenty mezi konci řádků, shora dolů
+inline uint64_t word_stuck(uint64_t x, uint64_t ends, bool carry_in) {
+    uint64_t stuck = 0;
+    uint64_t rem = ends;
+    if (!(ends >> 63)) {
+        // Horní segment pokračuje do dalšího slova – rozhoduje příchozí přenos
+        unsigned lo = rem ? highest_bit(rem) + 1 : 0;
+        if (carry_in) stuck |= run_down(x, lo, 63);
+    }
+    while (rem) {
+        unsigned e = highest_bit(rem);
+        rem &= ~(1ULL << e);
+        unsigned lo = rem ? highest_bit(rem) + 1 : 0;
+        stuck |= run_down(x, lo, e);
+    }
+    return stuck;
+}
+
+} // namespace segscan
+
+#endif // DIFP_SEGMENTED_SCAN_HPP
@@ -0,0 +1,240 @@
+#ifndef DIFP_SPECIES_UNIVERSE_HPP
+#define DIFP_SPECIES_UNIVERSE_HPP
+
+#include "segmented_scan.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Druhy kvant pro výchozí dvouplošnou konfiguraci (P = 2).
+ * Druh 0 je vždy vakuum.
+ */
+enum Species : uint8_t {
+    VACUUM = 0,
+    MATTER = 1,
+    ANTIMATTER = 2,
+    MARKER = 3
+};
+
+/**
+ * @struct MobilityRule
+ * @brief Zobecnění rewrite(): pohyblivý druh se vymění s vakuem vpravo, ostatní druhy stojí.
+ * @tparam MobileMask Bit s = druh s je pohyblivý (přenáší svou identitu).
+ * @details movers() je booleovský obvod nad bitovými rovinami: OR mintermů pohyblivých
+ *          druhů. Maska je konstanta překladu, smyčka se rozvine do několika AND/OR/ANDN.
+ */
+template <uint32_t MobileMask>
+struct MobilityRule {
+    static_assert(!(MobileMask & 1u), "Vakuum (druh 0) nemuze byt pohyblive.");
+
+    static constexpr bool is_mover(unsigned species) { return (MobileMask >> species) & 1u; }
+
+    // Maska 64 buněk, které obsahují pohyblivý druh
+    template <size_t P>
+    static inline uint64_t movers(const uint64_t* planes) {
+        uint64_t m = 0;
+        for (unsigned s = 1; s < (1u << P); ++s) {
+            if (!is_mover(s)) continue;
+            uint64_t term = ~0ULL;
+            for (size_t p = 0; p < P; ++p) term &= ((s >> p) & 1u) ? planes[p] : ~planes[p];
+            m |= term;
+        }
+        return m;
+    }
+};
+
+// Hmota i antihmota se pohybují, značky (MARKER) jsou statické překážky
+using DefaultSpeciesRule = MobilityRule<(1u << MATTER) | (1u << ANTIMATTER)>;
+
+/**
+ * @class SpeciesUniverse
+ * @brief Vícedruhový vesmír s bitově řezanými rovinami (P rovin = 2^P druhů), 64 buněk na slovo.
+ * @tparam P Počet bitových rovin.
+ * @tparam Rule Pravidlo přepisu (viz MobilityRule).
+ * @details Roviny jednoho slova leží vedle sebe (planes[k * P + p]), takže jeden takt čte
+ *          každou cache line jen jednou.
+ *
+ *          Sekvenční průchod zprava doleva má stejný uzavřený tvar jako u PackedUniverse:
+ *          běh pohyblivých kvant se posune o uzel doprava, pokud nad ním leží vakuum;
+ *          běh zakončený statickým druhem nebo koncem řádku zůstává ("zaseknutý").
+ *          stuck[i] = M[i] & (blocked[i+1] | stuck[i+1]) se v rámci slova počítá
+ *          Kogge-Stone propagací (6 kroků), mezi slovy segmentovaným scanem.
+ */
+template <size_t P = 2, typename Rule = DefaultSpeciesRule>
+class SpeciesUniverse {
+private:
+    std::vector<uint64_t> planes;
+    std::vector<uint64_t> scratch;
+    size_t n_words;
+
+    // Přenosové funkce a vstupní přenosy bloků taktu (znovupoužité mezi takty)
+    std::vector<uint8_t> chunk_transfer;
+    std::vector<uint8_t> chunk_carry_in;
+
+    // Bitové masky jednoho slova odvozené z rovin
+    struct WordMasks {
+        uint64_t movers;  // Pohyblivé druhy
+        uint64_t vacuum;  // Prázdné buňky
+        uint64_t blocked; // blocked[i] = buňka i+1 je statická nebo i je konec řádku
+    };
+
+    WordMasks word_masks(const uint64_t* in, size_t k, uint64_t ends) const {
+        const uint64_t* pl = in + k * P;
+        uint64_t occupied = 0;
+        for (size_t p = 0; p < P; ++p) occupied |= pl[p];
+        uint64_t m = Rule::template movers<P>(pl);
+        uint64_t fixed = occupied & ~m;
+
+        // Statická buňka hned nad slovem (bit 0 dalšího slova)
+        uint64_t fixed_above = 0;
+        size_t above = (k + 1) * 64;
+        if (above < cells) {
+            unsigned s = species_at(in, above);
+            fixed_above = (s != VACUUM && !Rule::is_mover(s)) ? 1ULL : 0ULL;
+        }
+        return {m, ~occupied, (fixed >> 1) | (fixed_above << 63) | ends};
+    }
+
+    // Zaseknuté pohyblivé buňky (Kogge-Stone propagace shora dolů)
+    static inline uint64_t stuck_movers(const WordMasks& w, bool carry_in) {
+        uint64_t g = w.movers & (w.blocked | (carry_in ? (1ULL << 63) : 0ULL));
+        uint64_t p = w.movers;
+        for (unsigned d = 1; d < 64; d <<= 1) {
+            g |= p & (g >> d);
+            p &= p >> d;
+        }
+        return g;
+    }
+
+    static inline uint8_t word_transfer(const WordMasks& w) {
+        if (w.movers == ~0ULL && w.blocked == 0) return segscan::CARRY_IDENTITY;
+        return (stuck_movers(w, false) & 1ULL) ? segscan::CARRY_ONE : segscan::CARRY_ZERO;
+    }
+
+    static inline unsigned species_at(const uint64_t* in, size_t idx) {
+        const uint64_t* pl = in + (idx >> 6) * P;
+        unsigned s = 0;
+        for (size_t p = 0; p < P; ++p) s |= static_cast<unsigned>((pl[p] >> (idx & 63)) & 1ULL) << p;
+        return s;
+    }
+
+public:
+    static constexpr size_t PLANES = P;
+    static constexpr size_t SPECIES = size_t(1) << P;
+
+    size_t width;
+    size_t height;
+    size_t cells;
+
+    SpeciesUniverse(size_t w, size_t h)
+        : n_words((w * h + 63) / 64), width(w), height(h), cells(w * h) {
+        planes.assign(n_words * P, 0);
+        scratch.assign(n_words * P, 0);
+    }
+
+    [[nodiscard]] inline unsigned get_species(size_t idx) const { return species_at(planes.data(), idx); }
+
+    inline void set_species(size_t idx, unsigned s) {
+        uint64_t* pl = planes.data() + (idx >> 6) * P;
+        uint64_t bit = 1ULL << (idx & 63);
+        for (size_t p = 0; p < P; ++p) {
+            if ((s >> p) & 1u) pl[p] |= bit;
+            else               pl[p] &= ~bit;
+        }
+    }
+
+    [[nodiscard]] const std::vector<uint64_t>& words() const { return planes; }
+
+    // Referenční takt: doslovný průchod zprava doleva, buňka po buňce
+    void tick_serial() {
+        if (width < 2) return;
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = width - 1; x-- > 0;) {
+                size_t idx = y * width + x;
+                unsigned cur = get_species(idx);
+                if (Rule::is_mover(cur) && get_species(idx + 1) == VACUUM) {
+                    set_species(idx + 1, cur);
+                    set_species(idx, VACUUM);
+                }
+            }
+        }
+    }
+
+    // Paralelní takt: 64 buněk na slovo, bloky slov přes vlákna (OpenMP)
+    void tick_parallel() {
+        if (n_words == 0 || width < 2) return;
+
+        int threads = 1;
+#ifdef _OPENMP
+        threads = omp_get_max_threads();
+#endif
+        const size_t n_chunks = std::min<size_t>(static_cast<size_t>(threads), n_words);
+        const size_t chunk = (n_words + n_chunks - 1) / n_chunks;
+
+        const uint64_t* __restrict in = planes.data();
+        uint64_t* __restrict out = scratch.data();
+        // Pomocná pole bloků jsou členy: assign() se stejným počtem bloků nealokuje
+        chunk_transfer.assign(n_chunks, segscan::CARRY_IDENTITY);
+        chunk_carry_in.assign(n_chunks, 0);
+
+        // 1) Přenosová funkce každého bloku slov
+        #pragma omp parallel for schedule(static)
+        for (size_t c = 0; c < n_chunks; ++c) {
+            size_t k0 = c * chunk;
+            size_t k1 = std::min(n_words, k0 + chunk);
+            if (k0 >= k1) continue;
+            segscan::RowCursor cursor(width, cells, k1 - 1);
+            uint8_t f = segscan::CARRY_IDENTITY;
+            for (size_t k = k1; k-- > k0;) {
+                cursor.step_down(k);
+                f = segscan::compose_carry(word_transfer(word_masks(in, k, cursor.end_mask(k))), f);
+            }
+            chunk_transfer[c] = f;
+        }
+
+        // 2) Exkluzivní scan přes bloky
+        bool carry = false;
+        for (size_t c = n_chunks; c-- > 0;) {
+            chunk_carry_in[c] = carry;
+            carry = segscan::apply_carry(chunk_transfer[c], carry);
+        }
+
+        // 3) Posun pohyblivých běhů ve všech rovinách
+        #pragma omp parallel for schedule(static)
+        for (size_t c = 0; c < n_chunks; ++c) {
+            size_t k0 = c * chunk;
+            size_t k1 = std::min(n_words, k0 + chunk);
+            if (k0 >= k1) continue;
+            segscan::RowCursor cursor(width, cells, k1 - 1);
+            bool carry_in = chunk_carry_in[c];
+            for (size_t k = k1; k-- > k0;) {
+                cursor.step_down(k);
+                WordMasks w = word_masks(in, k, cursor.end_mask(k));
+                uint64_t moving = w.movers & ~stuck_movers(w, carry_in);
+
+                // Bit 63 předchozího slova se přesune sem, pokud je pohyblivý a bit 0 je
+                // ve stejném řádku vakuum nebo se sám posouvá dál
+                bool enters = false;
+                if (k > 0 && ((w.vacuum | moving) & 1ULL) && !cursor.starts_row(k)) {
+                    enters = Rule::is_mover(species_at(in, k * 64 - 1));
+                }
+
+                const uint64_t* pl = in + k * P;
+                for (size_t p = 0; p < P; ++p) {
+                    uint64_t incoming = enters ? ((in[(k - 1) * P + p] >> 63) & 1ULL) : 0ULL;
+                    out[k * P + p] = (pl[p] & ~moving) | ((pl[p] & moving) << 1) | incoming;
+                }
+                carry_in = segscan::apply_carry(word_transfer(w), carry_in);
+            }
+        }
+
+        planes.swap(scratch);
+    }
+};
+
+#endif // DIFP_SPECIES_UNIVERSE_HPP
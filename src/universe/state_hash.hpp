@@ -0,0 +1,32 @@
+#ifndef DIFP_STATE_HASH_HPP
+#define DIFP_STATE_HASH_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Zobristův hash po slovech: H = XOR_k key(k, word_k).
+ * Místo tabulky náhodných čísel na buňku (8 B/buňku, pro miliardu uzlů 8 GB) se klíč
+ * slova počítá míchací funkcí z indexu a obsahu. Změna slova stojí dvě volání key():
+ * H ^= key(k, old) ^ key(k, new). Prázdná slova přispívají nulou.
+ */
+inline uint64_t mix64(uint64_t z) {
+    // SplitMix64 finalizer
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline uint64_t word_key(size_t k, uint64_t word) {
+    return word ? mix64(word ^ mix64(static_cast<uint64_t>(k))) : 0ULL;
+}
+
+inline uint64_t hash_words(const std::vector<uint64_t>& words) {
+    uint64_t h = 0;
+    for (size_t k = 0; k < words.size(); ++k) h ^= word_key(k, words[k]);
+    return h;
+}
+
+#endif // DIFP_STATE_HASH_HPP